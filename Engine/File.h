@@ -2,7 +2,7 @@
 #define __FILE_H__
 
 #include <stdio.h>
-#include "common/str.h"
+#include "common/Str.h"
 #include "common/vec3.h"
 #include "common/quat.h"
 
@@ -7,7 +7,7 @@
 #include "ResourceSystem.h"
 #include "renderer/RenderSystem.h"
 #include "Pipeline.h"
-#include "../media/KnightModel.h"
+#include "../Media/KnightModel.h"
 #include "r_public.h"
 #include "sys/sys_public.h"
 #include "Camera.h"
@@ -2,12 +2,13 @@
 #include <algorithm>
 
 #include "Image.h"
+#include "sys/sys_public.h"
 
 using std::vector;
 using std::max;
 
 Image::Image() : _width(0), _height(0), _depth(0), _levelCount(0), _faces(0), _format(GL_RGBA),
-    _internalFormat(GL_RGBA8), _type(GL_UNSIGNED_BYTE), _elementSize(0) {
+    _internalFormat(GL_RGBA8), _type(GL_UNSIGNED_BYTE), _elementSize(0), _mapping(NULL), _mappingSize(0) {
 }
 
 Image::~Image() {
@@ -15,6 +16,13 @@ Image::~Image() {
 }
 
 void Image::FreeData() {
+    if (_mapping) {
+        Sys_UnmapFile(_mapping, _mappingSize);
+        _mapping = NULL;
+        _mappingSize = 0;
+        _data.clear();
+        return;
+    }
     for (vector<GLubyte*>::iterator it = _data.begin(); it != _data.end(); it++) {
         delete []*it;
     }
@@ -48,6 +56,14 @@ const void* Image::GetLevel( int level, GLenum face) const {
 }
 
 
+void Image::ReleaseLevel( int level) const {
+    if (_mapping == NULL)
+        return;
+    const GLubyte* data = (const GLubyte*)GetLevel(level);
+    Sys_ReleaseFileRange(_mapping, (int)(data - (const GLubyte*)_mapping), GetImageSize(level));
+}
+
+
 void* Image::GetLevel( int level, GLenum face) {
     assert( level < _levelCount);
     assert( _faces == 0 || ( face >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && face <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z));
@@ -65,6 +65,9 @@ public:
     const void* GetLevel( int level, GLenum face = GL_TEXTURE_CUBE_MAP_POSITIVE_X) const;
     void* GetLevel( int level, GLenum face = GL_TEXTURE_CUBE_MAP_POSITIVE_X);
 
+    //drop the resident pages of a mapped level, it stays readable from the file; heap levels are kept
+    void ReleaseLevel( int level) const;
+
     //convert a suitable image from a cubemap cross to a cubemap (returns false for unsuitable images)
     bool ConvertCrossToCubemap();
 
@@ -86,6 +89,10 @@ public:
     //pointers to the levels
     std::vector<GLubyte*> _data;
 
+    //set when the levels point into a file view (Sys_MapFile), FreeData unmaps it
+    const void* _mapping;
+    int _mappingSize;
+
     void FreeData();
 
 
@@ -10,5 +10,7 @@ bool loadImageBMP(const char *file, Image& i);
 
 bool loadImageDDS(const char *file, Image& i);
 
+bool saveImageDDS(const char *file, Image& i);
+
 bool loadImageTGA(const char *file, Image& i);
 #endif
\ No newline at end of file
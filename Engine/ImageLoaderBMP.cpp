@@ -1,7 +1,35 @@
 #include "ImageLoader.h"
 #include <stdio.h>
 #include "Image.h"
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <stdint.h>
+
+#pragma pack(push, 2)
+typedef struct {
+	uint16_t	bfType;
+	uint32_t	bfSize;
+	uint16_t	bfReserved1;
+	uint16_t	bfReserved2;
+	uint32_t	bfOffBits;
+} BITMAPFILEHEADER;
+
+typedef struct {
+	uint32_t	biSize;
+	int32_t		biWidth;
+	int32_t		biHeight;
+	uint16_t	biPlanes;
+	uint16_t	biBitCount;
+	uint32_t	biCompression;
+	uint32_t	biSizeImage;
+	int32_t		biXPelsPerMeter;
+	int32_t		biYPelsPerMeter;
+	uint32_t	biClrUsed;
+	uint32_t	biClrImportant;
+} BITMAPINFOHEADER;
+#pragma pack(pop)
+#endif
 
 bool loadImageBMP(const char *file, Image& i)
 {
@@ -67,6 +95,8 @@ bool loadImageBMP(const char *file, Image& i)
 	i._height = bitmapInfoHeader.biHeight;
 	i._levelCount = 1;
 	i._format = GL_RGB;
+	i._internalFormat = GL_RGB8;
+	i._elementSize = 3;
 	i._data.push_back(bitmapImage);
     //close file and return bitmap iamge data
     fclose(fp);
@@ -1,6 +1,7 @@
 #include "ImageLoader.h"
 #include "Image.h"
 #include "glutils.h"
+#include <string.h>
 
 using std::vector;
 
@@ -121,30 +122,30 @@ struct DXT5AlphaBlock
 
 struct DDS_PIXELFORMAT
 {
-    unsigned long dwSize;
-    unsigned long dwFlags;
-    unsigned long dwFourCC;
-    unsigned long dwRGBBitCount;
-    unsigned long dwRBitMask;
-    unsigned long dwGBitMask;
-    unsigned long dwBBitMask;
-    unsigned long dwABitMask;
+    unsigned int dwSize;
+    unsigned int dwFlags;
+    unsigned int dwFourCC;
+    unsigned int dwRGBBitCount;
+    unsigned int dwRBitMask;
+    unsigned int dwGBitMask;
+    unsigned int dwBBitMask;
+    unsigned int dwABitMask;
 };
 
 struct DDS_HEADER
 {
-    unsigned long dwSize;
-    unsigned long dwFlags;
-    unsigned long dwHeight;
-    unsigned long dwWidth;
-    unsigned long dwPitchOrLinearSize;
-    unsigned long dwDepth;
-    unsigned long dwMipMapCount;
-    unsigned long dwReserved1[11];
+    unsigned int dwSize;
+    unsigned int dwFlags;
+    unsigned int dwHeight;
+    unsigned int dwWidth;
+    unsigned int dwPitchOrLinearSize;
+    unsigned int dwDepth;
+    unsigned int dwMipMapCount;
+    unsigned int dwReserved1[11];
     DDS_PIXELFORMAT ddspf;
-    unsigned long dwCaps1;
-    unsigned long dwCaps2;
-    unsigned long dwReserved2[3];
+    unsigned int dwCaps1;
+    unsigned int dwCaps2;
+    unsigned int dwReserved2[3];
 };
 
 bool loadImageDDS( const char *file, Image& i) {
@@ -164,7 +165,11 @@ bool loadImageDDS( const char *file, Image& i) {
 
     // read in DDS header
     DDS_HEADER ddsh;
-    fread(&ddsh, sizeof(DDS_HEADER), 1, fp);
+    if (fread(&ddsh, sizeof(DDS_HEADER), 1, fp) != 1)
+    {
+        fclose(fp);
+        return false;
+    }
 
     // check if image is a volume texture
     if ((ddsh.dwCaps2 & DDSF_VOLUME) && (ddsh.dwDepth > 0))
@@ -440,7 +445,13 @@ bool loadImageDDS( const char *file, Image& i) {
 
             GLubyte *data = new GLubyte[size];
 
-            fread( data, size, 1, fp);
+            // a truncated file fails instead of uploading garbage
+            if (fread( data, size, 1, fp) != 1) {
+                delete [] data;
+                i.FreeData();
+                fclose(fp);
+                return false;
+            }
 
             i._data.push_back(data);
 
@@ -467,3 +478,61 @@ bool loadImageDDS( const char *file, Image& i) {
     fclose(fp);
     return true;
 }
+
+// writes the block compressed formats the loader reads back, a 2d image
+// with all of its levels
+bool saveImageDDS( const char *file, Image& i) {
+    unsigned int fourCC;
+    switch (i._format)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            fourCC = FOURCC_DXT1;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+            fourCC = FOURCC_DXT3;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            fourCC = FOURCC_DXT5;
+            break;
+        case GL_COMPRESSED_LUMINANCE_LATC1_EXT:
+            fourCC = FOURCC_ATI1;
+            break;
+        case GL_COMPRESSED_LUMINANCE_ALPHA_LATC2_EXT:
+            fourCC = FOURCC_ATI2;
+            break;
+        default:
+            return false;
+    }
+    if (i.IsCubeMap() || i.IsVolume())
+        return false;
+
+    DDS_HEADER ddsh;
+    memset(&ddsh, 0, sizeof(ddsh));
+    ddsh.dwSize = sizeof(DDS_HEADER);
+    ddsh.dwFlags = DDSF_CAPS | DDSF_HEIGHT | DDSF_WIDTH | DDSF_PIXELFORMAT | DDSF_MIPMAPCOUNT | DDSF_LINEARSIZE;
+    ddsh.dwHeight = i._height;
+    ddsh.dwWidth = i._width;
+    ddsh.dwPitchOrLinearSize = i.GetImageSize(0);
+    ddsh.dwMipMapCount = i._levelCount;
+    ddsh.ddspf.dwSize = sizeof(DDS_PIXELFORMAT);
+    ddsh.ddspf.dwFlags = DDSF_FOURCC;
+    ddsh.ddspf.dwFourCC = fourCC;
+    ddsh.dwCaps1 = DDSF_TEXTURE;
+    if (i._levelCount > 1)
+        ddsh.dwCaps1 |= DDSF_COMPLEX | DDSF_MIPMAP;
+
+    FILE *fp = fopen(file, "wb");
+    if (fp == NULL)
+        return false;
+
+    bool ok = fwrite("DDS ", 4, 1, fp) == 1
+        && fwrite(&ddsh, sizeof(DDS_HEADER), 1, fp) == 1;
+    for (int level = 0; ok && level < i._levelCount; level++)
+        ok = fwrite(i.GetLevel(level), i.GetImageSize(level), 1, fp) == 1;
+    fclose(fp);
+
+    if (!ok)
+        remove(file);
+    return ok;
+}
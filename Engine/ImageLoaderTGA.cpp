@@ -82,7 +82,7 @@ bool loadImageTGA( const char *filename, Image& i )
 
 	i._width = targa_header.width;
 	i._height = targa_header.height;
-	i._elementSize = targa_header.pixel_size;
+	i._elementSize = targa_header.pixel_size / 8;
 	i._data.push_back( data);
 	i._levelCount = 1;
 	i._faces = 0;
@@ -1 +1,606 @@
 #include "MapFile.h"
+#include "Texture.h"
+#include "Camera.h"
+#include "Shader.h"
+#include "DrawVert.h"
+#include "ResourceSystem.h"
+#include "glutils.h"
+#include "sys/sys_public.h"
+#include "framework/CmdSystem.h"
+#include <stdio.h>
+#include <string.h>
+
+static MapFile* bsp_map = NULL;
+
+static void R_Bsp_f(int argc, const char** argv)
+{
+	if (bsp_map == NULL)
+		return;
+	mapStats_t stats;
+	bsp_map->GetStats(&stats);
+	Sys_Printf("bsp: cluster %d, %d leafs, %d surfaces, %d triangles in %d draws, %.3f msec\n",
+		stats.cluster, stats.leafs, stats.surfaces, stats.triangles, stats.draws, stats.updateMsec);
+}
+
+// quake's z up to y up, the winding is flipped by the callers
+static void R_BspVertex(const bspDrawVert_t* in, DrawVert* out)
+{
+	out->Clear();
+	out->xyz.set(in->xyz[0], in->xyz[2], -in->xyz[1]);
+	out->st = vec2(in->st[0], in->st[1]);
+	out->normal.set(in->normal[0], in->normal[2], -in->normal[1]);
+	memcpy(out->color, in->color, 4);
+}
+
+MapFile::MapFile( void ) : _file(NULL),
+						_fileSize(0),
+						_vis(NULL),
+						_numClusters(0),
+						_clusterBytes(0),
+						_visFrame(0),
+						_camera(NULL)
+{
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.cluster = -1;
+	if (bsp_map == NULL)
+		Cmd_AddCommand("bsp", R_Bsp_f, "visible leafs, surfaces and draws of the bsp level");
+	bsp_map = this;
+}
+
+MapFile::~MapFile( void )
+{
+	Free();
+	if (bsp_map == this)
+		bsp_map = NULL;
+}
+
+void MapFile::Free()
+{
+	for (unsigned int i = 0; i < _batches.size(); i++)
+	{
+		srfTriangles_t* tri = _batches[i]->tri;
+		delete[] tri->verts;
+		delete[] tri->indexes;
+		R_FreeStaticTriSurf(tri);
+		delete _batches[i];
+	}
+	_batches.set_used(0);
+	_surfaces.set_used(0);
+
+	if (_file != NULL)
+		Sys_UnmapFile(_file, _fileSize);
+	_file = NULL;
+	_fileSize = 0;
+	_vis = NULL;
+	_numClusters = 0;
+	_clusterBytes = 0;
+}
+
+const void* MapFile::Lump( int lump, int size, int* count ) const
+{
+	// a bad lump counts 0
+	*count = 0;
+	const bspLump_t* l = &((const bspHeader_t*)_file)->lumps[lump];
+	if (l->offset < 0 || l->length < 0 || l->length % size != 0 || l->offset > _fileSize - l->length)
+		return NULL;
+	*count = l->length / size;
+	return _file + l->offset;
+}
+
+bool MapFile::Load( const char* filename )
+{
+	Free();
+	int size;
+	_file = (const unsigned char*)Sys_MapFile(filename, &size);
+	if (_file == NULL)
+	{
+		Sys_Printf("bsp: can't open %s\n", filename);
+		return false;
+	}
+	_fileSize = size;
+
+	const bspHeader_t* header = (const bspHeader_t*)_file;
+	if (_fileSize < (int)sizeof(bspHeader_t) || header->ident != BSP_IDENT || header->version != BSP_VERSION)
+	{
+		Sys_Printf("bsp: %s isn't a quake 3 bsp\n", filename);
+		Free();
+		return false;
+	}
+
+	int numPlanes = 0, numModels = 0, visBytes = 0;
+	_shaders = (const bspShader_t*)Lump(LUMP_SHADERS, sizeof(bspShader_t), &_numShaders);
+	_planes = (const bspPlane_t*)Lump(LUMP_PLANES, sizeof(bspPlane_t), &numPlanes);
+	_nodes = (const bspNode_t*)Lump(LUMP_NODES, sizeof(bspNode_t), &_numNodes);
+	_leafs = (const bspLeaf_t*)Lump(LUMP_LEAFS, sizeof(bspLeaf_t), &_numLeafs);
+	_leafSurfaces = (const int*)Lump(LUMP_LEAFSURFACES, sizeof(int), &_numLeafSurfaces);
+	const bspModel_t* models = (const bspModel_t*)Lump(LUMP_MODELS, sizeof(bspModel_t), &numModels);
+	_drawVerts = (const bspDrawVert_t*)Lump(LUMP_DRAWVERTS, sizeof(bspDrawVert_t), &_numDrawVerts);
+	_drawIndexes = (const int*)Lump(LUMP_DRAWINDEXES, sizeof(int), &_numDrawIndexes);
+	_bspSurfaces = (const bspSurface_t*)Lump(LUMP_SURFACES, sizeof(bspSurface_t), &_numBspSurfaces);
+	const unsigned char* vis = (const unsigned char*)Lump(LUMP_VISIBILITY, 1, &visBytes);
+	if (_shaders == NULL || _planes == NULL || _nodes == NULL || _leafs == NULL || _leafSurfaces == NULL ||
+		models == NULL || _drawVerts == NULL || _drawIndexes == NULL || _bspSurfaces == NULL || vis == NULL ||
+		numModels == 0 || _numNodes == 0 || _numLeafs == 0)
+	{
+		Sys_Printf("bsp: %s has bad lumps\n", filename);
+		Free();
+		return false;
+	}
+
+	// the tree and the leaf lists are used as they are in the file, so they
+	// are checked once; children come after their node, the walks end
+	bool valid = true;
+	for (int i = 0; i < _numNodes && valid; i++)
+	{
+		const bspNode_t* node = &_nodes[i];
+		valid = node->planeNum >= 0 && node->planeNum < numPlanes;
+		for (int j = 0; j < 2 && valid; j++)
+		{
+			int child = node->children[j];
+			valid = child >= 0 ? (child > i && child < _numNodes) : (-(child + 1) < _numLeafs);
+		}
+	}
+	for (int i = 0; i < _numLeafs && valid; i++)
+	{
+		const bspLeaf_t* leaf = &_leafs[i];
+		valid = leaf->firstLeafSurface >= 0 && leaf->numLeafSurfaces >= 0 &&
+			leaf->firstLeafSurface <= _numLeafSurfaces - leaf->numLeafSurfaces;
+	}
+	for (int i = 0; i < _numLeafSurfaces && valid; i++)
+		valid = _leafSurfaces[i] >= 0 && _leafSurfaces[i] < _numBspSurfaces;
+	const bspModel_t* world = &models[0];
+	valid = valid && world->firstSurface >= 0 && world->numSurfaces >= 0 &&
+		world->firstSurface <= _numBspSurfaces - world->numSurfaces;
+	if (!valid)
+	{
+		Sys_Printf("bsp: %s has a broken tree\n", filename);
+		Free();
+		return false;
+	}
+
+	// numClusters, clusterBytes, then a row of bits per cluster
+	if (visBytes >= 8)
+	{
+		const int* visHeader = (const int*)vis;
+		if (visHeader[0] > 0 && visHeader[1] > 0 && visHeader[0] <= (visBytes - 8) / visHeader[1] &&
+			visHeader[1] * 8 >= visHeader[0])
+		{
+			_numClusters = visHeader[0];
+			_clusterBytes = visHeader[1];
+			_vis = vis + 8;
+		}
+	}
+
+	// textures are relative to the directory above maps/
+	char basePath[256];
+	strncpy(basePath, filename, sizeof(basePath) - 1);
+	basePath[sizeof(basePath) - 1] = 0;
+	char* slash = strrchr(basePath, '/');
+	char* backslash = strrchr(basePath, '\\');
+	slash = backslash > slash ? backslash : slash;
+	if (slash != NULL)
+	{
+		*slash = 0;
+		const char* dir = strrchr(basePath, '/');
+		const char* bdir = strrchr(basePath, '\\');
+		dir = bdir > dir ? bdir : dir;
+		dir = dir != NULL ? dir + 1 : basePath;
+		if (strcmp(dir, "maps") == 0)
+			basePath[dir - basePath] = 0;
+		else
+			strcat(basePath, "/");
+	}
+	else
+		basePath[0] = 0;
+
+	BuildBatches(world, basePath);
+	Sys_Printf("bsp: %s, %d leafs, %d clusters, %d surfaces in %d batches\n",
+		filename, _numLeafs, _numClusters, world->numSurfaces, _batches.size());
+	return true;
+}
+
+Texture* MapFile::FindTexture( const char* shader, const char* basePath )
+{
+	char name[BSP_MAX_QPATH + 1];
+	memcpy(name, shader, BSP_MAX_QPATH);
+	name[BSP_MAX_QPATH] = 0;
+	char* ext = strrchr(name, '.');
+	if (ext != NULL && (strcmp(ext, ".tga") == 0 || strcmp(ext, ".jpg") == 0))
+		*ext = 0;
+
+	// the shader scripts aren't read, a shader without an image of its
+	// name gets the default texture
+	static const char* extensions[] = { ".tga", ".jpg" };
+	char path[512];
+	for (int i = 0; i < 2; i++)
+	{
+		sprintf(path, "%s%s%s", basePath, name, extensions[i]);
+		FILE* f = fopen(path, "rb");
+		if (f != NULL)
+		{
+			fclose(f);
+			return resourceSys->AddTexture(path);
+		}
+	}
+	sprintf(path, "%s%s%s", basePath, name, extensions[0]);
+	return resourceSys->AddTexture(path);
+}
+
+// the vertices and indexes the surface adds to a batch, false when it
+// isn't drawn or doesn't fit the file
+bool MapFile::CheckSurface( const bspSurface_t* in, int* numVerts, int* numIndexes ) const
+{
+	if (in->shaderNum < 0 || in->shaderNum >= _numShaders)
+		return false;
+	if (_shaders[in->shaderNum].surfaceFlags & (BSP_SURF_SKY | BSP_SURF_NODRAW))
+		return false;
+	if (in->firstVert < 0 || in->numVerts <= 0 || in->firstVert > _numDrawVerts - in->numVerts)
+		return false;
+
+	if (in->surfaceType == MST_PLANAR || in->surfaceType == MST_TRIANGLE_SOUP)
+	{
+		if (in->firstIndex < 0 || in->numIndexes <= 0 || in->numIndexes % 3 != 0 ||
+			in->firstIndex > _numDrawIndexes - in->numIndexes)
+			return false;
+		for (int i = 0; i < in->numIndexes; i++)
+		{
+			int index = _drawIndexes[in->firstIndex + i];
+			if (index < 0 || index >= in->numVerts)
+				return false;
+		}
+		*numVerts = in->numVerts;
+		*numIndexes = in->numIndexes;
+		return true;
+	}
+
+	if (in->surfaceType == MST_PATCH)
+	{
+		int w = in->patchWidth;
+		int h = in->patchHeight;
+		if (w < 3 || h < 3 || (w & 1) == 0 || (h & 1) == 0 || w * h > in->numVerts)
+			return false;
+		int patches = (w - 1) / 2 * ((h - 1) / 2);
+		*numVerts = patches * BSP_PATCH_LEVEL * BSP_PATCH_LEVEL;
+		*numIndexes = patches * (BSP_PATCH_LEVEL - 1) * (BSP_PATCH_LEVEL - 1) * 6;
+		return true;
+	}
+	return false;
+}
+
+void MapFile::BuildBatches( const bspModel_t* world, const char* basePath )
+{
+	_surfaces.set_used(_numBspSurfaces);
+	for (int i = 0; i < _numBspSurfaces; i++)
+	{
+		_surfaces[i].batch = -1;
+		_surfaces[i].firstIndex = 0;
+		_surfaces[i].numIndexes = 0;
+		_surfaces[i].visFrame = 0;
+	}
+
+	// the world's surfaces by shader, counting sort keeps the file order
+	array<int> counts;
+	counts.set_used(_numShaders + 1);
+	memset(counts.pointer(), 0, counts.size() * sizeof(int));
+	array<int> numVerts, numIndexes;
+	numVerts.set_used(world->numSurfaces);
+	numIndexes.set_used(world->numSurfaces);
+	int skipped = 0;
+	for (int i = 0; i < world->numSurfaces; i++)
+	{
+		const bspSurface_t* in = &_bspSurfaces[world->firstSurface + i];
+		if (!CheckSurface(in, &numVerts[i], &numIndexes[i]) || numVerts[i] > BSP_MAX_BATCH_VERTS)
+		{
+			skipped += in->surfaceType != MST_FLARE;
+			numVerts[i] = -1;
+			continue;
+		}
+		counts[in->shaderNum + 1]++;
+	}
+	for (int i = 0; i < _numShaders; i++)
+		counts[i + 1] += counts[i];
+	array<int> order;
+	order.set_used(counts[_numShaders]);
+	for (int i = 0; i < world->numSurfaces; i++)
+	{
+		if (numVerts[i] >= 0)
+			order[counts[_bspSurfaces[world->firstSurface + i].shaderNum]++] = i;
+	}
+
+	// a new batch for every shader and wherever the vertices pass 16 bits
+	array<int> batchVerts, batchIndexes;
+	int shader = -1;
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		int s = order[i];
+		const bspSurface_t* in = &_bspSurfaces[world->firstSurface + s];
+		int batch = _batches.size() - 1;
+		if (in->shaderNum != shader || batchVerts[batch] + numVerts[s] > BSP_MAX_BATCH_VERTS)
+		{
+			// a split batch keeps the shader's texture
+			mapBatch_t* b = new mapBatch_t;
+			b->tri = R_AllocStaticTriSurf();
+			b->texture = in->shaderNum == shader ? _batches[batch]->texture : FindTexture(_shaders[in->shaderNum].shader, basePath);
+			shader = in->shaderNum;
+			_batches.push_back(b);
+			batchVerts.push_back(0);
+			batchIndexes.push_back(0);
+			batch++;
+		}
+		batchVerts[batch] += numVerts[s];
+		batchIndexes[batch] += numIndexes[s];
+		_surfaces[world->firstSurface + s].batch = batch;
+		_batches[batch]->surfaces.push_back(world->firstSurface + s);
+	}
+
+	for (unsigned int i = 0; i < _batches.size(); i++)
+	{
+		mapBatch_t* b = _batches[i];
+		srfTriangles_t* tri = b->tri;
+		R_AllocStaticTriSurfVerts(tri, batchVerts[i]);
+		R_AllocStaticTriSurfIndexes(tri, batchIndexes[i]);
+		for (unsigned int j = 0; j < b->surfaces.size(); j++)
+		{
+			int s = b->surfaces[j];
+			if (_bspSurfaces[s].surfaceType == MST_PATCH)
+				AddPatch(tri, &_surfaces[s], &_bspSurfaces[s]);
+			else
+				AddSurface(tri, &_surfaces[s], &_bspSurfaces[s]);
+		}
+		R_GenerateGeometryVbo(tri);
+	}
+	if (skipped > 0)
+		Sys_Printf("bsp: %d surfaces skipped\n", skipped);
+}
+
+void MapFile::AddSurface( srfTriangles_t* tri, mapSurface_t* surf, const bspSurface_t* in )
+{
+	int base = tri->numVerts;
+	for (int i = 0; i < in->numVerts; i++)
+		R_BspVertex(&_drawVerts[in->firstVert + i], &tri->verts[base + i]);
+
+	const int* indexes = _drawIndexes + in->firstIndex;
+	glIndex_t* out = tri->indexes + tri->numIndexes;
+	for (int i = 0; i < in->numIndexes; i += 3)
+	{
+		out[i + 0] = (glIndex_t)(base + indexes[i + 0]);
+		out[i + 1] = (glIndex_t)(base + indexes[i + 2]);
+		out[i + 2] = (glIndex_t)(base + indexes[i + 1]);
+	}
+	surf->firstIndex = tri->numIndexes;
+	surf->numIndexes = in->numIndexes;
+	tri->numVerts += in->numVerts;
+	tri->numIndexes += in->numIndexes;
+}
+
+// every 3 x 3 block of the control grid is a biquadratic bezier patch,
+// evaluated on a BSP_PATCH_LEVEL x BSP_PATCH_LEVEL grid
+void MapFile::AddPatch( srfTriangles_t* tri, mapSurface_t* surf, const bspSurface_t* in )
+{
+	const int level = BSP_PATCH_LEVEL;
+	int w = in->patchWidth;
+	int patchesX = (w - 1) / 2;
+	int patchesY = (in->patchHeight - 1) / 2;
+	surf->firstIndex = tri->numIndexes;
+
+	for (int py = 0; py < patchesY; py++)
+	{
+		for (int px = 0; px < patchesX; px++)
+		{
+			DrawVert control[9];
+			for (int j = 0; j < 3; j++)
+				for (int i = 0; i < 3; i++)
+					R_BspVertex(&_drawVerts[in->firstVert + (py * 2 + j) * w + px * 2 + i], &control[j * 3 + i]);
+
+			int base = tri->numVerts;
+			for (int v = 0; v < level; v++)
+			{
+				float t = (float)v / (level - 1);
+				float bv[3] = { (1.f - t) * (1.f - t), 2.f * t * (1.f - t), t * t };
+				for (int u = 0; u < level; u++)
+				{
+					float s = (float)u / (level - 1);
+					float bu[3] = { (1.f - s) * (1.f - s), 2.f * s * (1.f - s), s * s };
+					DrawVert* out = &tri->verts[tri->numVerts++];
+					out->Clear();
+					float st[2] = { 0.f, 0.f };
+					for (int j = 0; j < 3; j++)
+					{
+						for (int i = 0; i < 3; i++)
+						{
+							const DrawVert& c = control[j * 3 + i];
+							float weight = bv[j] * bu[i];
+							out->xyz += c.xyz * weight;
+							out->normal += c.normal * weight;
+							st[0] += c.st.x * weight;
+							st[1] += c.st.y * weight;
+						}
+					}
+					out->st = vec2(st[0], st[1]);
+					if (out->normal.getLength() > 0.f)
+						out->normal.normalize();
+					memcpy(out->color, control[4].color, 4);
+				}
+			}
+
+			// the grid's order says nothing about the facing, the
+			// triangles are turned to the control points' normals
+			glIndex_t* first = tri->indexes + tri->numIndexes;
+			vec3 facing, normal;
+			for (int v = 0; v < level - 1; v++)
+			{
+				for (int u = 0; u < level - 1; u++)
+				{
+					int a = base + v * level + u;
+					int quad[6] = { a, a + level, a + 1, a + 1, a + level, a + level + 1 };
+					for (int i = 0; i < 6; i++)
+						tri->indexes[tri->numIndexes++] = (glIndex_t)quad[i];
+				}
+			}
+			glIndex_t* end = tri->indexes + tri->numIndexes;
+			for (glIndex_t* i = first; i < end; i += 3)
+			{
+				const vec3& p0 = tri->verts[i[0]].xyz;
+				facing += (tri->verts[i[1]].xyz - p0).cross(tri->verts[i[2]].xyz - p0);
+			}
+			for (int i = 0; i < 9; i++)
+				normal += control[i].normal;
+			if (facing.dot(normal) < 0.f)
+			{
+				for (glIndex_t* i = first; i < end; i += 3)
+				{
+					glIndex_t swap = i[1];
+					i[1] = i[2];
+					i[2] = swap;
+				}
+			}
+		}
+	}
+	surf->numIndexes = tri->numIndexes - surf->firstIndex;
+}
+
+void MapFile::SetCamera( Camera* camera )
+{
+	_camera = camera;
+}
+
+void MapFile::SetPosition( float x, float y, float z )
+{
+	_position.set(x, y, z);
+}
+
+int MapFile::FindLeaf( const vec3& p ) const
+{
+	int num = 0;
+	while (num >= 0)
+	{
+		const bspNode_t* node = &_nodes[num];
+		const bspPlane_t* plane = &_planes[node->planeNum];
+		float d = plane->normal[0] * p.x + plane->normal[1] * p.y + plane->normal[2] * p.z - plane->dist;
+		num = node->children[d >= 0.f ? 0 : 1];
+	}
+	return -(num + 1);
+}
+
+bool MapFile::ClusterVisible( int from, int to ) const
+{
+	if (from < 0 || _vis == NULL || from >= _numClusters || to >= _numClusters)
+		return true;
+	return (_vis[from * _clusterBytes + (to >> 3)] & (1 << (to & 7))) != 0;
+}
+
+// down the nodes that touch the frustum, the leaves of clusters the
+// camera's one can see mark their surfaces
+void MapFile::MarkNode( int num, int cluster )
+{
+	while (num >= 0)
+	{
+		const bspNode_t* node = &_nodes[num];
+		if (!_frustum.IntersectsBox(vec3((float)node->mins[0], (float)node->mins[1], (float)node->mins[2]),
+				vec3((float)node->maxs[0], (float)node->maxs[1], (float)node->maxs[2])))
+			return;
+		MarkNode(node->children[0], cluster);
+		num = node->children[1];
+	}
+
+	const bspLeaf_t* leaf = &_leafs[-(num + 1)];
+	if (leaf->cluster < 0 || !ClusterVisible(cluster, leaf->cluster))
+		return;
+	if (!_frustum.IntersectsBox(vec3((float)leaf->mins[0], (float)leaf->mins[1], (float)leaf->mins[2]),
+			vec3((float)leaf->maxs[0], (float)leaf->maxs[1], (float)leaf->maxs[2])))
+		return;
+	_stats.leafs++;
+	const int* surfaces = _leafSurfaces + leaf->firstLeafSurface;
+	for (int i = 0; i < leaf->numLeafSurfaces; i++)
+		_surfaces[surfaces[i]].visFrame = _visFrame;
+}
+
+void MapFile::Draw()
+{
+	if (_camera == NULL || _batches.size() == 0)
+		return;
+	Shader* shader = resourceSys->FindShader(eShader_PositionTex);
+	if (shader == NULL || shader->GetProgarm() == 0)
+		return;
+
+	double start = Sys_GetClockTicks();
+
+	// the tree is in quake space, engine = (x, z, -y)
+	mat4 fromQuake;
+	fromQuake.m[5] = 0.f;
+	fromQuake.m[6] = -1.f;
+	fromQuake.m[9] = 1.f;
+	fromQuake.m[10] = 0.f;
+	mat4 model;
+	model.buildTranslate(_position);
+	mat4 wvp = *_camera->GetViewProj() * model;
+	_frustum.FromMatrix(wvp * fromQuake);
+
+	vec3 eye = _camera->GetPosition() - _position;
+	int leaf = FindLeaf(vec3(eye.x, -eye.z, eye.y));
+	_stats.cluster = _leafs[leaf].cluster;
+	_stats.leafs = 0;
+	_visFrame++;
+	MarkNode(0, _stats.cluster);
+	_stats.updateMsec = (float)((Sys_GetClockTicks() - start) * 1000.0 / Sys_ClockTicksPerSecond());
+
+	glUseProgram(shader->GetProgarm());
+	glUniformMatrix4fv(shader->GetUniform(eUniform_MVP), 1, GL_FALSE, wvp.m);
+	glUniform1i(shader->GetUniform(eUniform_Samper0), 0);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	_stats.surfaces = 0;
+	_stats.triangles = 0;
+	_stats.draws = 0;
+	for (unsigned int i = 0; i < _batches.size(); i++)
+	{
+		// the marked ranges in index order, touching ones merged
+		const mapBatch_t* b = _batches[i];
+		const srfTriangles_t* tri = b->tri;
+		_counts.set_used(0);
+		_offsets.set_used(0);
+		_baseVertices.set_used(0);
+		int end = -1;
+		for (unsigned int j = 0; j < b->surfaces.size(); j++)
+		{
+			const mapSurface_t* surf = &_surfaces[b->surfaces[j]];
+			if (surf->visFrame != _visFrame)
+				continue;
+			_stats.surfaces++;
+			_stats.triangles += surf->numIndexes / 3;
+			if (surf->firstIndex == end)
+				_counts[_counts.size() - 1] += surf->numIndexes;
+			else
+			{
+				_counts.push_back(surf->numIndexes);
+				_offsets.push_back((const GLvoid*)(size_t)((tri->indexRange.offset + surf->firstIndex) * sizeof(glIndex_t)));
+				_baseVertices.push_back(tri->vertexRange.offset);
+			}
+			end = surf->firstIndex + surf->numIndexes;
+		}
+		if (_counts.size() == 0)
+			continue;
+
+		glBindTexture(GL_TEXTURE_2D, b->texture->GetName());
+		glBindBuffer(GL_ARRAY_BUFFER, tri->vbo[0]);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawVert), 0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(DrawVert), (GLvoid *)12);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, _counts.const_pointer(), GL_UNSIGNED_SHORT,
+			_offsets.const_pointer(), (GLsizei)_counts.size(), _baseVertices.const_pointer());
+		glCounters.drawCalls++;
+		_stats.draws++;
+	}
+
+	glDisableVertexAttribArray(0);
+	glDisableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GL_CheckError("bsp:draw");
+}
+
+void MapFile::GetStats( mapStats_t* stats )
+{
+	*stats = _stats;
+}
@@ -1,15 +1,261 @@
 #ifndef __MAPFILE_H__
 #define __MAPFILE_H__
 
-#include "common/Plane.h"
 #include "common/vec3.h"
+#include "common/array.h"
+#include "common/Frustum.h"
+#include "r_public.h"
+
+class Texture;
+class Camera;
+
+#define BSP_IDENT				(('P' << 24) + ('S' << 16) + ('B' << 8) + 'I')
+#define BSP_VERSION				46			// quake 3
+#define BSP_PATCH_LEVEL			6			// vertices along a side of a tessellated 3x3 patch
+#define BSP_MAX_BATCH_VERTS		65535		// 16 bit indexes
+#define BSP_MAX_QPATH			64
+
+// surface flags of a shader that aren't drawn
+#define BSP_SURF_SKY			0x4
+#define BSP_SURF_NODRAW			0x80
+
+// lumps of a quake 3 bsp
+enum
+{
+	LUMP_ENTITIES,
+	LUMP_SHADERS,
+	LUMP_PLANES,
+	LUMP_NODES,
+	LUMP_LEAFS,
+	LUMP_LEAFSURFACES,
+	LUMP_LEAFBRUSHES,
+	LUMP_MODELS,
+	LUMP_BRUSHES,
+	LUMP_BRUSHSIDES,
+	LUMP_DRAWVERTS,
+	LUMP_DRAWINDEXES,
+	LUMP_FOGS,
+	LUMP_SURFACES,
+	LUMP_LIGHTMAPS,
+	LUMP_LIGHTGRID,
+	LUMP_VISIBILITY,
+	BSP_LUMPS
+};
+
+// surface types
+enum
+{
+	MST_BAD,
+	MST_PLANAR,
+	MST_PATCH,
+	MST_TRIANGLE_SOUP,
+	MST_FLARE
+};
+
+/*
+===============================================================================
+
+	Quake 3 bsp level
+
+	The file is mapped with Sys_MapFile and stays mapped while the level
+	is loaded: the planes, nodes, leaves, leaf surface lists and the
+	visibility bitsets are read where they are in the file. The surfaces
+	of the world model are converted once, polygons and triangle soups
+	as they are and patches tessellated, into srfTriangles_t batches of
+	one shader each in the geometry arena (see renderer/GeometryArena.h).
+	Quake's z up is turned into y up and the winding flipped. A surface
+	keeps its index range in its batch.
+
+	Every frame the camera's leaf is found by walking the tree, and the
+	cluster's row of the visibility data gives the clusters it can see.
+	Leaves in those clusters are tested against the frustum, and their
+	surfaces are marked with the frame number, so a surface in several
+	leaves counts once. Each batch then draws the ranges of its marked
+	surfaces with one glMultiDrawElementsBaseVertex; neighboring ranges
+	are merged. Outside the map, or without visibility data, every
+	cluster is visible.
+
+	Brush models other than the world (doors, platforms), lightmaps,
+	fogs, flares, sky and the shader scripts aren't handled; a shader's
+	texture is looked up as a .tga, then a .jpg, next to the directory
+	of the maps. Patches are tessellated at BSP_PATCH_LEVEL.
+
+===============================================================================
+*/
+
+typedef struct
+{
+	int offset;
+	int length;
+}bspLump_t;
+
+typedef struct
+{
+	int ident;
+	int version;
+	bspLump_t lumps[BSP_LUMPS];
+}bspHeader_t;
+
+typedef struct
+{
+	char shader[BSP_MAX_QPATH];
+	int surfaceFlags;
+	int contentFlags;
+}bspShader_t;
+
+typedef struct
+{
+	float normal[3];
+	float dist;
+}bspPlane_t;
+
+typedef struct
+{
+	int planeNum;
+	int children[2];		// negative numbers are -(leafs + 1)
+	int mins[3];
+	int maxs[3];
+}bspNode_t;
+
+typedef struct
+{
+	int cluster;			// -1 is opaque
+	int area;
+	int mins[3];
+	int maxs[3];
+	int firstLeafSurface;
+	int numLeafSurfaces;
+	int firstLeafBrush;
+	int numLeafBrushes;
+}bspLeaf_t;
+
+typedef struct
+{
+	float mins[3];
+	float maxs[3];
+	int firstSurface;
+	int numSurfaces;
+	int firstBrush;
+	int numBrushes;
+}bspModel_t;
+
+typedef struct
+{
+	float xyz[3];
+	float st[2];
+	float lightmap[2];
+	float normal[3];
+	unsigned char color[4];
+}bspDrawVert_t;
+
+typedef struct
+{
+	int shaderNum;
+	int fogNum;
+	int surfaceType;
+	int firstVert;
+	int numVerts;
+	int firstIndex;
+	int numIndexes;
+	int lightmapNum;
+	int lightmapX, lightmapY;
+	int lightmapWidth, lightmapHeight;
+	float lightmapOrigin[3];
+	float lightmapVecs[3][3];
+	int patchWidth;
+	int patchHeight;
+}bspSurface_t;
+
+// a surface of the world, where its triangles are in a batch
+typedef struct
+{
+	int batch;				// -1 when it isn't drawn
+	int firstIndex;
+	int numIndexes;
+	int visFrame;
+}mapSurface_t;
+
+typedef struct
+{
+	srfTriangles_t* tri;
+	Texture* texture;
+	array<int> surfaces;	// in the order of their ranges
+}mapBatch_t;
+
+typedef struct
+{
+	int cluster;			// of the camera, -1 outside the map
+	int leafs;				// passed the pvs and the frustum
+	int surfaces;
+	int triangles;
+	int draws;
+	float updateMsec;
+}mapStats_t;
 
 class MapFile {
 public:
 	MapFile( void );
-	~MapFile( void ); 
+	~MapFile( void );
+
+	bool Load(const char* filename);
+	void Free();
+
+	void SetCamera(Camera* camera);
+
+	void SetPosition(float x, float y, float z);
+
+	// finds the visible leaves and draws their surfaces
+	void Draw();
+
+	void GetStats(mapStats_t* stats);
+
+private:
+	const void* Lump(int lump, int size, int* count) const;
+	Texture* FindTexture(const char* shader, const char* basePath);
+	bool CheckSurface(const bspSurface_t* in, int* numVerts, int* numIndexes) const;
+	void BuildBatches(const bspModel_t* world, const char* basePath);
+	void AddSurface(srfTriangles_t* tri, mapSurface_t* surf, const bspSurface_t* in);
+	void AddPatch(srfTriangles_t* tri, mapSurface_t* surf, const bspSurface_t* in);
+	int FindLeaf(const vec3& p) const;
+	bool ClusterVisible(int from, int to) const;
+	void MarkNode(int num, int cluster);
+
+private:
+	const unsigned char* _file;
+	int _fileSize;
+
+	// in the mapped file
+	const bspShader_t* _shaders;
+	const bspPlane_t* _planes;
+	const bspNode_t* _nodes;
+	const bspLeaf_t* _leafs;
+	const int* _leafSurfaces;
+	const bspDrawVert_t* _drawVerts;
+	const int* _drawIndexes;
+	const bspSurface_t* _bspSurfaces;
+	const unsigned char* _vis;		// numClusters rows of clusterBytes
+	int _numShaders;
+	int _numNodes;
+	int _numLeafs;
+	int _numLeafSurfaces;
+	int _numDrawVerts;
+	int _numDrawIndexes;
+	int _numBspSurfaces;
+	int _numClusters;
+	int _clusterBytes;
+
+	array<mapSurface_t> _surfaces;
+	array<mapBatch_t*> _batches;
+	int _visFrame;
 
+	Camera* _camera;
+	vec3 _position;
+	Frustum _frustum;
+	mapStats_t _stats;
 
+	array<GLsizei> _counts;
+	array<const GLvoid*> _offsets;
+	array<GLint> _baseVertices;
 };
 
 #endif /* !__MAPFILE_H__ */
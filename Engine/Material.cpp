@@ -2,9 +2,33 @@
 #include "Lexer.h"
 #include "sys/sys_public.h"
 #include "Shader.h"
+#include "ResourceSystem.h"
+#include "framework/CmdSystem.h"
+#include "renderer/MultiDraw.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-Material::Material() :_hasColor(false), 
-					  _hasTexture(false){
+static array<Material*> mtr_loaded;
+static Material* mtr_fallback = NULL;
+static bool mtr_asyncCompile = true;
+
+Material::Material() :_hasPosition(false),
+					  _hasTexCoord(false),
+					  _hasNormal(false),
+					  _hasTangent(false),
+					  _hasBinormal(false),
+					  _hasWorldViewPorj(false),
+					  _hasColor(false), 
+					  _hasTexture(false),
+					  _hasModelView(false),
+					  _hasInvModelView(false),
+					  _hasEyePosition(false),
+					  _hasLightPosition(false),
+					  _hasBumpMap(false),
+					  _numAttri(0),
+					  _vert(NULL),
+					  _frag(NULL){
 
 }
 
@@ -15,6 +39,9 @@ Material::~Material() {
 	if (_frag)
 		delete[] _frag;
 
+	// variant 0 is _shader
+	for (unsigned int i = 1; i < _variants.size(); i++)
+		delete _variants[i].shader;
 }
 
 bool Material::LoadMemory( const char* buffer ) {
@@ -33,36 +60,28 @@ bool Material::LoadMemory( const char* buffer ) {
 		{
 			ParseFragProgram(lexer);
 		}
+		else if (tk._data == "keywords")
+		{
+			ParseKeywords(lexer);
+		}
 		else
 		{
 			Sys_Error("error %s", tk.Name(), tk._data.c_str());
 		}
 	}
 
-	_shader.LoadFromBuffer(_vert, _frag);
-	if (_hasPosition)
-	{
-		_shader.BindAttribLocation(eAttrib_Position);
-	}
-
-	if (_hasWorldViewPorj)
-	{
-		_shader.GetUniformLocation(eUniform_MVP);
-	}
-
-	if (_hasColor)
-	{
-		_shader.GetUniformLocation(eUniform_Color);
-	}
-
-	if (_hasTexture)
-	{
-		_shader.GetUniformLocation(eUniform_Samper0);
-	}
+	mtrVariant_t base;
+	base.mask = 0;
+	base.shader = &_shader;
+	base.ready = false;
+	_variants.push_back(base);
+	SubmitVariant(&_shader, 0);
+	mtr_loaded.push_back(this);
 
 	Sys_Printf("material: %s\n"
 			  "has color: %s\n" 
-			  "has texture: %s\n", _name.c_str(), _hasColor? "true" : "false", _hasTexture? "true" : "false");
+			  "has texture: %s\n"
+			  "keywords: %d\n", _name.c_str(), _hasColor? "true" : "false", _hasTexture? "true" : "false", _keywords.size());
 	return false;
 }
 
@@ -173,3 +192,393 @@ void Material::SetName( const char* name )
 	_name = name;
 }
 
+bool Material::ParseKeywords( Lexer& lexer ) {
+	Token tk;
+	if (!lexer.Lex(tk) || tk._type != '{')
+	{
+		Sys_Printf("material %s: keywords needs a { block\n", _name.c_str());
+		return false;
+	}
+
+	while (lexer.Lex(tk))
+	{
+		if (tk._type == '}')
+			return true;
+		if (tk._type != TK_NAME)
+			continue;
+		if (_keywords.size() >= MAX_MTR_KEYWORDS)
+		{
+			Sys_Printf("material %s: more than %d keywords, %s ignored\n", _name.c_str(), MAX_MTR_KEYWORDS, tk._data.c_str());
+			continue;
+		}
+		_keywords.push_back(tk._data);
+	}
+	return false;
+}
+
+unsigned int Material::KeywordMask( const char* keyword ) {
+	for (unsigned int i = 0; i < _keywords.size(); i++)
+	{
+		if (_keywords[i] == keyword)
+			return BIT(i);
+	}
+	return 0;
+}
+
+int Material::Variant( unsigned int mask ) {
+	if (_keywords.size() < 32)
+		mask &= BIT(_keywords.size()) - 1;
+
+	// a handful of variants per material, a scan beats hashing
+	for (unsigned int i = 0; i < _variants.size(); i++)
+	{
+		if (_variants[i].mask == mask)
+			return i;
+	}
+
+	mtrVariant_t variant;
+	variant.mask = mask;
+	variant.shader = NULL;
+	variant.ready = false;
+	_variants.push_back(variant);
+	return _variants.size() - 1;
+}
+
+unsigned int Material::KeywordsMask( const char* keywords ) {
+	char buffer[256];
+	strncpy(buffer, keywords, sizeof(buffer) - 1);
+	buffer[sizeof(buffer) - 1] = 0;
+
+	unsigned int mask = 0;
+	const char* delim = " \t\r\n";
+	for (char* keyword = strtok(buffer, delim); keyword != NULL; keyword = strtok(NULL, delim))
+		mask |= KeywordMask(keyword);
+	return mask;
+}
+
+bool Material::IsVariantReady( int variant ) {
+	// a stale index draws the base program
+	if (variant < 0 || variant >= (int)_variants.size())
+		variant = 0;
+
+	mtrVariant_t& v = _variants[variant];
+	if (v.ready)
+		return true;
+
+	if (v.shader == NULL)
+	{
+		v.shader = new Shader;
+		SubmitVariant(v.shader, v.mask);
+	}
+
+	if (mtr_asyncCompile ? !v.shader->IsReady() : !v.shader->Finish())
+		return false;
+
+	FinishVariant(v.shader);
+	v.ready = true;
+	return true;
+}
+
+Shader* Material::GetShader( int variant ) {
+	if (variant < 0 || variant >= (int)_variants.size())
+		variant = 0;
+
+	if (!IsVariantReady(variant))
+	{
+		mtrVariant_t& v = _variants[variant];
+		if (v.shader->Finish())
+		{
+			FinishVariant(v.shader);
+			v.ready = true;
+		}
+	}
+	return _variants[variant].shader;
+}
+
+bool Material::IsVariantSubmitted( int variant ) {
+	return variant >= 0 && variant < (int)_variants.size() && _variants[variant].shader != NULL;
+}
+
+int Material::FinishVariants() {
+	int count = 0;
+	for (unsigned int i = 0; i < _variants.size(); i++)
+	{
+		mtrVariant_t& v = _variants[i];
+		if (v.shader == NULL || v.ready)
+			continue;
+		if (v.shader->Finish())
+		{
+			FinishVariant(v.shader);
+			v.ready = true;
+		}
+		count++;
+	}
+	return count;
+}
+
+// storage buffers and draw ids, for sources without a #version of their own
+static const char* mtr_multiDrawVert = "#version 430 compatibility\n#extension GL_ARB_shader_draw_parameters : require\n";
+static const char* mtr_multiDrawFrag = "#version 430 compatibility\n";
+
+// the defines go after #version, which has to stay the first line
+static lfStr R_VariantSource(const char* source, const lfStr& defines, const char* version)
+{
+	const char* s = source;
+	while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+		s++;
+	if (strncmp(s, "#version", 8) == 0)
+	{
+		const char* eol = strchr(s, '\n');
+		if (eol != NULL)
+			return lfStr(source, 0, eol + 1 - source) + defines + (eol + 1);
+	}
+	return lfStr(version) + defines + source;
+}
+
+void Material::SubmitVariant( Shader* shader, unsigned int mask ) {
+	lfStr defines;
+	for (unsigned int i = 0; i < _keywords.size(); i++)
+	{
+		if (mask & BIT(i))
+			defines += "#define " + _keywords[i] + " 1\n";
+	}
+
+	if (mask == 0)
+	{
+		shader->SubmitFromBuffer(_vert, _frag);
+	}
+	else
+	{
+		bool multiDraw = (mask & KeywordMask(MULTIDRAW_KEYWORD)) != 0;
+		lfStr vert = R_VariantSource(_vert, defines, multiDraw ? mtr_multiDrawVert : "");
+		lfStr frag = R_VariantSource(_frag, defines, multiDraw ? mtr_multiDrawFrag : "");
+		shader->SubmitFromBuffer(vert.c_str(), frag.c_str());
+	}
+	shader->SetName(_name.c_str());
+}
+
+// uniforms can only be looked up once the program linked
+void Material::FinishVariant( Shader* shader ) {
+	if (_hasPosition)
+	{
+		shader->BindAttribLocation(eAttrib_Position);
+	}
+
+	if (_hasWorldViewPorj)
+	{
+		shader->GetUniformLocation(eUniform_MVP);
+	}
+
+	if (_hasColor)
+	{
+		shader->GetUniformLocation(eUniform_Color);
+	}
+
+	if (_hasTexture)
+	{
+		shader->GetUniformLocation(eUniform_Samper0);
+	}
+}
+
+/*
+===============================================================================
+
+	Variant list
+
+===============================================================================
+*/
+
+int R_NumMaterials()
+{
+	return mtr_loaded.size();
+}
+
+Material* R_GetMaterial(int index)
+{
+	return mtr_loaded[index];
+}
+
+bool R_SaveMaterialVariants(const char* filename)
+{
+	// the default list lives in cache/
+	char dir[256];
+	strncpy(dir, filename, sizeof(dir) - 1);
+	dir[sizeof(dir) - 1] = '\0';
+	char* slash = strrchr(dir, '/');
+	if (slash != NULL)
+	{
+		*slash = '\0';
+		Sys_Mkdir(dir);
+	}
+
+	FILE* f = fopen(filename, "w");
+	if (f == NULL)
+	{
+		Sys_Printf("couldn't write material variants to %s\n", filename);
+		return false;
+	}
+
+	// one line per variant: <material> <keyword> <keyword> ...
+	for (unsigned int i = 0; i < mtr_loaded.size(); i++)
+	{
+		Material* mtr = mtr_loaded[i];
+		for (unsigned int j = 1; j < mtr->_variants.size(); j++)
+		{
+			if (mtr->_variants[j].shader == NULL)
+				continue;
+			fprintf(f, "%s", mtr->_name.c_str());
+			for (unsigned int k = 0; k < mtr->_keywords.size(); k++)
+			{
+				if (mtr->_variants[j].mask & BIT(k))
+					fprintf(f, " %s", mtr->_keywords[k].c_str());
+			}
+			fprintf(f, "\n");
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+int R_PrewarmMaterialVariants(const char* filename)
+{
+	FILE* f = fopen(filename, "r");
+	if (f == NULL)
+		return 0;
+
+	int start = Sys_Milliseconds();
+	int count = 0;
+	char line[1024];
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		const char* delim = " \t\r\n";
+		char* name = strtok(line, delim);
+		if (name == NULL)
+			continue;
+
+		Material* mtr = resourceSys->AddMaterial(name);
+		if (mtr == NULL)
+			continue;
+
+		// keywords by name, the mask bits move when a .mtr is edited
+		unsigned int mask = 0;
+		for (char* keyword = strtok(NULL, delim); keyword != NULL; keyword = strtok(NULL, delim))
+			mask |= mtr->KeywordMask(keyword);
+
+		int variant = mtr->Variant(mask);
+		if (!mtr->IsVariantSubmitted(variant))
+		{
+			mtr->IsVariantReady(variant);
+			count++;
+		}
+	}
+	fclose(f);
+
+	// everything is submitted before the first wait, so the driver can
+	// compile them side by side
+	for (unsigned int i = 0; i < mtr_loaded.size(); i++)
+		mtr_loaded[i]->FinishVariants();
+
+	Sys_Printf("prewarmed %d material variants from %s in %d msec\n", count, filename, Sys_Milliseconds() - start);
+	return count;
+}
+
+int R_WarmupMaterials(const char** files, int numFiles)
+{
+	int start = Sys_Milliseconds();
+	unsigned int first = mtr_loaded.size();
+	for (int i = 0; i < numFiles; i++)
+		resourceSys->AddMaterial(files[i]);
+
+	// only the ones this call loaded, the rest keep compiling in the
+	// background
+	int programs = 0;
+	for (unsigned int i = first; i < mtr_loaded.size(); i++)
+		programs += mtr_loaded[i]->FinishVariants();
+
+	int msec = Sys_Milliseconds() - start;
+	Sys_Printf("warmed up %d materials, %d programs in %d msec\n", (int)(mtr_loaded.size() - first), programs, msec);
+	return msec;
+}
+
+Material* R_FallbackMaterial()
+{
+	return mtr_fallback;
+}
+
+void R_SetAsyncShaders(bool async)
+{
+	mtr_asyncCompile = async;
+}
+
+static void R_MaterialVariants_f(int argc, const char** argv)
+{
+	for (unsigned int i = 0; i < mtr_loaded.size(); i++)
+	{
+		Material* mtr = mtr_loaded[i];
+		int compiled = 0;
+		int pending = 0;
+		for (unsigned int j = 0; j < mtr->_variants.size(); j++)
+		{
+			if (mtr->_variants[j].ready)
+				compiled++;
+			else if (mtr->_variants[j].shader != NULL)
+				pending++;
+		}
+		Sys_Printf("%s: %d keywords, %d variants, %d compiled, %d pending\n", mtr->_name.c_str(),
+			mtr->_keywords.size(), mtr->_variants.size(), compiled, pending);
+	}
+}
+
+static void R_Warmup_f(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		Sys_Printf("usage: mtr_warmup <file.mtr> ...\n");
+		return;
+	}
+	R_WarmupMaterials(argv + 1, argc - 1);
+}
+
+static void R_AsyncShaders_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetAsyncShaders(atoi(argv[1]) != 0);
+	Sys_Printf("async shader compile %s\n", mtr_asyncCompile ? "on" : "off");
+}
+
+static void R_PrewarmVariants_f(int argc, const char** argv)
+{
+	R_PrewarmMaterialVariants(argc > 1 ? argv[1] : MTR_VARIANT_LIST);
+}
+
+static void R_SaveVariants_f(int argc, const char** argv)
+{
+	R_SaveMaterialVariants(argc > 1 ? argv[1] : MTR_VARIANT_LIST);
+}
+
+void R_InitMaterialVariants()
+{
+	Cmd_AddCommand("mtr_variants", R_MaterialVariants_f, "list material variants");
+	Cmd_AddCommand("mtr_prewarm", R_PrewarmVariants_f, "mtr_prewarm [file], compile the variants in a list");
+	Cmd_AddCommand("mtr_savevariants", R_SaveVariants_f, "mtr_savevariants [file], write the compiled variants");
+	Cmd_AddCommand("mtr_warmup", R_Warmup_f, "mtr_warmup <file.mtr> ..., compile materials now and time it");
+	Cmd_AddCommand("mtr_async", R_AsyncShaders_f, "mtr_async 0/1, compile programs in the background");
+
+	// drawn in place of materials whose programs are still compiling
+	mtr_fallback = resourceSys->AddMaterial(MTR_FALLBACK);
+	if (mtr_fallback != NULL)
+		mtr_fallback->FinishVariants();
+
+	if (GL_DISK_CACHES)
+		R_PrewarmMaterialVariants(MTR_VARIANT_LIST);
+}
+
+void R_SetSurfaceKeywords( drawSurf_t* surf, const char* keywords ) {
+	if (surf->mtr == NULL)
+	{
+		surf->variant = 0;
+		return;
+	}
+
+	surf->variant = surf->mtr->Variant(surf->mtr->KeywordsMask(keywords));
+}
@@ -3,8 +3,49 @@
 
 #include "glutils.h"
 #include "Shader.h"
+#include "common/array.h"
 
 #define MAX_ATTRI 9
+#define MAX_MTR_KEYWORDS 32
+
+// variants compiled in a session, prewarmed on the next start
+#define MTR_VARIANT_LIST "cache/variants.txt"
+
+// flat material drawn while a program is still compiling
+#define MTR_FALLBACK "../Media/mtr/position.mtr"
+
+/*
+===============================================================================
+
+	Material permutations
+
+	A .mtr can declare feature keywords before its programs:
+
+		keywords { FOG SKINNED }
+
+	every keyword is a bit of a variant mask, and a variant is the vert and
+	frag source compiled with "#define <keyword> 1" for each set bit. The
+	base program (mask 0) is built on load, the others on first use. Code
+	resolves the mask to a variant index once and keeps it in
+	drawSurf_t::variant, so drawing never looks at keyword strings.
+
+	MULTIDRAW and TEXARRAY are reserved: the back end uses the MULTIDRAW
+	variant to merge draws (see renderer/MultiDraw.h) and compiles it as
+	GLSL 4.30, and adds TEXARRAY to it when the merged textures are
+	layers of an array page (see renderer/TextureArray.h).
+
+	Programs compile in the background (see GL_SubmitProgram); until a
+	variant links, surfaces using it are drawn with the fallback material.
+
+===============================================================================
+*/
+
+typedef struct
+{
+	unsigned int mask;		// keyword bits, 0 is the base program
+	Shader* shader;			// NULL until first drawn
+	bool ready;				// linked, uniforms looked up
+}mtrVariant_t;
 
 class Lexer;
 
@@ -28,6 +69,28 @@ public:
 
 	bool ParseFragProgram(Lexer& lexer);
 
+	bool ParseKeywords(Lexer& lexer);
+
+	// bit of a declared keyword, 0 when the material doesn't have it
+	unsigned int KeywordMask(const char* keyword);
+
+	// bits of a space separated list of keywords
+	unsigned int KeywordsMask(const char* keywords);
+
+	// index for drawSurf_t::variant, keywords the material lacks are dropped
+	int Variant(unsigned int mask);
+
+	// starts the compile on the first call, false until the program linked
+	bool IsVariantReady(int variant);
+
+	// waits for the variant to link
+	Shader* GetShader(int variant);
+
+	bool IsVariantSubmitted(int variant);
+
+	// waits on every submitted variant, returns how many weren't ready
+	int FinishVariants();
+
 	unsigned int ProgramId();
 
 	void SetName(const char* name);
@@ -57,8 +120,30 @@ public:
 
 	Shader _shader;
 
+	array<lfStr> _keywords;
+	array<mtrVariant_t> _variants;
+
+private:
+	void SubmitVariant(Shader* shader, unsigned int mask);
+	void FinishVariant(Shader* shader);
 };
 
+// loaded materials, for the variant list
+int			R_NumMaterials();
+Material*	R_GetMaterial(int index);
+
+void		R_InitMaterialVariants();
+bool		R_SaveMaterialVariants(const char* filename);
+int			R_PrewarmMaterialVariants(const char* filename);
+
+// loads and links the materials right away, for loading screens; ones
+// already loaded are left to compile in the background. returns the time
+// it took in msec
+int			R_WarmupMaterials(const char** files, int numFiles);
+
+Material*	R_FallbackMaterial();
+void		R_SetAsyncShaders(bool async);
+
 #endif
 
 
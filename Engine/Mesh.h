@@ -2,7 +2,7 @@
 #define __MESH_H__
 #include "r_public.h"
 #include "common/array.h"
-#include "common/str.h"
+#include "common/Str.h"
 #include "common/Joint.h"
 
 class Mesh
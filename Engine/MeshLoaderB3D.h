@@ -5,7 +5,7 @@ http://www.blitzbasic.com/sdkspecs/sdkspecs/b3dfile_specs.txt
 #ifndef __MESHLOADB3D_H__
 #define __MESHLOADB3D_H__
 
-#include "common/str.h"
+#include "common/Str.h"
 #include "common/quat.h"
 #include "common/vec3.h"
 #include "common/vec2.h"
@@ -36,10 +36,22 @@ void Model::SetFile( const char* filename )
 	mesh->CalcBounds();
 	_drawSurf->geo = mesh->GetGeometries(0);
 
-	_drawSurf->shaderParms->tex = resourceSys->AddTexture("0.png");
+	_drawSurf->shaderParms->tex = resourceSys->AddTextureAsync("0.png");
 	R_GenerateGeometryVbo(_drawSurf->geo);
 
-	_drawSurf->mtr = resourceSys->AddMaterial("../media/mtr/position.mtr");
+	if (_drawSurf->mtr == NULL)
+		_drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/position.mtr");
+}
+
+void Model::SetMaterial( const char* filename )
+{
+	_drawSurf->mtr = resourceSys->AddMaterial(filename);
+	_drawSurf->variant = 0;
+}
+
+void Model::SetKeywords( const char* keywords )
+{
+	R_SetSurfaceKeywords(_drawSurf, keywords);
 }
 
 void Model::SetViewProj( mat4* viewProj )
@@ -74,7 +86,7 @@ void AniModel::SetFile( const char* filename )
 	//AddStaticModel(model);
 	_drawSurf->geo = mesh->GetGeometries(0);
 
-	_drawSurf->shaderParms->tex = resourceSys->AddTexture("0.png");
+	_drawSurf->shaderParms->tex = resourceSys->AddTextureAsync("0.png");
 	R_GenerateGeometryVbo(_drawSurf->geo);
 
 	_root = mesh->GetRootJoint();
@@ -16,6 +16,12 @@ public:
 
 	virtual void SetFile(const char* filename);
 
+	// position.mtr unless set before SetFile
+	void SetMaterial(const char* filename);
+
+	// keywords of the material's variant, "FOG" for instance
+	void SetKeywords(const char* keywords);
+
 	void SetPosition(float x, float y, float z);
 
 	vec3 GetPosition();
@@ -1,4 +1,5 @@
 #include "Model_lwo.h"
+#include "sys/sys_public.h"
 #define	FLOAT_IS_DENORMAL(x)	(((*(const unsigned long *)&x) & 0x7f800000) == 0x00000000 && \
 								 ((*(const unsigned long *)&x) & 0x007fffff) != 0x00000000 )
 /*
@@ -0,0 +1,616 @@
+#include "ParticleSystem.h"
+#include "Texture.h"
+#include "Camera.h"
+#include "Shader.h"
+#include "ResourceSystem.h"
+#include "glutils.h"
+#include "ShaderSource.h"
+#include "sys/sys_public.h"
+#include "framework/CmdSystem.h"
+#include "renderer/GpuMemory.h"
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLE_USE_SSE
+#include <emmintrin.h>
+#endif
+
+#define PARTICLE_SOA_ARRAYS		8		// position, velocity, age, inverse life
+
+void R_DefaultParticleParms(particleParms_t* parms)
+{
+	parms->rate = 100.f;
+	parms->maxParticles = 1000;
+	parms->minLife = 1.f;
+	parms->maxLife = 2.f;
+	parms->velocity = vec3(0.f, 1.f, 0.f);
+	parms->spread = vec3(0.5f, 0.2f, 0.5f);
+	parms->gravity = vec3(0.f, -0.5f, 0.f);
+	parms->startSize = 0.2f;
+	parms->endSize = 0.5f;
+	for (int i = 0; i < 4; i++)
+	{
+		parms->startColor[i] = 1.f;
+		parms->endColor[i] = i < 3 ? 1.f : 0.f;
+	}
+	parms->additive = true;
+}
+
+/*
+===============================================================================
+
+	ParticleEmitter
+
+===============================================================================
+*/
+
+ParticleEmitter::ParticleEmitter() : _texture(NULL),
+				_camera(NULL),
+				_emitting(true),
+				_emitAccum(0.f),
+				_seed(0x2545f491),
+				_numParticles(0),
+				_capacity(0),
+				_block(NULL)
+{
+	R_DefaultParticleParms(&_parms);
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+	Free();
+}
+
+void ParticleEmitter::Init( const particleParms_t& parms )
+{
+	_parms = parms;
+	_numParticles = 0;
+	_emitAccum = 0.f;
+	Alloc(parms.maxParticles);
+}
+
+void ParticleEmitter::Alloc( int maxParticles )
+{
+	Free();
+	_capacity = (maxParticles + 3) & ~3;
+	if (_capacity == 0)
+		return;
+
+	// the soa arrays, the centers and the colors in one block
+	int floats = _capacity * (PARTICLE_SOA_ARRAYS + 4 + 1);
+	_block = malloc(floats * sizeof(float) + 15);
+	memset(_block, 0, floats * sizeof(float) + 15);
+	float* p = (float*)(((size_t)_block + 15) & ~(size_t)15);
+	float** arrays[PARTICLE_SOA_ARRAYS] = { &_px, &_py, &_pz, &_vx, &_vy, &_vz, &_age, &_invLife };
+	for (int i = 0; i < PARTICLE_SOA_ARRAYS; i++, p += _capacity)
+		*arrays[i] = p;
+	_centers = p;
+	_colors = (unsigned int*)(p + _capacity * 4);
+}
+
+void ParticleEmitter::Free()
+{
+	free(_block);
+	_block = NULL;
+	_capacity = 0;
+	_numParticles = 0;
+}
+
+void ParticleEmitter::SetTexture( const char* imgPath )
+{
+	_texture = resourceSys->AddTexture(imgPath);
+}
+
+void ParticleEmitter::SetPosition( float x, float y, float z )
+{
+	_position.set(x, y, z);
+}
+
+vec3 ParticleEmitter::GetPosition()
+{
+	return _position;
+}
+
+void ParticleEmitter::SetCamera( Camera* camera )
+{
+	_camera = camera;
+}
+
+void ParticleEmitter::SetEmitting( bool emitting )
+{
+	_emitting = emitting;
+}
+
+int ParticleEmitter::GetNumParticles()
+{
+	return _numParticles;
+}
+
+// per emitter, so the worker threads don't share a generator
+float ParticleEmitter::Random()
+{
+	_seed = _seed * 1664525 + 1013904223;
+	return (_seed >> 8) * (1.f / 16777216.f);
+}
+
+void ParticleEmitter::Update( float dt )
+{
+	if (_capacity == 0)
+		return;
+	Emit(dt);
+	Integrate(dt);
+	Kill();
+	if (!_parms.additive && _camera != NULL)
+		SortInstances();
+}
+
+void ParticleEmitter::Emit( float dt )
+{
+	if (!_emitting)
+		return;
+
+	_emitAccum += _parms.rate * dt;
+	int count = (int)_emitAccum;
+	_emitAccum -= count;
+	if (count > _capacity - _numParticles)
+		count = _capacity - _numParticles;
+
+	for (int i = _numParticles; i < _numParticles + count; i++)
+	{
+		_px[i] = _position.x;
+		_py[i] = _position.y;
+		_pz[i] = _position.z;
+		_vx[i] = _parms.velocity.x + (Random() * 2.f - 1.f) * _parms.spread.x;
+		_vy[i] = _parms.velocity.y + (Random() * 2.f - 1.f) * _parms.spread.y;
+		_vz[i] = _parms.velocity.z + (Random() * 2.f - 1.f) * _parms.spread.z;
+		_age[i] = 0.f;
+		_invLife[i] = 1.f / (_parms.minLife + (_parms.maxLife - _parms.minLife) * Random());
+	}
+	_numParticles += count;
+}
+
+void ParticleEmitter::Integrate( float dt )
+{
+	const particleParms_t& p = _parms;
+	float dSize = p.endSize - p.startSize;
+	float c0[4], dc[4];
+	for (int c = 0; c < 4; c++)
+	{
+		c0[c] = p.startColor[c] * 255.f;
+		dc[c] = (p.endColor[c] - p.startColor[c]) * 255.f;
+	}
+
+#ifdef PARTICLE_USE_SSE
+	// the arrays are padded to four, the lanes past the end are scratch
+	__m128 vdt = _mm_set1_ps(dt);
+	__m128 one = _mm_set1_ps(1.f);
+	__m128 gx = _mm_set1_ps(p.gravity.x * dt);
+	__m128 gy = _mm_set1_ps(p.gravity.y * dt);
+	__m128 gz = _mm_set1_ps(p.gravity.z * dt);
+	__m128 size0 = _mm_set1_ps(p.startSize);
+	__m128 sizeD = _mm_set1_ps(dSize);
+	__m128 color0[4], colorD[4];
+	for (int c = 0; c < 4; c++)
+	{
+		color0[c] = _mm_set1_ps(c0[c]);
+		colorD[c] = _mm_set1_ps(dc[c]);
+	}
+
+	for (int i = 0; i < _numParticles; i += 4)
+	{
+		__m128 age = _mm_add_ps(_mm_load_ps(_age + i), vdt);
+		_mm_store_ps(_age + i, age);
+		__m128 t = _mm_min_ps(_mm_mul_ps(age, _mm_load_ps(_invLife + i)), one);
+
+		__m128 vx = _mm_add_ps(_mm_load_ps(_vx + i), gx);
+		__m128 vy = _mm_add_ps(_mm_load_ps(_vy + i), gy);
+		__m128 vz = _mm_add_ps(_mm_load_ps(_vz + i), gz);
+		_mm_store_ps(_vx + i, vx);
+		_mm_store_ps(_vy + i, vy);
+		_mm_store_ps(_vz + i, vz);
+
+		__m128 x = _mm_add_ps(_mm_load_ps(_px + i), _mm_mul_ps(vx, vdt));
+		__m128 y = _mm_add_ps(_mm_load_ps(_py + i), _mm_mul_ps(vy, vdt));
+		__m128 z = _mm_add_ps(_mm_load_ps(_pz + i), _mm_mul_ps(vz, vdt));
+		_mm_store_ps(_px + i, x);
+		_mm_store_ps(_py + i, y);
+		_mm_store_ps(_pz + i, z);
+
+		// four particles of x, y, z, size become four centers
+		__m128 size = _mm_add_ps(size0, _mm_mul_ps(sizeD, t));
+		_MM_TRANSPOSE4_PS(x, y, z, size);
+		float* center = _centers + i * 4;
+		_mm_store_ps(center, x);
+		_mm_store_ps(center + 4, y);
+		_mm_store_ps(center + 8, z);
+		_mm_store_ps(center + 12, size);
+
+		__m128i rgba = _mm_setzero_si128();
+		for (int c = 0; c < 4; c++)
+		{
+			__m128i channel = _mm_cvtps_epi32(_mm_add_ps(color0[c], _mm_mul_ps(colorD[c], t)));
+			rgba = _mm_or_si128(rgba, _mm_slli_epi32(channel, c * 8));
+		}
+		_mm_store_si128((__m128i*)(_colors + i), rgba);
+	}
+#else
+	float g[3] = { p.gravity.x * dt, p.gravity.y * dt, p.gravity.z * dt };
+	for (int i = 0; i < _numParticles; i++)
+	{
+		_age[i] += dt;
+		float t = _age[i] * _invLife[i];
+		t = t < 1.f ? t : 1.f;
+
+		_vx[i] += g[0];
+		_vy[i] += g[1];
+		_vz[i] += g[2];
+		_px[i] += _vx[i] * dt;
+		_py[i] += _vy[i] * dt;
+		_pz[i] += _vz[i] * dt;
+
+		float* center = _centers + i * 4;
+		center[0] = _px[i];
+		center[1] = _py[i];
+		center[2] = _pz[i];
+		center[3] = p.startSize + dSize * t;
+
+		unsigned int rgba = 0;
+		for (int c = 0; c < 4; c++)
+			rgba |= (unsigned int)(c0[c] + dc[c] * t + 0.5f) << (c * 8);
+		_colors[i] = rgba;
+	}
+#endif
+}
+
+// the last live particle takes the place of a dead one
+void ParticleEmitter::Kill()
+{
+	int i = 0;
+	while (i < _numParticles)
+	{
+		if (_age[i] * _invLife[i] < 1.f)
+		{
+			i++;
+			continue;
+		}
+
+		int last = --_numParticles;
+		_px[i] = _px[last];
+		_py[i] = _py[last];
+		_pz[i] = _pz[last];
+		_vx[i] = _vx[last];
+		_vy[i] = _vy[last];
+		_vz[i] = _vz[last];
+		_age[i] = _age[last];
+		_invLife[i] = _invLife[last];
+		memcpy(_centers + i * 4, _centers + last * 4, 4 * sizeof(float));
+		_colors[i] = _colors[last];
+	}
+}
+
+// back to front in view space, the view looks down -z so the most
+// negative z comes first
+void ParticleEmitter::SortInstances()
+{
+	const float* m = _camera->GetView()->m;
+	_sortKeys.set_used(_numParticles);
+	for (int i = 0; i < _numParticles; i++)
+	{
+		const float* c = _centers + i * 4;
+		_sortKeys[i] = m[2] * c[0] + m[6] * c[1] + m[10] * c[2];
+	}
+
+	const unsigned int* order = _sort.Sort(_sortKeys.const_pointer(), _numParticles);
+	_sortedCenters.set_used(_numParticles * 4);
+	_sortedColors.set_used(_numParticles);
+	for (int i = 0; i < _numParticles; i++)
+	{
+		memcpy(&_sortedCenters[i * 4], _centers + order[i] * 4, 4 * sizeof(float));
+		_sortedColors[i] = _colors[order[i]];
+	}
+	memcpy(_centers, _sortedCenters.const_pointer(), _numParticles * 4 * sizeof(float));
+	memcpy(_colors, _sortedColors.const_pointer(), _numParticles * sizeof(unsigned int));
+}
+
+/*
+===============================================================================
+
+	Worker threads
+
+	Started with the first update that has more than one emitter. Every
+	update bumps the generation and wakes them; they and the calling
+	thread take emitters off a shared counter until none are left.
+
+===============================================================================
+*/
+
+static std::mutex pt_mutex;
+static std::condition_variable pt_wake;
+static std::condition_variable pt_done;
+static xthreadInfo pt_threads[PARTICLE_MAX_THREADS];
+static int pt_numThreads = 0;
+static bool pt_quit = false;
+static unsigned int pt_generation = 0;
+static int pt_running = 0;
+
+static ParticleEmitter** pt_jobs = NULL;
+static int pt_numJobs = 0;
+static float pt_dt = 0.f;
+static std::atomic<int> pt_next(0);
+
+static void P_RunJobs(ParticleEmitter** jobs, int numJobs, float dt)
+{
+	for (;;)
+	{
+		int i = pt_next++;
+		if (i >= numJobs)
+			break;
+		jobs[i]->Update(dt);
+	}
+}
+
+static unsigned int P_WorkerThread(void* parms)
+{
+	unsigned int generation = 0;
+	for (;;)
+	{
+		ParticleEmitter** jobs;
+		int numJobs;
+		float dt;
+		{
+			std::unique_lock<std::mutex> lock(pt_mutex);
+			while (!pt_quit && pt_generation == generation)
+				pt_wake.wait(lock);
+			if (pt_quit)
+				return 0;
+			generation = pt_generation;
+			jobs = pt_jobs;
+			numJobs = pt_numJobs;
+			dt = pt_dt;
+		}
+
+		P_RunJobs(jobs, numJobs, dt);
+
+		std::lock_guard<std::mutex> lock(pt_mutex);
+		if (--pt_running == 0)
+			pt_done.notify_one();
+	}
+}
+
+static void P_StartThreads()
+{
+	int numThreads = Sys_GetNumCpus() - 1;
+	numThreads = numThreads < PARTICLE_MAX_THREADS ? numThreads : PARTICLE_MAX_THREADS;
+	for (int i = 0; i < numThreads; i++)
+		Sys_CreateThread(P_WorkerThread, NULL, pt_threads[i], "particles");
+	pt_numThreads = numThreads;
+}
+
+void R_ShutdownParticles()
+{
+	{
+		std::lock_guard<std::mutex> lock(pt_mutex);
+		pt_quit = true;
+	}
+	pt_wake.notify_all();
+	for (int i = 0; i < pt_numThreads; i++)
+		Sys_JoinThread(pt_threads[i]);
+	pt_numThreads = 0;
+}
+
+/*
+===============================================================================
+
+	ParticleSystem
+
+===============================================================================
+*/
+
+static void R_Particles_f(int argc, const char** argv);
+static ParticleSystem* pt_system = NULL;
+
+ParticleSystem::ParticleSystem() : _shader(NULL),
+				_cornerVbo(0),
+				_instanceVbo(0)
+{
+	memset(&_stats, 0, sizeof(_stats));
+	pt_system = this;
+	Cmd_AddCommand("particles", R_Particles_f, "particle emitters, live particles and update time");
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	delete _shader;
+	GLuint corner = _cornerVbo;
+	GLuint instance = _instanceVbo;
+	R_DeleteBuffer(corner);
+	R_DeleteBuffer(instance);
+	if (pt_system == this)
+		pt_system = NULL;
+}
+
+void ParticleSystem::AddEmitter( ParticleEmitter* emitter )
+{
+	_emitters.push_back(emitter);
+}
+
+void ParticleSystem::RemoveEmitter( ParticleEmitter* emitter )
+{
+	for (unsigned int i = 0; i < _emitters.size(); i++)
+	{
+		if (_emitters[i] == emitter)
+		{
+			_emitters.erase(i);
+			return;
+		}
+	}
+}
+
+void ParticleSystem::Update( float dt )
+{
+	double start = Sys_GetClockTicks();
+	dt = dt < PARTICLE_MAX_DT ? dt : PARTICLE_MAX_DT;
+	int numJobs = _emitters.size();
+
+	if (numJobs > 1 && pt_numThreads == 0 && !pt_quit)
+		P_StartThreads();
+
+	pt_next = 0;
+	if (numJobs > 1 && pt_numThreads > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(pt_mutex);
+			pt_jobs = _emitters.pointer();
+			pt_numJobs = numJobs;
+			pt_dt = dt;
+			pt_running = pt_numThreads;
+			pt_generation++;
+		}
+		pt_wake.notify_all();
+		P_RunJobs(_emitters.pointer(), numJobs, dt);
+
+		std::unique_lock<std::mutex> lock(pt_mutex);
+		while (pt_running > 0)
+			pt_done.wait(lock);
+	}
+	else
+		P_RunJobs(_emitters.pointer(), numJobs, dt);
+
+	_stats.emitters = numJobs;
+	_stats.particles = 0;
+	for (int i = 0; i < numJobs; i++)
+		_stats.particles += _emitters[i]->_numParticles;
+	_stats.threads = numJobs > 1 ? pt_numThreads + 1 : 1;
+	_stats.updateMsec = (float)((Sys_GetClockTicks() - start) * 1000.0 / Sys_ClockTicksPerSecond());
+}
+
+bool ParticleSystem::InitDraw()
+{
+	_shader = new Shader;
+	_shader->LoadFromBuffer(particle_vert, particle_frag);
+	_shader->SetName("particle");
+	_shader->GetUniformLocation(eUniform_MVP);
+	_shader->GetUniformLocation(eUniform_Samper0);
+	_shader->GetUniformLocation(eUniform_CameraRight);
+	_shader->GetUniformLocation(eUniform_CameraUp);
+
+	// the corners of the quad, a triangle strip
+	static const float corners[] = { -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f };
+	GLuint vbo;
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	R_GpuMemAlloc(GL_BUFFER, vbo, GPUMEM_VERTEX_BUFFER, sizeof(corners));
+	_cornerVbo = vbo;
+
+	glGenBuffers(1, &vbo);
+	_instanceVbo = vbo;
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GL_CheckError("particle:init");
+	return _shader->GetProgarm() != 0;
+}
+
+void ParticleSystem::Draw()
+{
+	int total = 0;
+	for (unsigned int i = 0; i < _emitters.size(); i++)
+	{
+		ParticleEmitter* e = _emitters[i];
+		if (e->_camera != NULL && e->_texture != NULL)
+			total += e->_numParticles;
+	}
+	_stats.uploadBytes = 0;
+	if (total == 0)
+		return;
+	if (_shader == NULL && !InitDraw())
+		return;
+
+	// centers of every emitter first, then the colors, orphaned each frame
+	int centerBytes = total * 4 * sizeof(float);
+	int bytes = centerBytes + total * sizeof(unsigned int);
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+	glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+	R_GpuMemDelete(GL_BUFFER, _instanceVbo);
+	R_GpuMemAlloc(GL_BUFFER, _instanceVbo, GPUMEM_STAGING, bytes);
+	int first = 0;
+	for (unsigned int i = 0; i < _emitters.size(); i++)
+	{
+		ParticleEmitter* e = _emitters[i];
+		if (e->_camera == NULL || e->_texture == NULL || e->_numParticles == 0)
+			continue;
+		glBufferSubData(GL_ARRAY_BUFFER, first * 4 * sizeof(float), e->_numParticles * 4 * sizeof(float), e->_centers);
+		glBufferSubData(GL_ARRAY_BUFFER, centerBytes + first * sizeof(unsigned int), e->_numParticles * sizeof(unsigned int), e->_colors);
+		first += e->_numParticles;
+	}
+	glCounters.uploadBytes += bytes;
+	_stats.uploadBytes = bytes;
+
+	glUseProgram(_shader->GetProgarm());
+	glUniform1i(_shader->GetUniform(eUniform_Samper0), 0);
+	glEnable(GL_BLEND);
+	glDepthMask(GL_FALSE);
+
+	glBindBuffer(GL_ARRAY_BUFFER, _cornerVbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(1, 1);
+	glVertexAttribDivisor(2, 1);
+
+	first = 0;
+	for (unsigned int i = 0; i < _emitters.size(); i++)
+	{
+		ParticleEmitter* e = _emitters[i];
+		if (e->_camera == NULL || e->_texture == NULL || e->_numParticles == 0)
+			continue;
+
+		// the view's rows are the camera axes in world space
+		const float* view = e->_camera->GetView()->m;
+		glUniformMatrix4fv(_shader->GetUniform(eUniform_MVP), 1, GL_FALSE, e->_camera->GetViewProj()->m);
+		glUniform3f(_shader->GetUniform(eUniform_CameraRight), view[0], view[4], view[8]);
+		glUniform3f(_shader->GetUniform(eUniform_CameraUp), view[1], view[5], view[9]);
+		glBindTexture(GL_TEXTURE_2D, e->_texture->GetName());
+		if (e->_parms.additive)
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+		else
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (GLvoid*)(size_t)(first * 4 * sizeof(float)));
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(unsigned int), (GLvoid*)(size_t)(centerBytes + first * sizeof(unsigned int)));
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, e->_numParticles);
+		glCounters.drawCalls++;
+		first += e->_numParticles;
+	}
+
+	glVertexAttribDivisor(1, 0);
+	glVertexAttribDivisor(2, 0);
+	glDisableVertexAttribArray(0);
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(2);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	GL_CheckError("particle:draw");
+}
+
+void ParticleSystem::GetStats( particleStats_t* stats )
+{
+	*stats = _stats;
+}
+
+static void R_Particles_f(int argc, const char** argv)
+{
+	if (pt_system == NULL)
+		return;
+	particleStats_t stats;
+	pt_system->GetStats(&stats);
+	Sys_Printf("%d emitters, %d particles, update %.3f msec on %d threads, %d KB uploaded\n",
+		stats.emitters, stats.particles, stats.updateMsec, stats.threads, stats.uploadBytes / 1024);
+}
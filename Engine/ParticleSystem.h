@@ -0,0 +1,172 @@
+#ifndef __PARTICLESYSTEM_H__
+#define __PARTICLESYSTEM_H__
+
+#include "common/vec3.h"
+#include "common/array.h"
+#include "common/RadixSort.h"
+
+class Texture;
+class Camera;
+class Shader;
+
+#define PARTICLE_MAX_THREADS	8
+#define PARTICLE_MAX_DT			0.1f		// longer frames are simulated as this
+
+/*
+===============================================================================
+
+	Particles
+
+	An emitter keeps its particles in a structure of arrays: position,
+	velocity, age and inverse lifetime each in their own 16 byte aligned
+	array, padded to a multiple of four. Integration runs four particles
+	at a time with SSE (scalar where it isn't available): velocity takes
+	the gravity, position the velocity, and the color and size are lerped
+	from the start to the end value by the share of the lifetime that
+	passed. The result goes straight into the emitter's instance data, a
+	center and size per particle and an rgba8 color. Dead particles are
+	swapped with the last live one, so the arrays stay packed.
+
+	ParticleSystem::Update spreads the emitters over a few worker threads
+	that live as long as the system; each emitter is updated by a single
+	thread, so emitters don't share anything but the job counter. Alpha
+	blended emitters sort their particles back to front with a
+	RadixSort, additive ones draw in any order.
+
+	Draw uploads the instances of every emitter into one stream buffer
+	and draws each emitter as one glDrawArraysInstanced of a four vertex
+	strip; the vertex shader expands the quad along the camera's right and
+	up axes. Particles are drawn after the translucent queue, without
+	depth writes.
+
+===============================================================================
+*/
+
+typedef struct
+{
+	float rate;				// particles per second
+	int maxParticles;
+	float minLife;			// seconds
+	float maxLife;
+	vec3 velocity;			// at emission, in world space
+	vec3 spread;			// +- random added to the velocity
+	vec3 gravity;
+	float startSize;		// world units
+	float endSize;
+	float startColor[4];	// rgba, 0..1
+	float endColor[4];
+	bool additive;			// else alpha blended and sorted
+}particleParms_t;
+
+void	R_DefaultParticleParms(particleParms_t* parms);
+
+class ParticleEmitter
+{
+public:
+	ParticleEmitter();
+	~ParticleEmitter();
+
+	void Init(const particleParms_t& parms);
+
+	void SetTexture(const char* imgPath);
+
+	void SetPosition(float x, float y, float z);
+
+	vec3 GetPosition();
+
+	// the camera the quads face and sort against
+	void SetCamera(Camera* camera);
+
+	// stops spawning, the live particles finish their lifetime
+	void SetEmitting(bool emitting);
+
+	int GetNumParticles();
+
+	// one step of the simulation, ParticleSystem calls it on a worker
+	void Update(float dt);
+
+private:
+	friend class ParticleSystem;
+
+	void Emit(float dt);
+	void Integrate(float dt);
+	void Kill();
+	void SortInstances();
+	float Random();
+
+	void Alloc(int maxParticles);
+	void Free();
+
+private:
+	particleParms_t _parms;
+	Texture* _texture;
+	Camera* _camera;
+	vec3 _position;
+	bool _emitting;
+	float _emitAccum;
+	unsigned int _seed;
+
+	int _numParticles;
+	int _capacity;
+	void* _block;			// every array below, aligned
+	float* _px;
+	float* _py;
+	float* _pz;
+	float* _vx;
+	float* _vy;
+	float* _vz;
+	float* _age;
+	float* _invLife;
+
+	// instance data for the draw, center.xyz and size, and rgba8
+	float* _centers;
+	unsigned int* _colors;
+
+	array<float> _sortKeys;
+	array<float> _sortedCenters;
+	array<unsigned int> _sortedColors;
+	RadixSort _sort;
+};
+
+typedef struct
+{
+	int emitters;
+	int particles;
+	int threads;
+	float updateMsec;
+	int uploadBytes;
+}particleStats_t;
+
+class ParticleSystem
+{
+public:
+	ParticleSystem();
+	~ParticleSystem();
+
+	void AddEmitter(ParticleEmitter* emitter);
+	void RemoveEmitter(ParticleEmitter* emitter);
+
+	// simulates every emitter, on the worker threads
+	void Update(float dt);
+
+	// the gl part, in the common pass
+	void Draw();
+
+	void GetStats(particleStats_t* stats);
+
+private:
+	bool InitDraw();
+
+private:
+	array<ParticleEmitter*> _emitters;
+	particleStats_t _stats;
+
+	Shader* _shader;
+	unsigned int _cornerVbo;
+	unsigned int _instanceVbo;
+};
+
+// joins the worker threads
+void	R_ShutdownParticles();
+
+#endif
@@ -4,6 +4,7 @@
 #include "glutils.h"
 #include "sys/sys_public.h"
 #include "ResourceSystem.h"
+#include "renderer/GpuMemory.h"
 
 RenderObject::RenderObject()
 {
@@ -44,7 +45,7 @@ void RenderObject::SetLabel( const char* label )
 	if (_drawSurf->shaderParms->tex != NULL )
 	{
 		GLuint tex = _drawSurf->shaderParms->tex->GetName();
-		glDeleteTextures(1, &tex );
+		R_DeleteTexture(tex);
 	}
 	_drawSurf->shaderParms->tex = resourceSys->AddText(label);
 	UpdateVertex();
@@ -1,52 +1,117 @@
 #include "RenderTexture.h"
-#include "r_public.h"
+#include "sys/sys_public.h"
+#include "renderer/GpuMemory.h"
 
-RenderTexture::RenderTexture( int w, int h )
+RenderTexture::RenderTexture( int w, int h, GLenum format, bool depth ) : _fbo(0),
+	_depthRbo(0),
+	_format(format),
+	_hasDepth(depth),
+	_isDepth(IsDepthFormat(format))
 {
-	// Create the FBO
-	glGenFramebuffers(1, &_fbo);    
+	_pixelsWide = w;
+	_pixelsHigh = h;
 
-	// Create the depth buffer
-	GLuint texId = R_GenerateTexture();
+	glGenTextures(1, &_name);
+	glBindTexture(GL_TEXTURE_2D, _name);
+	glTexStorage2D(GL_TEXTURE_2D, 1, format, w, h);
+	R_GpuMemAlloc(GL_TEXTURE, _name, GPUMEM_RENDER_TARGET, w * h * BytesPerPixel(format));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
+	glGenFramebuffers(1, &_fbo);    
 	glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texId, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	GLenum Status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-	if (Status != GL_FRAMEBUFFER_COMPLETE) {
-		printf("FB error, status: 0x%x\n", Status);
-		return;
+	if (_isDepth)
+	{
+		_hasDepth = true;
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _name, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+	else
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _name, 0);
+		if (_hasDepth)
+		{
+			glGenRenderbuffers(1, &_depthRbo);
+			glBindRenderbuffer(GL_RENDERBUFFER, _depthRbo);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+			R_GpuMemAlloc(GL_RENDERBUFFER, _depthRbo, GPUMEM_RENDER_TARGET, w * h * 4);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthRbo);
+		}
 	}
 
-	// Generate a texture
-	glGenTextures(1, &captureTexture);
-	glBindTexture(GL_TEXTURE_2D, captureTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, depth_size, depth_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		Sys_Printf("RenderTexture: fbo error, status: 0x%x\n", status);
 
-	// Generate a rbo
-	glGenRenderbuffers(1, &captureRBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, depth_size, depth_size);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-	// Generate a fbo
-	glGenFramebuffers(1, &captureFBO);    
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, captureTexture, 0);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
+	GL_CheckError("RenderTexture");
 }
 
 RenderTexture::~RenderTexture()
 {
+	R_DeleteRenderbuffer(_depthRbo);
+
+	if (_fbo != 0)
+		glDeleteFramebuffers(1, &_fbo);
+
+	R_DeleteTexture(_name);
+}
+
+void RenderTexture::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+	glViewport(0, 0, _pixelsWide, _pixelsHigh);
+}
 
+void RenderTexture::BindDefault( int w, int h )
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, w, h);
+}
+
+int RenderTexture::GetMemorySize()
+{
+	int size = _pixelsWide * _pixelsHigh * BytesPerPixel(_format);
+	if (_hasDepth && !_isDepth)
+		size += _pixelsWide * _pixelsHigh * 4;
+	return size;
+}
+
+bool RenderTexture::IsDepthFormat( GLenum format )
+{
+	switch (format)
+	{
+	case GL_DEPTH_COMPONENT16:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32:
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+		return true;
+	}
+	return false;
+}
+
+int RenderTexture::BytesPerPixel( GLenum format )
+{
+	switch (format)
+	{
+	case GL_R8:
+		return 1;
+	case GL_RG8:
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16:
+		return 2;
+	case GL_RGBA16F:
+	case GL_RG32F:
+		return 8;
+	case GL_RGBA32F:
+		return 16;
+	}
+	return 4;
 }
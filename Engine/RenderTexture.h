@@ -3,14 +3,40 @@
 
 #include "Texture.h"
 
+// offscreen target: a color texture plus an optional depth renderbuffer,
+// or a single depth texture when the format is a depth format
 class RenderTexture : public Texture
 {
 public:
-	RenderTexture(int w, int h);
+	RenderTexture(int w, int h, GLenum format = GL_RGBA8, bool depth = true);
 	~RenderTexture();
 
+	// bind the fbo and set the viewport to the target size
+	void Bind();
+
+	static void BindDefault(int w, int h);
+
+	GLuint GetFbo() { return _fbo; }
+
+	GLenum GetFormat() { return _format; }
+
+	bool HasDepth() { return _hasDepth; }
+
+	bool IsDepthTarget() { return _isDepth; }
+
+	// approximate video memory used by the attachments
+	int GetMemorySize();
+
+	static bool IsDepthFormat(GLenum format);
+
+	static int BytesPerPixel(GLenum format);
+
 private:
 	GLuint _fbo;
+	GLuint _depthRbo;
+	GLenum _format;
+	bool _hasDepth;
+	bool _isDepth;
 };
 
 
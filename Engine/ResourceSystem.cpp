@@ -11,6 +11,10 @@
 #include "Mesh.h"
 #include "Material.h"
 #include "File.h"
+#include "renderer/TextureLoader.h"
+#include "renderer/ImageImport.h"
+#include "renderer/TextureStreamer.h"
+#include "renderer/TextureArray.h"
 
 #include "Model_lwo.h"
 #include "MeshLoader3DS.h"
@@ -22,6 +26,7 @@ static LoaderPlugin loaderPlugin[] = {
     { "png", loadImagePNG},
 	{ "tga", loadImageTGA},
 	{ "bmp", loadImageBMP},
+	{ "dds", loadImageDDS},
 };
 static int TexPluginCount = sizeof(loaderPlugin) / sizeof(LoaderPlugin);
 static Texture* defaultTexture;
@@ -54,7 +59,7 @@ static Shader* LoadPositionTexShader()
 static Shader* LoadPhongShader()
 {
 	Shader* shader = new Shader;
-	shader->LoadFromFile("../media/shader/phong.vert", "../media/shader/phong.frag");
+	shader->LoadFromFile("../Media/shader/phong.vert", "../Media/shader/phong.frag");
 	shader->SetName("phong");
 	shader->BindAttribLocation(eAttrib_Position);
 	shader->BindAttribLocation(eAttrib_TexCoord);
@@ -72,8 +77,8 @@ static Shader* LoadPhongShader()
 
 static Shader* LoadBumpShader()
 {
-	Shader* shader = resourceSys->AddShaderFromFile("../media/shader/bump.vert",
-		"../media/shader/bump.frag");
+	Shader* shader = resourceSys->AddShaderFromFile("../Media/shader/bump.vert",
+		"../Media/shader/bump.frag");
 	shader->SetName("bump");
 	shader->BindAttribLocation(eAttrib_Position);
 	shader->BindAttribLocation(eAttrib_TexCoord);
@@ -94,7 +99,7 @@ static Shader* LoadBumpShader()
 static Shader* LoadBlurShader()
 {
 	Shader* shader = new Shader;
-	shader->LoadFromFile("../media/blur.vs", "../media/blur.fs");
+	shader->LoadFromFile("../Media/blur.vs", "../Media/blur.fs");
 	shader->SetName("blur");
 	shader->BindAttribLocation(eAttrib_Position);
 	shader->BindAttribLocation(eAttrib_TexCoord);
@@ -129,6 +134,19 @@ ResourceSystem::~ResourceSystem()
 }
 
 
+loadImageFunc FindImageLoader(const char* file)
+{
+	std::string basename(file);
+    std::transform(basename.begin(), basename.end(), basename.begin(), ::tolower);
+    
+	for (int i = 0; i < TexPluginCount; ++i)
+	{
+		if (basename.find(loaderPlugin[i].name) != std::string::npos)
+			return loaderPlugin[i].pFunc;
+	}
+	return NULL;
+}
+
 Texture* ResourceSystem::AddTexture(const char* file)
 {
 	Texture* texture = NULL;
@@ -140,35 +158,54 @@ Texture* ResourceSystem::AddTexture(const char* file)
 		return texture;
     }
 
-	Image image;
+	Image* image = new Image;
 
-	std::string basename(file);
-    std::transform(basename.begin(), basename.end(), basename.begin(), ::tolower);
-    
-	for (int i = 0; i < TexPluginCount; ++i)
+	loadImageFunc func = FindImageLoader(file);
+	if (func == NULL || !R_ImportImage(fullPath.c_str(), func, *image))
+	{
+		Sys_Printf( "load image %s failed\n", fullPath.c_str() );
+		delete image;
+		return defaultTexture;
+	}
+
+	// small textures share array pages, the streamer keeps the image of
+	// the large ones for the finer levels
+	texture = new Texture();
+	if (R_AddTextureToArray(texture, image, 0))
+		delete image;
+	else if (!R_StreamTexture(texture, image, 0))
 	{
-		if (basename.find(loaderPlugin[i].name) == std::string::npos)
-			continue;
-
-		if( !loaderPlugin[i].pFunc(fullPath.c_str(), image) )
-		{
-			Sys_Printf( "load image %s failed\n", fullPath.c_str() );
-			return defaultTexture;
-		}
-		else
-		{
-			texture = new Texture();
-			texture->Init(&image);
-
-			_textures.Put(fullPath, texture);
-			return texture;
-		}
+		texture->Init(image);
+		delete image;
 	}
 
-	Sys_Printf( "load image %s failed\n", fullPath.c_str() );
-	return defaultTexture;
+	_textures.Put(fullPath, texture);
+	return texture;
 };
 
+Texture* ResourceSystem::AddTextureAsync(const char* file)
+{
+	lfStr fullPath = file;
+	void* it = _textures.Get(fullPath);
+	if( it != NULL ) {
+		return (Texture*)it;
+	}
+
+	loadImageFunc func = FindImageLoader(file);
+	if (func == NULL)
+	{
+		Sys_Printf( "load image %s failed\n", fullPath.c_str() );
+		return defaultTexture;
+	}
+
+	Texture* texture = new Texture();
+	texture->InitPending(defaultTexture);
+	R_QueueTextureLoad(texture, file, func);
+
+	_textures.Put(fullPath, texture);
+	return texture;
+}
+
 Mesh* ResourceSystem::AddMesh(const char* file)
 {
 	lfStr str = file;
@@ -230,7 +267,7 @@ Material* ResourceSystem::AddMaterial( const char* file )
 
 	mtr = new Material();
 	mtr->SetName(file);
-	const char* buffer = F_ReadFileData(file); //"../media/Position.mtr");
+	const char* buffer = F_ReadFileData(file); //"../Media/Position.mtr");
 
 	if (buffer == NULL)
 	{
@@ -251,7 +288,10 @@ bool ResourceSystem::LoadGLResource()
 		_shaders[shaderplugin[i].name] = shaderplugin[i].func();
 	}
 
+	R_InitImageImport();
 	defaultTexture = AddTexture("../Media/nskinbl.jpg");
+
+	R_InitMaterialVariants();
 	return true;
 }
 
@@ -24,6 +24,9 @@ struct LoaderPlugin{
 	loadImageFunc pFunc;
 };
 
+// the decoder for the file's extension, NULL when there is none
+loadImageFunc FindImageLoader(const char* file);
+
 class ResourceSystem
 {
 public:
@@ -34,6 +37,10 @@ public:
 
 	Texture* AddTexture(const char* file);
 
+	// decodes in the background, the texture draws as the default one
+	// until it is uploaded (see renderer/TextureLoader.h)
+	Texture* AddTextureAsync(const char* file);
+
 	Texture* AddText(const char* text);
 
 	Mesh* AddMesh(const char* file);
@@ -77,6 +77,7 @@ bool ScriptSystem::Init()
 	luaopen_model(L);
 	luaopen_camera(L);
 	luaopen_animodel(L);
+	luaopen_profile(L);
 
 	return true;
 }
@@ -10,7 +10,12 @@ const char* UniformType[16] =
 	"invModelView",
 	"fvEyePosition",
 	"fvLightPosition",
-	"bumpMap"
+	"bumpMap",
+	"texelSize",
+	"direction",
+	"exposure",
+	"cameraRight",
+	"cameraUp"
 };
 
 const char* AttribType[16] = 
@@ -23,9 +28,10 @@ const char* AttribType[16] =
 };
 
 
-Shader::Shader()
+Shader::Shader() :_program(0),
+				  _isPending(false)
 {
-	memset(_uniforms, -1, eUniform_Count);
+	memset(_uniforms, -1, sizeof(_uniforms));
 }
 
 void Shader::GetUniformLocation( unformType_t type )
@@ -69,6 +75,38 @@ bool Shader::LoadFromBuffer( const char* vfile, const char* ffile )
 	return true;
 }
 
+bool Shader::SubmitFromBuffer( const char* vfile, const char* ffile )
+{
+	if (_isPending)
+		Finish();
+
+	_program = 0;
+	_isPending = GL_SubmitProgram(_pending, vfile, ffile);
+	return _isPending;
+}
+
+bool Shader::IsPending()
+{
+	return _isPending;
+}
+
+bool Shader::IsReady()
+{
+	if (_isPending && GL_IsProgramComplete(_pending))
+		Finish();
+	return !_isPending && _program != 0;
+}
+
+bool Shader::Finish()
+{
+	if (_isPending)
+	{
+		_program = GL_FinishProgram(_pending);
+		_isPending = false;
+	}
+	return _program != 0;
+}
+
 bool Shader::SetName( const char* name )
 {
 	_name = name;
@@ -15,6 +15,11 @@ typedef enum
 	eUniform_EyePos,
 	eUniform_LightPos,
 	eUniform_BumpMap,
+	eUniform_TexelSize,
+	eUniform_Direction,
+	eUniform_Exposure,
+	eUniform_CameraRight,
+	eUniform_CameraUp,
 
 	eUniform_Count,
 }unformType_t;
@@ -60,10 +65,23 @@ public:
 	bool LoadFromBuffer(const char* vfile, const char* ffile);
 
 	bool LoadFromFile(const char* vfile, const char* ffile);
+
+	// compile and link in the background, the program is 0 until IsReady
+	bool SubmitFromBuffer(const char* vfile, const char* ffile);
+
+	bool IsPending();
+
+	// polls a submitted program, true once it linked
+	bool IsReady();
+
+	// waits for a submitted program
+	bool Finish();
 	
 	bool SetName(const char* name);
 private:
 	GLuint _program;
+	bool _isPending;
+	pendingProgram_t _pending;
 	GLint _uniforms[eUniform_Count];
 	lfStr _name;
 };
@@ -36,8 +36,198 @@ static const char position_frag[] =
 		"   gl_FragColor = texture2D(texture1, v_texCoord);\n"
 		//"   gl_FragColor = vec4(0.0, 1.0, 0.0, 1.0);\n"
 		"}\n";
+
+//------------------------------------------------------------------------------------------------------
+// full screen passes, vPosition is already in clip space
+	static const char post_vert[] =
+		"attribute vec2 vPosition;\n"
+		"attribute vec2 vTexCoord;\n"
+		"varying vec2 v_texCoord;\n"
+		"void main() {\n"
+		"  gl_Position = vec4(vPosition, 0.0, 1.0);\n"
+		"  v_texCoord = vTexCoord;\n"
+		"}\n";
+
+	static const char post_copy_frag[] =
+		"precision mediump float;\n"
+		"uniform sampler2D texture1;\n"
+		"varying vec2 v_texCoord;\n"
+		"void main() {\n"
+		"   gl_FragColor = texture2D(texture1, v_texCoord);\n"
+		"}\n";
+
+	// 9 tap gaussian in 5 fetches using bilinear filtering, run once per axis
+	static const char post_blur_frag[] =
+		"precision mediump float;\n"
+		"uniform sampler2D texture1;\n"
+		"uniform vec2 texelSize;\n"
+		"uniform vec2 direction;\n"
+		"varying vec2 v_texCoord;\n"
+		"void main() {\n"
+		"   vec2 off1 = direction * texelSize * 1.3846153846;\n"
+		"   vec2 off2 = direction * texelSize * 3.2307692308;\n"
+		"   vec4 c = texture2D(texture1, v_texCoord) * 0.2270270270;\n"
+		"   c += texture2D(texture1, v_texCoord + off1) * 0.3162162162;\n"
+		"   c += texture2D(texture1, v_texCoord - off1) * 0.3162162162;\n"
+		"   c += texture2D(texture1, v_texCoord + off2) * 0.0702702703;\n"
+		"   c += texture2D(texture1, v_texCoord - off2) * 0.0702702703;\n"
+		"   gl_FragColor = c;\n"
+		"}\n";
+
+	// sobel on luminance
+	static const char post_outline_frag[] =
+		"precision mediump float;\n"
+		"uniform sampler2D texture1;\n"
+		"uniform vec2 texelSize;\n"
+		"uniform vec3 COLOR;\n"
+		"varying vec2 v_texCoord;\n"
+		"float lum(vec2 offset) {\n"
+		"   return dot(texture2D(texture1, v_texCoord + offset * texelSize).rgb, vec3(0.299, 0.587, 0.114));\n"
+		"}\n"
+		"void main() {\n"
+		"   float tl = lum(vec2(-1.0, 1.0));\n"
+		"   float t  = lum(vec2( 0.0, 1.0));\n"
+		"   float tr = lum(vec2( 1.0, 1.0));\n"
+		"   float l  = lum(vec2(-1.0, 0.0));\n"
+		"   float r  = lum(vec2( 1.0, 0.0));\n"
+		"   float bl = lum(vec2(-1.0,-1.0));\n"
+		"   float b  = lum(vec2( 0.0,-1.0));\n"
+		"   float br = lum(vec2( 1.0,-1.0));\n"
+		"   float gx = tr + 2.0 * r + br - tl - 2.0 * l - bl;\n"
+		"   float gy = tl + 2.0 * t + tr - bl - 2.0 * b - br;\n"
+		"   float edge = smoothstep(0.2, 0.6, length(vec2(gx, gy)));\n"
+		"   vec4 c = texture2D(texture1, v_texCoord);\n"
+		"   gl_FragColor = vec4(mix(c.rgb, COLOR, edge), c.a);\n"
+		"}\n";
+
+	// filmic curve (aces fit) on linear input, writes gamma 2.2
+	static const char post_tonemap_frag[] =
+		"precision mediump float;\n"
+		"uniform sampler2D texture1;\n"
+		"uniform float exposure;\n"
+		"varying vec2 v_texCoord;\n"
+		"void main() {\n"
+		"   vec4 c = texture2D(texture1, v_texCoord);\n"
+		"   vec3 x = c.rgb * exposure;\n"
+		"   x = clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);\n"
+		"   gl_FragColor = vec4(pow(x, vec3(1.0 / 2.2)), c.a);\n"
+		"}\n";
+
+	static const char post_fxaa_frag[] =
+		"precision mediump float;\n"
+		"uniform sampler2D texture1;\n"
+		"uniform vec2 texelSize;\n"
+		"varying vec2 v_texCoord;\n"
+		"void main() {\n"
+		"   vec3 luma = vec3(0.299, 0.587, 0.114);\n"
+		"   float lumaNW = dot(texture2D(texture1, v_texCoord + vec2(-1.0,-1.0) * texelSize).rgb, luma);\n"
+		"   float lumaNE = dot(texture2D(texture1, v_texCoord + vec2( 1.0,-1.0) * texelSize).rgb, luma);\n"
+		"   float lumaSW = dot(texture2D(texture1, v_texCoord + vec2(-1.0, 1.0) * texelSize).rgb, luma);\n"
+		"   float lumaSE = dot(texture2D(texture1, v_texCoord + vec2( 1.0, 1.0) * texelSize).rgb, luma);\n"
+		"   vec4 rgbaM = texture2D(texture1, v_texCoord);\n"
+		"   float lumaM = dot(rgbaM.rgb, luma);\n"
+		"   float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+		"   float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+		"   vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+		"   float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.03125, 0.0078125);\n"
+		"   float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);\n"
+		"   dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * texelSize;\n"
+		"   vec3 rgbA = 0.5 * (texture2D(texture1, v_texCoord + dir * (1.0 / 3.0 - 0.5)).rgb +\n"
+		"                      texture2D(texture1, v_texCoord + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+		"   vec3 rgbB = rgbA * 0.5 + 0.25 * (texture2D(texture1, v_texCoord - dir * 0.5).rgb +\n"
+		"                                    texture2D(texture1, v_texCoord + dir * 0.5).rgb);\n"
+		"   float lumaB = dot(rgbB, luma);\n"
+		"   if (lumaB < lumaMin || lumaB > lumaMax)\n"
+		"      gl_FragColor = vec4(rgbA, rgbaM.a);\n"
+		"   else\n"
+		"      gl_FragColor = vec4(rgbB, rgbaM.a);\n"
+		"}\n";
 	
 
+//------------------------------------------------------------------------------------------------------
+	// one quad per instance, expanded along the camera axes
+	static const char particle_vert[] =
+		"#version 330\n"
+		"layout(location = 0) in vec2 vCorner;\n"
+		"layout(location = 1) in vec4 vCenterSize;\n"
+		"layout(location = 2) in vec4 vColor;\n"
+		"uniform mat4 WVP;\n"
+		"uniform vec3 cameraRight;\n"
+		"uniform vec3 cameraUp;\n"
+		"out vec2 v_texCoord;\n"
+		"out vec4 v_color;\n"
+		"void main() {\n"
+		"  vec3 offset = (cameraRight * vCorner.x + cameraUp * vCorner.y) * vCenterSize.w;\n"
+		"  gl_Position = WVP * vec4(vCenterSize.xyz + offset, 1.0);\n"
+		"  v_texCoord = vCorner + 0.5;\n"
+		"  v_color = vColor;\n"
+		"}\n";
+
+	static const char particle_frag[] =
+		"#version 330\n"
+		"uniform sampler2D texture1;\n"
+		"in vec2 v_texCoord;\n"
+		"in vec4 v_color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"   fragColor = texture(texture1, v_texCoord) * v_color;\n"
+		"}\n";
+
+	// a sprite quad per instance, spanned along the camera axes
+	static const char billboard_vert[] =
+		"#version 330\n"
+		"layout(location = 0) in vec2 vCorner;\n"
+		"layout(location = 1) in vec3 vPosition;\n"
+		"layout(location = 2) in vec2 vSize;\n"
+		"layout(location = 3) in vec4 vUVRect;\n"
+		"uniform mat4 WVP;\n"
+		"uniform vec3 cameraRight;\n"
+		"uniform vec3 cameraUp;\n"
+		"out vec2 v_texCoord;\n"
+		"void main() {\n"
+		"  vec2 offset = vCorner * vSize;\n"
+		"  gl_Position = WVP * vec4(vPosition + cameraRight * offset.x + cameraUp * offset.y, 1.0);\n"
+		"  v_texCoord = mix(vUVRect.xy, vUVRect.zw, vCorner);\n"
+		"}\n";
+
+	static const char billboard_frag[] =
+		"#version 330\n"
+		"uniform sampler2D texture1;\n"
+		"in vec2 v_texCoord;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"   fragColor = texture(texture1, v_texCoord);\n"
+		"}\n";
+
+	// heightmap chunks, lit by one direction
+	static const char terrain_vert[] =
+		"#version 330\n"
+		"layout(location = 0) in vec3 vPosition;\n"
+		"layout(location = 1) in vec2 vTexCoord;\n"
+		"layout(location = 2) in vec3 vNormal;\n"
+		"uniform mat4 WVP;\n"
+		"out vec2 v_texCoord;\n"
+		"out vec3 v_normal;\n"
+		"void main() {\n"
+		"  gl_Position = WVP * vec4(vPosition, 1.0);\n"
+		"  v_texCoord = vTexCoord;\n"
+		"  v_normal = vNormal;\n"
+		"}\n";
+
+	static const char terrain_frag[] =
+		"#version 330\n"
+		"uniform sampler2D texture1;\n"
+		"uniform vec3 direction;\n"
+		"in vec2 v_texCoord;\n"
+		"in vec3 v_normal;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"   float light = 0.3 + 0.7 * max(dot(normalize(v_normal), normalize(direction)), 0.0);\n"
+		"   vec4 c = texture(texture1, v_texCoord);\n"
+		"   fragColor = vec4(c.rgb * light, c.a);\n"
+		"}\n";
+
+
 #endif // __SHADERSOURCE_H__
 
 
@@ -16,7 +16,7 @@ public:
 
 		_drawSurf->shaderParms->tex = resourceSys->AddTexture("0.png");
 		R_GenerateGeometryVbo(_drawSurf->geo);
-		_drawSurf->mtr = resourceSys->AddMaterial("../media/mtr/positiontex.mtr");
+		_drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/positiontex.mtr");
 	}
 
 	~Box()
@@ -4,10 +4,14 @@
 #include "glutils.h"
 #include "sys/sys_public.h"
 #include "ResourceSystem.h"
+#include "renderer/GpuMemory.h"
 
 Sprite::Sprite() : _width(0),
-				_height(0)
+				_height(0),
+				_view(NULL),
+				_size(1.f, 1.f)
 {
+	SetUVRect(0.f, 0.f, 1.f, 1.f);
 	Init();
 }
 
@@ -46,7 +50,7 @@ void Sprite::SetLabel( const char* label )
 	if (_drawSurf->shaderParms->tex != NULL )
 	{
 		GLuint tex = _drawSurf->shaderParms->tex->GetName();
-		glDeleteTextures(1, &tex );
+		R_DeleteTexture(tex);
 	}
 	_drawSurf->shaderParms->tex = resourceSys->AddText(label);
 	UpdateVertex();
@@ -64,6 +68,7 @@ void Sprite::UpdateVertex()
 	tri->verts[0].xyz.y = h;
 	tri->verts[2].xyz = vec3(w, h, 0.f);
 	tri->verts[3].xyz.x = w;
+	_size = vec2(w, h);
 
 	SetupVBO();
 }
@@ -84,6 +89,14 @@ void Sprite::SetViewProj( mat4* viewProj )
 	_drawSurf->viewProj = viewProj;
 }
 
+void Sprite::SetKeywords( const char* keywords )
+{
+	// the material AddUISurf draws sprites with
+	if (_drawSurf->mtr == NULL)
+		_drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/positiontex.mtr");
+	R_SetSurfaceKeywords(_drawSurf, keywords);
+}
+
 vec3 Sprite::GetPosition()
 {
 	return _position;
@@ -91,8 +104,25 @@ vec3 Sprite::GetPosition()
 
 void Sprite::LookAtView( mat4* view )
 {
-	_drawSurf->matModel.buildTranslate(_position);
-	_drawSurf->matModel = R_BillboardModelView(_drawSurf->matModel, *view);
+	_view = view;
+}
+
+bool Sprite::IsBillboard()
+{
+	return _view != NULL;
+}
+
+void Sprite::SetSize( float w, float h )
+{
+	_size = vec2(w, h);
+}
+
+void Sprite::SetUVRect( float u0, float v0, float u1, float v1 )
+{
+	_uvRect[0] = u0;
+	_uvRect[1] = v0;
+	_uvRect[2] = u1;
+	_uvRect[3] = v1;
 }
 
 vec2 Sprite::ToScreenCoord( mat4& viewProj )
@@ -24,11 +24,25 @@ public:
 
 	void SetViewProj(mat4* viewProj);
 
+	// keywords of the material's variant, "FOG" for instance; billboards
+	// have their own program and ignore them
+	void SetKeywords(const char* keywords);
+
 	vec3 GetPosition();
 
-	// billboard
+	// billboard, turns the sprite into a camera facing quad spanned by
+	// the vertex shader (see renderer/Billboard.h); call before AddSprite,
+	// the view is the camera's and SetViewProj its view projection
 	void LookAtView(mat4* view);
 
+	bool IsBillboard();
+
+	// world size of a billboard, the texture's pixel size until set
+	void SetSize(float w, float h);
+
+	// part of the texture a billboard shows, 0..1 with v up
+	void SetUVRect(float u0, float v0, float u1, float v1);
+
 	vec2 ToScreenCoord(mat4& viewProj);
 
 private:
@@ -41,6 +55,10 @@ public:
 	int  _width;
 	int  _height;
 	vec3 _position;
+
+	mat4* _view;			// not NULL for billboards
+	vec2 _size;
+	float _uvRect[4];
 };
 
 
@@ -0,0 +1,463 @@
+#include "Terrain.h"
+#include "Texture.h"
+#include "Camera.h"
+#include "Shader.h"
+#include "Image.h"
+#include "ResourceSystem.h"
+#include "ShaderSource.h"
+#include "glutils.h"
+#include "sys/sys_public.h"
+#include "framework/CmdSystem.h"
+#include "renderer/GpuMemory.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Terrain* tr_terrain = NULL;
+
+static void R_Terrain_f(int argc, const char** argv)
+{
+	if (tr_terrain == NULL)
+		return;
+	if (argc > 1)
+		tr_terrain->SetMaxError((float)atof(argv[1]));
+	terrainStats_t stats;
+	tr_terrain->GetStats(&stats);
+	Sys_Printf("terrain: %d of %d chunks, %d triangles, %.3f msec\n",
+		stats.drawn, stats.chunks, stats.triangles, stats.updateMsec);
+}
+
+Terrain::Terrain() : _width(0),
+				_depth(0),
+				_chunksX(0),
+				_chunksZ(0),
+				_cellSize(1.f),
+				_maxError(TERRAIN_MAX_ERROR),
+				_texture(NULL),
+				_camera(NULL),
+				_shader(NULL),
+				_vbo(0),
+				_ibo(0)
+{
+	memset(&_stats, 0, sizeof(_stats));
+	if (tr_terrain == NULL)
+		Cmd_AddCommand("terrain", R_Terrain_f, "terrain chunks and triangles drawn, terrain <pixels> sets the lod error");
+	tr_terrain = this;
+}
+
+Terrain::~Terrain()
+{
+	delete _shader;
+	GLuint vbo = _vbo;
+	GLuint ibo = _ibo;
+	R_DeleteBuffer(vbo);
+	R_DeleteBuffer(ibo);
+	if (tr_terrain == this)
+		tr_terrain = NULL;
+}
+
+bool Terrain::Init( const char* heightmap, float cellSize, float heightScale )
+{
+	Image image;
+	loadImageFunc func = FindImageLoader(heightmap);
+	if (func == NULL || !func(heightmap, image) || image.IsCompressed())
+	{
+		Sys_Printf("terrain: can't load heightmap %s\n", heightmap);
+		return false;
+	}
+
+	// the first channel, they are all the same in a grayscale image
+	_width = image.GetWidth();
+	_depth = image.GetHeight();
+	_cellSize = cellSize;
+	const unsigned char* pixels = (const unsigned char*)image.GetLevel(0);
+	int pixelSize = image._elementSize;
+	_heights.set_used(_width * _depth);
+	for (int i = 0; i < _width * _depth; i++)
+		_heights[i] = pixels[i * pixelSize] * (heightScale / 255.f);
+
+	// the chunks past the last pixel repeat the edge
+	_chunksX = (_width - 1 + TERRAIN_CHUNK_QUADS - 1) / TERRAIN_CHUNK_QUADS;
+	_chunksZ = (_depth - 1 + TERRAIN_CHUNK_QUADS - 1) / TERRAIN_CHUNK_QUADS;
+	_chunks.set_used(_chunksX * _chunksZ);
+	for (int cz = 0; cz < _chunksZ; cz++)
+		for (int cx = 0; cx < _chunksX; cx++)
+			BuildErrors(&_chunks[cz * _chunksX + cx], cx, cz);
+
+	BuildIndexes();
+	if (_texture == NULL)
+		_texture = resourceSys->AddTexture(heightmap);
+	_stats.chunks = _chunks.size();
+	return true;
+}
+
+void Terrain::SetTexture( const char* imgPath )
+{
+	_texture = resourceSys->AddTexture(imgPath);
+}
+
+void Terrain::SetPosition( float x, float y, float z )
+{
+	_position.set(x, y, z);
+}
+
+void Terrain::SetCamera( Camera* camera )
+{
+	_camera = camera;
+}
+
+void Terrain::SetMaxError( float pixels )
+{
+	_maxError = pixels;
+}
+
+float Terrain::Height( int x, int z ) const
+{
+	x = x < 0 ? 0 : (x >= _width ? _width - 1 : x);
+	z = z < 0 ? 0 : (z >= _depth ? _depth - 1 : z);
+	return _heights[z * _width + x];
+}
+
+// the cell's triangles are split from its top right to its bottom left
+// corner, like the drawn ones
+float Terrain::GetHeight( float x, float z ) const
+{
+	if (_width == 0)
+		return _position.y;
+	float fx = (x - _position.x) / _cellSize;
+	float fz = (z - _position.z) / _cellSize;
+	int ix = (int)floorf(fx);
+	int iz = (int)floorf(fz);
+	fx -= ix;
+	fz -= iz;
+
+	float h;
+	if (fx + fz <= 1.f)
+	{
+		float h00 = Height(ix, iz);
+		h = h00 + (Height(ix + 1, iz) - h00) * fx + (Height(ix, iz + 1) - h00) * fz;
+	}
+	else
+	{
+		float h11 = Height(ix + 1, iz + 1);
+		h = h11 + (Height(ix, iz + 1) - h11) * (1.f - fx) + (Height(ix + 1, iz) - h11) * (1.f - fz);
+	}
+	return _position.y + h;
+}
+
+vec3 Terrain::GetNormal( float x, float z ) const
+{
+	if (_width == 0)
+		return vec3(0.f, 1.f, 0.f);
+	float fx = (x - _position.x) / _cellSize;
+	float fz = (z - _position.z) / _cellSize;
+	int ix = (int)floorf(fx);
+	int iz = (int)floorf(fz);
+
+	// slopes along x and z of the triangle under the point
+	float dx, dz;
+	if ((fx - ix) + (fz - iz) <= 1.f)
+	{
+		dx = Height(ix + 1, iz) - Height(ix, iz);
+		dz = Height(ix, iz + 1) - Height(ix, iz);
+	}
+	else
+	{
+		dx = Height(ix + 1, iz + 1) - Height(ix, iz + 1);
+		dz = Height(ix + 1, iz + 1) - Height(ix + 1, iz);
+	}
+	vec3 n(-dx, _cellSize, -dz);
+	float len = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+	return vec3(n.x / len, n.y / len, n.z / len);
+}
+
+void Terrain::BuildErrors( terrainChunk_t* chunk, int cx, int cz )
+{
+	int x0 = cx * TERRAIN_CHUNK_QUADS;
+	int z0 = cz * TERRAIN_CHUNK_QUADS;
+	float minY = Height(x0, z0);
+	float maxY = minY;
+	for (int z = 0; z <= TERRAIN_CHUNK_QUADS; z++)
+	{
+		for (int x = 0; x <= TERRAIN_CHUNK_QUADS; x++)
+		{
+			float h = Height(x0 + x, z0 + z);
+			minY = h < minY ? h : minY;
+			maxY = h > maxY ? h : maxY;
+		}
+	}
+	chunk->mins.set(x0 * _cellSize, minY, z0 * _cellSize);
+	chunk->maxs.set((x0 + TERRAIN_CHUNK_QUADS) * _cellSize, maxY, (z0 + TERRAIN_CHUNK_QUADS) * _cellSize);
+
+	// every vertex against the bilinear surface of the coarser cell it
+	// falls in; a level is never more accurate than the finer ones
+	chunk->errors[0] = 0.f;
+	for (int lod = 1; lod < TERRAIN_LODS; lod++)
+	{
+		int step = 1 << lod;
+		float error = chunk->errors[lod - 1];
+		for (int z = 0; z <= TERRAIN_CHUNK_QUADS; z++)
+		{
+			for (int x = 0; x <= TERRAIN_CHUNK_QUADS; x++)
+			{
+				int sx = x / step * step;
+				int sz = z / step * step;
+				sx = sx == TERRAIN_CHUNK_QUADS ? sx - step : sx;
+				sz = sz == TERRAIN_CHUNK_QUADS ? sz - step : sz;
+				float fx = (float)(x - sx) / step;
+				float fz = (float)(z - sz) / step;
+				float h0 = Height(x0 + sx, z0 + sz) + (Height(x0 + sx + step, z0 + sz) - Height(x0 + sx, z0 + sz)) * fx;
+				float h1 = Height(x0 + sx, z0 + sz + step) + (Height(x0 + sx + step, z0 + sz + step) - Height(x0 + sx, z0 + sz + step)) * fx;
+				float d = fabsf(Height(x0 + x, z0 + z) - (h0 + (h1 - h0) * fz));
+				error = d > error ? d : error;
+			}
+		}
+		chunk->errors[lod] = error;
+	}
+	chunk->lod = TERRAIN_LODS - 1;
+	chunk->visible = false;
+}
+
+// a vertex of a stitched edge between two coarse ones moves onto the
+// previous coarse vertex
+static int R_StitchIndex(int x, int z, int step, int mask)
+{
+	int coarse = step * 2;
+	if (((mask & TERRAIN_EDGE_LEFT) && x == 0) || ((mask & TERRAIN_EDGE_RIGHT) && x == TERRAIN_CHUNK_QUADS))
+		z -= z % coarse;
+	if (((mask & TERRAIN_EDGE_TOP) && z == 0) || ((mask & TERRAIN_EDGE_BOTTOM) && z == TERRAIN_CHUNK_QUADS))
+		x -= x % coarse;
+	return z * TERRAIN_CHUNK_VERTS + x;
+}
+
+// twice the area in grid units; snapped triangles collapse to a point or,
+// where two stitched edges meet, to a line
+static int R_TriangleArea(const int* tri)
+{
+	int x0 = tri[0] % TERRAIN_CHUNK_VERTS, z0 = tri[0] / TERRAIN_CHUNK_VERTS;
+	int x1 = tri[1] % TERRAIN_CHUNK_VERTS, z1 = tri[1] / TERRAIN_CHUNK_VERTS;
+	int x2 = tri[2] % TERRAIN_CHUNK_VERTS, z2 = tri[2] / TERRAIN_CHUNK_VERTS;
+	return (z1 - z0) * (x2 - x0) - (x1 - x0) * (z2 - z0);
+}
+
+void Terrain::BuildIndexes()
+{
+	_indexes.set_used(0);
+	for (int lod = 0; lod < TERRAIN_LODS; lod++)
+	{
+		int step = 1 << lod;
+		for (int mask = 0; mask < TERRAIN_STITCH_MASKS; mask++)
+		{
+			// the coarsest level has no coarser neighbor
+			int stitch = lod == TERRAIN_LODS - 1 ? 0 : mask;
+			_indexOffsets[lod][mask] = _indexes.size();
+			for (int z = 0; z < TERRAIN_CHUNK_QUADS; z += step)
+			{
+				for (int x = 0; x < TERRAIN_CHUNK_QUADS; x += step)
+				{
+					int a = R_StitchIndex(x, z, step, stitch);
+					int b = R_StitchIndex(x + step, z, step, stitch);
+					int c = R_StitchIndex(x, z + step, step, stitch);
+					int d = R_StitchIndex(x + step, z + step, step, stitch);
+					int tris[2][3] = { { a, c, b }, { b, c, d } };
+					for (int t = 0; t < 2; t++)
+					{
+						if (R_TriangleArea(tris[t]) == 0)
+							continue;
+						for (int i = 0; i < 3; i++)
+							_indexes.push_back((unsigned short)tris[t][i]);
+					}
+				}
+			}
+			_indexCounts[lod][mask] = _indexes.size() - _indexOffsets[lod][mask];
+		}
+	}
+}
+
+void Terrain::BuildVertices( terrainVert_t* verts )
+{
+	float invW = 1.f / (_width - 1);
+	float invD = 1.f / (_depth - 1);
+	for (int cz = 0; cz < _chunksZ; cz++)
+	{
+		for (int cx = 0; cx < _chunksX; cx++)
+		{
+			for (int z = 0; z < TERRAIN_CHUNK_VERTS; z++)
+			{
+				for (int x = 0; x < TERRAIN_CHUNK_VERTS; x++, verts++)
+				{
+					int gx = cx * TERRAIN_CHUNK_QUADS + x;
+					int gz = cz * TERRAIN_CHUNK_QUADS + z;
+					verts->xyz[0] = gx * _cellSize;
+					verts->xyz[1] = Height(gx, gz);
+					verts->xyz[2] = gz * _cellSize;
+					verts->st[0] = gx * invW;
+					verts->st[1] = gz * invD;
+
+					float dx = (Height(gx + 1, gz) - Height(gx - 1, gz)) * 0.5f;
+					float dz = (Height(gx, gz + 1) - Height(gx, gz - 1)) * 0.5f;
+					float len = sqrtf(dx * dx + _cellSize * _cellSize + dz * dz);
+					verts->normal[0] = -dx / len;
+					verts->normal[1] = _cellSize / len;
+					verts->normal[2] = -dz / len;
+				}
+			}
+		}
+	}
+}
+
+bool Terrain::InitDraw()
+{
+	_shader = new Shader;
+	_shader->LoadFromBuffer(terrain_vert, terrain_frag);
+	_shader->SetName("terrain");
+	_shader->GetUniformLocation(eUniform_MVP);
+	_shader->GetUniformLocation(eUniform_Samper0);
+	_shader->GetUniformLocation(eUniform_Direction);
+
+	int numVerts = _chunks.size() * TERRAIN_CHUNK_VERTS * TERRAIN_CHUNK_VERTS;
+	array<terrainVert_t> verts;
+	verts.set_used(numVerts);
+	BuildVertices(verts.pointer());
+
+	GLuint vbo, ibo;
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, numVerts * sizeof(terrainVert_t), verts.const_pointer(), GL_STATIC_DRAW);
+	R_GpuMemAlloc(GL_BUFFER, vbo, GPUMEM_VERTEX_BUFFER, numVerts * sizeof(terrainVert_t));
+	glCounters.uploadBytes += numVerts * sizeof(terrainVert_t);
+	glGenBuffers(1, &ibo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexes.size() * sizeof(unsigned short), _indexes.const_pointer(), GL_STATIC_DRAW);
+	R_GpuMemAlloc(GL_BUFFER, ibo, GPUMEM_INDEX_BUFFER, _indexes.size() * sizeof(unsigned short));
+	glCounters.uploadBytes += _indexes.size() * sizeof(unsigned short);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	_vbo = vbo;
+	_ibo = ibo;
+	GL_CheckError("terrain:init");
+	return _shader->GetProgarm() != 0;
+}
+
+void Terrain::SelectLods( int viewHeight )
+{
+	// pixels per world unit of error at distance 1
+	float scale = _camera->GetProj()->m[5] * viewHeight * 0.5f;
+	vec3 eye = _camera->GetPosition();
+	eye.set(eye.x - _position.x, eye.y - _position.y, eye.z - _position.z);
+
+	for (unsigned int i = 0; i < _chunks.size(); i++)
+	{
+		terrainChunk_t* chunk = &_chunks[i];
+		float dx = eye.x < chunk->mins.x ? chunk->mins.x - eye.x : (eye.x > chunk->maxs.x ? eye.x - chunk->maxs.x : 0.f);
+		float dy = eye.y < chunk->mins.y ? chunk->mins.y - eye.y : (eye.y > chunk->maxs.y ? eye.y - chunk->maxs.y : 0.f);
+		float dz = eye.z < chunk->mins.z ? chunk->mins.z - eye.z : (eye.z > chunk->maxs.z ? eye.z - chunk->maxs.z : 0.f);
+		float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+
+		int lod = TERRAIN_LODS - 1;
+		while (lod > 0 && chunk->errors[lod] * scale > _maxError * dist)
+			lod--;
+		chunk->lod = lod;
+	}
+
+	// neighbors at most one level apart, levels only go down so it ends
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (int cz = 0; cz < _chunksZ; cz++)
+		{
+			for (int cx = 0; cx < _chunksX; cx++)
+			{
+				terrainChunk_t* chunk = &_chunks[cz * _chunksX + cx];
+				int finest = chunk->lod;
+				if (cx > 0) finest = _chunks[cz * _chunksX + cx - 1].lod < finest ? _chunks[cz * _chunksX + cx - 1].lod : finest;
+				if (cx < _chunksX - 1) finest = _chunks[cz * _chunksX + cx + 1].lod < finest ? _chunks[cz * _chunksX + cx + 1].lod : finest;
+				if (cz > 0) finest = _chunks[(cz - 1) * _chunksX + cx].lod < finest ? _chunks[(cz - 1) * _chunksX + cx].lod : finest;
+				if (cz < _chunksZ - 1) finest = _chunks[(cz + 1) * _chunksX + cx].lod < finest ? _chunks[(cz + 1) * _chunksX + cx].lod : finest;
+				if (chunk->lod > finest + 1)
+				{
+					chunk->lod = finest + 1;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+void Terrain::Draw( int viewHeight )
+{
+	if (_camera == NULL || _chunks.size() == 0)
+		return;
+	if (_shader == NULL && !InitDraw())
+		return;
+	if (_shader->GetProgarm() == 0)
+		return;
+
+	double start = Sys_GetClockTicks();
+	SelectLods(viewHeight);
+
+	// the model matrix is a translation, so the chunks are culled in
+	// local space against viewProj * translate
+	mat4 model;
+	model.buildTranslate(_position);
+	mat4 wvp = *_camera->GetViewProj() * model;
+	_frustum.FromMatrix(wvp);
+	_stats.drawn = 0;
+	_stats.triangles = 0;
+	for (unsigned int i = 0; i < _chunks.size(); i++)
+	{
+		terrainChunk_t* chunk = &_chunks[i];
+		chunk->visible = _frustum.IntersectsBox(chunk->mins, chunk->maxs);
+	}
+	_stats.updateMsec = (float)((Sys_GetClockTicks() - start) * 1000.0 / Sys_ClockTicksPerSecond());
+
+	glUseProgram(_shader->GetProgarm());
+	glUniformMatrix4fv(_shader->GetUniform(eUniform_MVP), 1, GL_FALSE, wvp.m);
+	glUniform1i(_shader->GetUniform(eUniform_Samper0), 0);
+	glUniform3f(_shader->GetUniform(eUniform_Direction), 0.4f, 0.8f, 0.4f);
+	glBindTexture(GL_TEXTURE_2D, _texture->GetName());
+
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+	for (int i = 0; i < 3; i++)
+		glEnableVertexAttribArray(i);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(terrainVert_t), 0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(terrainVert_t), (GLvoid*)12);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(terrainVert_t), (GLvoid*)20);
+
+	for (int cz = 0; cz < _chunksZ; cz++)
+	{
+		for (int cx = 0; cx < _chunksX; cx++)
+		{
+			int c = cz * _chunksX + cx;
+			const terrainChunk_t& chunk = _chunks[c];
+			if (!chunk.visible)
+				continue;
+
+			int mask = 0;
+			if (cx > 0 && _chunks[c - 1].lod > chunk.lod) mask |= TERRAIN_EDGE_LEFT;
+			if (cx < _chunksX - 1 && _chunks[c + 1].lod > chunk.lod) mask |= TERRAIN_EDGE_RIGHT;
+			if (cz > 0 && _chunks[c - _chunksX].lod > chunk.lod) mask |= TERRAIN_EDGE_TOP;
+			if (cz < _chunksZ - 1 && _chunks[c + _chunksX].lod > chunk.lod) mask |= TERRAIN_EDGE_BOTTOM;
+
+			int count = _indexCounts[chunk.lod][mask];
+			GLvoid* offset = (GLvoid*)(size_t)(_indexOffsets[chunk.lod][mask] * sizeof(unsigned short));
+			glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, offset, c * TERRAIN_CHUNK_VERTS * TERRAIN_CHUNK_VERTS);
+			glCounters.drawCalls++;
+			_stats.drawn++;
+			_stats.triangles += count / 3;
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+		glDisableVertexAttribArray(i);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GL_CheckError("terrain:draw");
+}
+
+void Terrain::GetStats( terrainStats_t* stats )
+{
+	*stats = _stats;
+}
@@ -0,0 +1,140 @@
+#ifndef __TERRAIN_H__
+#define __TERRAIN_H__
+
+#include "common/vec3.h"
+#include "common/array.h"
+#include "common/Frustum.h"
+
+class Texture;
+class Camera;
+class Shader;
+
+#define TERRAIN_CHUNK_QUADS		32
+#define TERRAIN_CHUNK_VERTS		(TERRAIN_CHUNK_QUADS + 1)
+#define TERRAIN_LODS			6			// 1 to 32 quads a step
+#define TERRAIN_STITCH_MASKS	16			// edges that meet a coarser chunk
+#define TERRAIN_MAX_ERROR		2.f			// pixels
+
+// the edges of a chunk, bits of the stitch mask
+#define TERRAIN_EDGE_LEFT		1			// x = 0
+#define TERRAIN_EDGE_RIGHT		2
+#define TERRAIN_EDGE_TOP		4			// z = 0
+#define TERRAIN_EDGE_BOTTOM		8
+
+/*
+===============================================================================
+
+	Heightmap terrain
+
+	The heightmap is cut into chunks of TERRAIN_CHUNK_QUADS quads a side.
+	Every chunk has its own 33 x 33 vertices in one vertex buffer, so the
+	16 bit indexes of a chunk are the same for all of them and one index
+	buffer holds every level of detail: level l takes every 2^l-th vertex,
+	in 16 variants for the edges that border a chunk one level coarser.
+	On such an edge the vertices between the coarse ones are snapped onto
+	their neighbor, so both sides share the same edge and there are no
+	cracks; the triangles that collapse are left out. A chunk is drawn
+	with glDrawElementsBaseVertex at its first vertex.
+
+	Each level stores its geometric error, the largest height difference
+	between the dropped vertices and the coarser surface. Per frame the
+	level of a chunk is the coarsest one whose error, projected at the
+	distance of the camera to the chunk's bounds, stays under
+	TERRAIN_MAX_ERROR pixels; neighbors are then pulled to within one
+	level of each other, and chunks outside the frustum aren't drawn.
+
+	GetHeight and GetNormal sample the full detail surface in world
+	space, the triangles are split the same way as the drawn ones.
+
+===============================================================================
+*/
+
+typedef struct
+{
+	float xyz[3];
+	float st[2];
+	float normal[3];
+}terrainVert_t;
+
+typedef struct
+{
+	vec3 mins;				// local space
+	vec3 maxs;
+	float errors[TERRAIN_LODS];	// world units
+	int lod;
+	bool visible;
+}terrainChunk_t;
+
+typedef struct
+{
+	int chunks;
+	int drawn;
+	int triangles;
+	float updateMsec;		// level selection and culling
+}terrainStats_t;
+
+class Terrain
+{
+public:
+	Terrain();
+	~Terrain();
+
+	// a grayscale heightmap, one vertex per pixel cellSize apart, white
+	// is heightScale high
+	bool Init(const char* heightmap, float cellSize, float heightScale);
+
+	// the heightmap itself until set
+	void SetTexture(const char* imgPath);
+
+	// the corner of the first pixel
+	void SetPosition(float x, float y, float z);
+
+	void SetCamera(Camera* camera);
+
+	// screen space error of the level selection, in pixels
+	void SetMaxError(float pixels);
+
+	// world height under x, z, the edge height outside the map
+	float GetHeight(float x, float z) const;
+
+	// world normal of the surface under x, z
+	vec3 GetNormal(float x, float z) const;
+
+	// selects the levels, culls and draws the chunks
+	void Draw(int viewHeight);
+
+	void GetStats(terrainStats_t* stats);
+
+private:
+	float Height(int x, int z) const;
+	void BuildVertices(terrainVert_t* verts);
+	void BuildIndexes();
+	void BuildErrors(terrainChunk_t* chunk, int cx, int cz);
+	void SelectLods(int viewHeight);
+	bool InitDraw();
+
+private:
+	array<float> _heights;		// heightScale applied
+	int _width;					// heightmap pixels
+	int _depth;
+	int _chunksX;
+	int _chunksZ;
+	array<terrainChunk_t> _chunks;
+	float _cellSize;
+	float _maxError;
+	vec3 _position;
+
+	Texture* _texture;
+	Camera* _camera;
+	Frustum _frustum;
+	terrainStats_t _stats;
+
+	array<unsigned short> _indexes;
+	int _indexOffsets[TERRAIN_LODS][TERRAIN_STITCH_MASKS];
+	int _indexCounts[TERRAIN_LODS][TERRAIN_STITCH_MASKS];
+	Shader* _shader;
+	unsigned int _vbo;
+	unsigned int _ibo;
+};
+
+#endif
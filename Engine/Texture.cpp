@@ -1,7 +1,20 @@
 #include "Texture.h"
 #include "Image.h"
+#include "renderer/GpuMemory.h"
+#include "renderer/TextureArray.h"
+#include <string.h>
 
-bool Texture::Init(Image* i)
+Texture::~Texture()
+{
+	// a layer gives its view and its place in the page back
+	if (_arrayName != 0)
+	{
+		R_DeleteTexture(_name);
+		R_ReleaseArrayLayer(_arrayName, _layer);
+	}
+}
+
+bool Texture::Init(Image* i, GLuint pbo, int firstLevel)
 {
 	if (i== nullptr)
 		return false;
@@ -16,28 +29,104 @@ bool Texture::Init(Image* i)
 
 	_pixelsWide = i->_width;
 	_pixelsHigh = i->_height;
-	int w = _pixelsWide;
-	int h = _pixelsHigh;
-	for (int l=0; l<i->GetMipLevels(); ++l)
+	_streamId = -1;
+	for (int l=firstLevel; l<i->GetMipLevels(); ++l)
+		UploadLevel(i, l, pbo);
+
+	// files with a mip chain sample it, the rest stay on one level
+	if (i->GetMipLevels() > 1)
 	{
-		if (i->IsCompressed())
-		{
-		}
-		else
-		{
-			glTexImage2D(GL_TEXTURE_2D, l, i->_internalFormat, (GLsizei)w, (GLsizei)h, 0, 
-				i->_format, i->_type, i->GetLevel(l));
-			w >>= 1;
-			h >>= 1;
-			w = w ? w : 1;
-			h = h ? h : 1;
-		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, i->GetMipLevels() - 1);
 	}
+	if (firstLevel > 0)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
 
 	GL_CheckError("texture:init");
+	_ready = true;
 	return true;
 }
 
+void Texture::UploadLevel(const Image* i, int level, GLuint pbo)
+{
+	int w = i->_width >> level;
+	int h = i->_height >> level;
+	w = w ? w : 1;
+	h = h ? h : 1;
+
+	int size = i->GetImageSize(level);
+	const void* pixels = i->GetLevel(level);
+	if (pbo)
+	{
+		// orphan the buffer so the copy never waits on the previous
+		// transfer, the driver moves the data to the texture later
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		R_GpuMemDelete(GL_BUFFER, pbo);
+		R_GpuMemAlloc(GL_BUFFER, pbo, GPUMEM_STAGING, size);
+		void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (dst)
+		{
+			memcpy(dst, pixels, size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			pixels = NULL;
+		}
+	}
+
+	// block compressed levels go up as they are, the driver doesn't
+	// decode or re-encode them
+	if (i->IsCompressed())
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, i->_internalFormat, (GLsizei)w, (GLsizei)h, 0,
+			size, pixels);
+	else
+	{
+		// the levels are tightly packed, an rgb row isn't always a
+		// multiple of the default 4 byte alignment
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, level, i->_internalFormat, (GLsizei)w, (GLsizei)h, 0, 
+			i->_format, i->_type, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	if (pbo)
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glCounters.uploadBytes += size;
+	R_GpuMemAlloc(GL_TEXTURE, _name, GPUMEM_TEXTURE, size);
+}
+
+void Texture::DropLevel(const Image* i, int level)
+{
+	// a 0x0 level releases its storage, the base level keeps the
+	// texture complete without it
+	glBindTexture(GL_TEXTURE_2D, _name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+	glTexImage2D(GL_TEXTURE_2D, level, i->_internalFormat, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	R_GpuMemRelease(GL_TEXTURE, _name, i->GetImageSize(level));
+}
+
+void Texture::SetBaseLevel(int level)
+{
+	glBindTexture(GL_TEXTURE_2D, _name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+}
+
+void Texture::InitPending(Texture* placeholder)
+{
+	_name = placeholder->_name;
+	_arrayName = placeholder->_arrayName;
+	_layer = placeholder->_layer;
+	_pixelsWide = placeholder->_pixelsWide;
+	_pixelsHigh = placeholder->_pixelsHigh;
+	// draws share the placeholder's levels, so they count for its streaming
+	_streamId = placeholder->_streamId;
+	_ready = false;
+}
+
+bool Texture::IsReady()
+{
+	return _ready;
+}
+
 bool Texture::Init(int w, int h, void* data)
 {
 	glGenTextures(1, &_name);
@@ -52,10 +141,33 @@ bool Texture::Init(int w, int h, void* data)
 	_pixelsHigh = h;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glCounters.uploadBytes += w * h * 4;
+	R_GpuMemAlloc(GL_TEXTURE, _name, GPUMEM_TEXTURE, w * h * 4);
 	return true;
 }
 
+void Texture::InitLayer(GLuint view, GLuint page, int layer, int w, int h)
+{
+	_name = view;
+	_arrayName = page;
+	_layer = layer;
+	_pixelsWide = w;
+	_pixelsHigh = h;
+	_streamId = -1;
+	_ready = true;
+}
+
 GLuint Texture::GetName()
 {
 	return _name;
+}
+
+GLuint Texture::GetArrayName()
+{
+	return _arrayName;
+}
+
+int Texture::GetLayer()
+{
+	return _layer;
 }
\ No newline at end of file
@@ -8,22 +8,48 @@ class  Image;
 class Texture
 {
 public:
-	Texture() {}
-	virtual ~Texture() {}
+	Texture() : _streamId(-1), _name(0), _arrayName(0), _layer(-1), _ready(true) {}
+	virtual ~Texture();
 	
-	bool Init(Image* i);
+	// with a pixel buffer object the levels are staged through it, levels
+	// finer than firstLevel are left for the streamer
+	bool Init(Image* i, GLuint pbo = 0, int firstLevel = 0);
+
+	// the texture must be bound, the streamer lowers the base level after
+	void UploadLevel(const Image* i, int level, GLuint pbo);
+	void DropLevel(const Image* i, int level);
+	void SetBaseLevel(int level);
+
+	// draws as the placeholder until Init is called
+	void InitPending(Texture* placeholder);
+
+	bool IsReady();
 
 	bool Init(int w, int h, void* data);
 
+	// a layer of an array page, view is a 2d texture view of just that
+	// layer (see renderer/TextureArray.h)
+	void InitLayer(GLuint view, GLuint page, int layer, int w, int h);
+
 	GLuint GetName();
 
+	// the page, 0 when the texture has storage of its own
+	GLuint GetArrayName();
+	int GetLayer();
+
     int _pixelsWide;
 
     int _pixelsHigh;
 
-private:
+    int _streamId;		// see TextureStreamer.h, -1 when every level is resident
+
+protected:
     GLuint _name;
 
+    GLuint _arrayName;
+
+    int _layer;
+
     /** texture max S */
     GLfloat _maxS;
     
@@ -35,6 +61,8 @@ private:
 
     bool _antialiasEnabled;
 
+    bool _ready;
+
 };
 
 #endif
\ No newline at end of file
@@ -68,6 +68,38 @@ static int model_setfile(lua_State* L){
     return 0;
 }
 
+static int model_setmaterial(lua_State* L){
+    Model* cobj = *reinterpret_cast<Model**>(lua_touserdata(L, 1));
+    if (!cobj) {
+        luaL_error(L,"invalid 'cobj' in function 'SetMaterial'", nullptr);
+        return 0;
+    }
+
+    int argc = lua_gettop(L)-1;
+    if (argc == 1) {
+        const char* arg0 = lua_tostring(L, 2);
+        cobj->SetMaterial(arg0);
+    }
+
+    return 0;
+}
+
+static int model_setkeywords(lua_State* L){
+    Model* cobj = *reinterpret_cast<Model**>(lua_touserdata(L, 1));
+    if (!cobj) {
+        luaL_error(L,"invalid 'cobj' in function 'SetKeywords'", nullptr);
+        return 0;
+    }
+
+    int argc = lua_gettop(L)-1;
+    if (argc == 1) {
+        const char* arg0 = lua_tostring(L, 2);
+        cobj->SetKeywords(arg0);
+    }
+
+    return 0;
+}
+
 
 int luaopen_model(lua_State* L)
 {
@@ -78,6 +110,8 @@ int luaopen_model(lua_State* L)
         Lua_PushFunction(L, "setViewProj", model_setviewproj);
         Lua_PushFunction(L, "setPosition", model_setposition);
         Lua_PushFunction(L, "getPosition", model_getposition);
+        Lua_PushFunction(L, "setMaterial", model_setmaterial);
+        Lua_PushFunction(L, "setKeywords", model_setkeywords);
         Lua_PushFunction(L, "setFile", model_setfile);
     }
     return 1;
@@ -0,0 +1,78 @@
+#include "../luautils.h"
+#include "../framework/Profiler.h"
+#include "../framework/Common.h"
+#include "../framework/Trace.h"
+
+// profile.table() -> { { name, thread, depth, gpu, calls, last, avg, max }, ... }
+static int profile_table(lua_State* L){
+	int numRows = Prof_GetNumRows();
+	lua_createtable(L, numRows, 0);
+	for (int i = 0; i < numRows; i++) {
+		profileRow_t row;
+		Prof_GetRow(i, &row);
+
+		lua_createtable(L, 0, 8);
+		lua_pushstring(L, row.name);
+		lua_setfield(L, -2, "name");
+		lua_pushstring(L, row.thread);
+		lua_setfield(L, -2, "thread");
+		lua_pushinteger(L, row.depth);
+		lua_setfield(L, -2, "depth");
+		lua_pushboolean(L, row.gpu);
+		lua_setfield(L, -2, "gpu");
+		lua_pushinteger(L, row.calls);
+		lua_setfield(L, -2, "calls");
+		lua_pushnumber(L, row.lastMs);
+		lua_setfield(L, -2, "last");
+		lua_pushnumber(L, row.avgMs);
+		lua_setfield(L, -2, "avg");
+		lua_pushnumber(L, row.maxMs);
+		lua_setfield(L, -2, "max");
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+static int profile_print(lua_State* L){
+	Prof_PrintTable();
+	return 0;
+}
+
+static int profile_overlay(lua_State* L){
+	show_profile = lua_toboolean(L, 1) != 0;
+	return 0;
+}
+
+static int profile_enable(lua_State* L){
+	Prof_SetEnable(lua_toboolean(L, 1) != 0);
+	return 0;
+}
+
+// profile.tracestart([file], [frames]), frames = 0 runs until profile.tracestop()
+static int profile_tracestart(lua_State* L){
+	const char* filename = luaL_optstring(L, 1, "trace.json");
+	int frames = luaL_optint(L, 2, 0);
+	lua_pushboolean(L, Trace_Start(filename, frames));
+	return 1;
+}
+
+static int profile_tracestop(lua_State* L){
+	Trace_Stop();
+	return 0;
+}
+
+static const luaL_Reg profilelib[] = {
+	{"table", profile_table},
+	{"print", profile_print},
+	{"overlay", profile_overlay},
+	{"enable", profile_enable},
+	{"tracestart", profile_tracestart},
+	{"tracestop", profile_tracestop},
+	{NULL, NULL}
+};
+
+int luaopen_profile(lua_State* L)
+{
+	luaL_register(L, "profile", profilelib);
+	return 1;
+}
@@ -1,5 +1,5 @@
 #include "../luautils.h"
-#include "../renderer\RenderSystem.h"
+#include "../renderer/RenderSystem.h"
 
 static int rendersystem_adddrawsur(lua_State* L){
     RenderSystem* cobj = *reinterpret_cast<RenderSystem**>(lua_touserdata(L, 1));
@@ -84,6 +84,22 @@ static int sprite_setviewproj(lua_State* L){
     return 0;
 }
 
+static int sprite_setkeywords(lua_State* L){
+    Sprite* cobj = *reinterpret_cast<Sprite**>(lua_touserdata(L, 1));
+    if (!cobj) {
+        luaL_error(L,"invalid 'cobj' in function 'SetKeywords'", nullptr);
+        return 0;
+    }
+
+    int argc = lua_gettop(L)-1;
+    if (argc == 1) {
+        const char* arg0 = lua_tostring(L, 2);
+        cobj->SetKeywords(arg0);
+    }
+
+    return 0;
+}
+
 int luaopen_sprite(lua_State* L)
 {
     if (luaL_newmetatable(L, "Sprite")) {
@@ -95,6 +111,7 @@ int luaopen_sprite(lua_State* L)
         Lua_PushFunction(L, "getPosition", sprite_getposition);
         Lua_PushFunction(L, "setPosition", sprite_setposition);
 		Lua_PushFunction(L, "setViewProj", sprite_setviewproj);
+        Lua_PushFunction(L, "setKeywords", sprite_setkeywords);
     }
     return 1;
 }
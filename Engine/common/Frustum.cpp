@@ -0,0 +1,31 @@
+#include "Frustum.h"
+#include "mat4.h"
+
+void Frustum::FromMatrix(const mat4& viewProj)
+{
+	// row i of the column major matrix is m[i], m[4 + i], m[8 + i], m[12 + i]
+	const float* m = viewProj.m;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			_planes[i * 2][j] = m[j * 4 + 3] + m[j * 4 + i];
+			_planes[i * 2 + 1][j] = m[j * 4 + 3] - m[j * 4 + i];
+		}
+	}
+}
+
+bool Frustum::IntersectsBox(const vec3& mins, const vec3& maxs) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		// the corner furthest along the plane normal
+		const float* p = _planes[i];
+		float x = p[0] >= 0.f ? maxs.x : mins.x;
+		float y = p[1] >= 0.f ? maxs.y : mins.y;
+		float z = p[2] >= 0.f ? maxs.z : mins.z;
+		if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.f)
+			return false;
+	}
+	return true;
+}
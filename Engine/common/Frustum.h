@@ -0,0 +1,36 @@
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+#include "vec3.h"
+
+class mat4;
+
+/*
+===============================================================================
+
+	View frustum
+
+	The six planes are taken from the rows of a view projection matrix
+	(Gribb and Hartmann), so a box tested against a frustum built from
+	projection * view is in world space, and one tested against
+	projection * view * model in model space. The planes aren't
+	normalized; only their sides are used.
+
+===============================================================================
+*/
+
+class Frustum
+{
+public:
+	Frustum() {}
+
+	void FromMatrix(const mat4& viewProj);
+
+	// false when the box is entirely outside one of the planes
+	bool IntersectsBox(const vec3& mins, const vec3& maxs) const;
+
+private:
+	float _planes[6][4];		// a * x + b * y + c * z + d >= 0 inside
+};
+
+#endif
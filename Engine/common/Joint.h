@@ -4,7 +4,7 @@
 #include "vec3.h"
 #include "mat4.h"
 #include "quat.h"
-#include "str.h"
+#include "Str.h"
 #include "array.h"
 
 
@@ -0,0 +1,65 @@
+#include "RadixSort.h"
+#include <string.h>
+
+// the unsigned int with the same order as the float
+static inline unsigned int R_FloatKey(float f)
+{
+	unsigned int u;
+	memcpy(&u, &f, sizeof(u));
+	return (u & 0x80000000) ? ~u : (u | 0x80000000);
+}
+
+const unsigned int* RadixSort::Sort(const float* keys, unsigned int count)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		_keys[i].set_used(count);
+		_indexes[i].set_used(count);
+	}
+	if (count == 0)
+		return _indexes[0].const_pointer();
+
+	memset(_histograms, 0, sizeof(_histograms));
+	unsigned int* srcKeys = _keys[0].pointer();
+	unsigned int* srcIndexes = _indexes[0].pointer();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int k = R_FloatKey(keys[i]);
+		srcKeys[i] = k;
+		srcIndexes[i] = i;
+		_histograms[0][k & (RADIX_BUCKETS - 1)]++;
+		_histograms[1][(k >> RADIX_BITS) & (RADIX_BUCKETS - 1)]++;
+		_histograms[2][k >> (2 * RADIX_BITS)]++;
+	}
+
+	int src = 0;
+	for (int pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		int shift = pass * RADIX_BITS;
+		unsigned int* offsets = _histograms[pass];
+		if (offsets[(_keys[src][0] >> shift) & (RADIX_BUCKETS - 1)] == count)
+			continue;
+
+		unsigned int sum = 0;
+		for (int b = 0; b < RADIX_BUCKETS; b++)
+		{
+			unsigned int n = offsets[b];
+			offsets[b] = sum;
+			sum += n;
+		}
+
+		const unsigned int* inKeys = _keys[src].const_pointer();
+		const unsigned int* inIndexes = _indexes[src].const_pointer();
+		unsigned int* outKeys = _keys[src ^ 1].pointer();
+		unsigned int* outIndexes = _indexes[src ^ 1].pointer();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			unsigned int k = inKeys[i];
+			unsigned int dst = offsets[(k >> shift) & (RADIX_BUCKETS - 1)]++;
+			outKeys[dst] = k;
+			outIndexes[dst] = inIndexes[i];
+		}
+		src ^= 1;
+	}
+	return _indexes[src].const_pointer();
+}
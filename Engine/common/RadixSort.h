@@ -0,0 +1,43 @@
+#ifndef __RADIXSORT_H__
+#define __RADIXSORT_H__
+
+#include "array.h"
+
+#define RADIX_BITS			11
+#define RADIX_BUCKETS		(1 << RADIX_BITS)
+#define RADIX_PASSES		3				// 33 bits cover a 32 bit key
+
+/*
+===============================================================================
+
+	Radix sort
+
+	Stable least significant digit radix sort of 32 bit float keys. Each
+	key is mapped to an unsigned int that orders the same way (negative
+	floats flip every bit, the others only the sign bit), the histograms
+	of all three 11 bit digits are counted in one read, and a pass whose
+	digit is the same for every key is skipped.
+
+	Sort hands back the order as indexes into the keys. The sorter keeps
+	its buffers between calls, so a sort every frame only allocates when
+	the count grows past the largest one so far.
+
+===============================================================================
+*/
+
+class RadixSort
+{
+public:
+	RadixSort() {}
+
+	// indexes of the keys in ascending order, equal keys keep theirs;
+	// valid until the next call
+	const unsigned int* Sort(const float* keys, unsigned int count);
+
+private:
+	array<unsigned int> _keys[2];
+	array<unsigned int> _indexes[2];
+	unsigned int _histograms[RADIX_PASSES][RADIX_BUCKETS];
+};
+
+#endif
@@ -27,7 +27,7 @@ If you have questions concerning this license or the applicable additional terms
 */
 
 #include "precompiled.h"
-#include "str.h"
+#include "Str.h"
 
 const char *units[2][4] =
 {
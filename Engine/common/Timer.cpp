@@ -3,7 +3,7 @@
 
 Timer::Timer()
 {
-#ifdef WIN32
+#ifdef _WIN32
     QueryPerformanceFrequency(&frequency);
     startCount.QuadPart = 0;
     endCount.QuadPart = 0;
@@ -24,7 +24,7 @@ Timer::~Timer()
 void Timer::start()
 {
     stopped = 0; // reset stop flag
-#ifdef WIN32
+#ifdef _WIN32
     QueryPerformanceCounter(&startCount);
 #else
     gettimeofday(&startCount, NULL);
@@ -36,7 +36,7 @@ void Timer::stop()
 {
     stopped = 1; // set timer stopped flag
 
-#ifdef WIN32
+#ifdef _WIN32
     QueryPerformanceCounter(&endCount);
 #else
     gettimeofday(&endCount, NULL);
@@ -46,7 +46,7 @@ void Timer::stop()
 
 double Timer::getElapsedTimeInMicroSec()
 {
-#ifdef WIN32
+#ifdef _WIN32
     if(!stopped)
         QueryPerformanceCounter(&endCount);
 
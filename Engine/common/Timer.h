@@ -1,8 +1,7 @@
 #ifndef __TIMER_H__
 #define __TIMER_H__
 
-#define  WIN32
-#ifdef WIN32   // Windows system specific
+#ifdef _WIN32   // Windows system specific
 #include <windows.h>
 #else          // Unix based system specific
 #include <sys/time.h>
@@ -30,7 +29,7 @@ private:
     double startTimeInMicroSec;                 // starting time in micro-second
     double endTimeInMicroSec;                   // ending time in micro-second
     int    stopped;                             // stop flag 
-#ifdef WIN32
+#ifdef _WIN32
     LARGE_INTEGER frequency;                    // ticks per second
     LARGE_INTEGER startCount;                   //
     LARGE_INTEGER endCount;                     //
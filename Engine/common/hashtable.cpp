@@ -34,11 +34,15 @@ void hashtable::Put( lfStr key, void* value )
 	hashnode* node = HashStr(key);
 	if (node->value == NULL)
 	{
+		node->key = key;
 		node->value = value;
 	}
 	else
 	{
 		hashnode* node = NewKey(key);
+		if (node == NULL)
+			return;
+		node->key = key;
 		node->value = value;
 	}
 }
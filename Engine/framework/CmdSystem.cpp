@@ -0,0 +1,91 @@
+#include "CmdSystem.h"
+#include "../sys/sys_public.h"
+#include "../common/array.h"
+#include <string.h>
+
+typedef struct
+{
+	const char* name;
+	const char* description;
+	cmdFunction_t func;
+}command_t;
+
+static array<command_t> commands;
+
+static void Cmd_List_f( int argc, const char** argv )
+{
+	Cmd_ListCommands();
+}
+
+static command_t* Cmd_Find( const char* name )
+{
+	for (unsigned int i = 0; i < commands.size(); i++)
+	{
+		if (strcmp(commands[i].name, name) == 0)
+			return &commands[i];
+	}
+	return NULL;
+}
+
+void Cmd_AddCommand( const char* name, cmdFunction_t func, const char* description )
+{
+	if (commands.size() == 0 && strcmp(name, "cmdlist") != 0)
+		Cmd_AddCommand("cmdlist", Cmd_List_f, "list all commands");
+
+	if (Cmd_Find(name) != NULL)
+	{
+		Sys_Printf("Cmd_AddCommand: %s already defined\n", name);
+		return;
+	}
+
+	command_t cmd;
+	cmd.name = name;
+	cmd.description = description;
+	cmd.func = func;
+	commands.push_back(cmd);
+}
+
+bool Cmd_ExecuteString( const char* text )
+{
+	char line[1024];
+	const char* argv[MAX_CMD_ARGS];
+	int argc = 0;
+
+	strncpy(line, text, sizeof(line) - 1);
+	line[sizeof(line) - 1] = 0;
+
+	char* p = line;
+	while (*p && argc < MAX_CMD_ARGS)
+	{
+		while (*p && (unsigned char)*p <= ' ')
+			p++;
+		if (!*p)
+			break;
+
+		argv[argc++] = p;
+		while (*p && (unsigned char)*p > ' ')
+			p++;
+		if (*p)
+			*p++ = 0;
+	}
+
+	if (argc == 0)
+		return true;
+
+	command_t* cmd = Cmd_Find(argv[0]);
+	if (cmd == NULL)
+	{
+		Sys_Printf("Unknown command '%s'\n", argv[0]);
+		return false;
+	}
+
+	cmd->func(argc, argv);
+	return true;
+}
+
+void Cmd_ListCommands()
+{
+	for (unsigned int i = 0; i < commands.size(); i++)
+		Sys_Printf("  %-16s %s\n", commands[i].name, commands[i].description ? commands[i].description : "");
+	Sys_Printf("%d commands\n", commands.size());
+}
@@ -0,0 +1,16 @@
+#ifndef __CMDSYSTEM_H__
+#define __CMDSYSTEM_H__
+
+#define MAX_CMD_ARGS 16
+
+// argv[0] is the command name
+typedef void (*cmdFunction_t)(int argc, const char** argv);
+
+void	Cmd_AddCommand(const char* name, cmdFunction_t func, const char* description);
+
+// splits the line on white space and runs the command, false if unknown
+bool	Cmd_ExecuteString(const char* text);
+
+void	Cmd_ListCommands();
+
+#endif
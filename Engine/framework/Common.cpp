@@ -1,13 +1,24 @@
 #include "Common.h"
 #include "../sys/sys_public.h"
 #include "../renderer/RenderSystem.h"
-#include "../common/str.h"
+#include "../common/Str.h"
 #include "../Game.h"
 #include "../ResourceSystem.h"
 #include "../ScriptSystem.h"
+#include "../Material.h"
+#include "../renderer/TextureLoader.h"
+#include "../renderer/TextureStreamer.h"
+#include "../renderer/GeometryArena.h"
+#include "../renderer/MultiDraw.h"
+#include "../renderer/TextureArray.h"
+#include "../renderer/Billboard.h"
+#include "../ParticleSystem.h"
+#include "Profiler.h"
+#include "Trace.h"
 
 char* win_name = "null";
 bool show_fps = false;
+bool show_profile = false;
 int win_width = 800;
 int win_height = 600;
 ResourceSystem* resourceSys;
@@ -21,6 +32,8 @@ void Com_Init()
 	pram.displayHz = 1/60;
 	pram.stereo = 1/60;
 
+	Trace_Init();
+
 	resourceSys = new ResourceSystem;
 
 	Sys_Printf("Initializing RenderSystem\n");
@@ -34,11 +47,18 @@ void Com_Init()
 
 void Com_Frame()
 {
-	game->Frame();
-	renderSys->FrameUpdate();
+	{
+		PROFILE_SCOPE("frame");
+		{
+			PROFILE_SCOPE("game");
+			game->Frame();
+		}
+		renderSys->FrameUpdate();
+	}
+	Prof_EndFrame();
 
 	// report timing information
-	if ( show_fps ) {
+	if ( show_fps || show_profile ) {
 		static int	lastTime = 0;
 		static int	frames = 0;
 		
@@ -52,8 +72,12 @@ void Com_Frame()
 			lastTime	= nowTime;						//set time for the start of the next count
 			frames		=0;								//reset fps for this second
 			
-			char buff[255];
-			sprintf( buff, "FPS: %.02f, run: %d  num of surface: %d", fps, nowTime, renderSys->GetNumSurf() );
+			static char buff[8192];
+			int len = sprintf( buff, "FPS: %.02f, run: %d  num of surface: %d", fps, nowTime, renderSys->GetNumSurf() );
+			if ( show_profile ) {
+				buff[len++] = '\n';
+				Prof_FormatTable( buff + len, sizeof(buff) - len );
+			}
 			renderSys->DrawString(buff);
 		}
 	}	
@@ -61,5 +85,14 @@ void Com_Frame()
 
 void Com_Quit()
 {
+	if (GL_DISK_CACHES)
+		R_SaveMaterialVariants(MTR_VARIANT_LIST);
+	R_ShutdownParticles();
+	R_ShutdownTextureLoader();
+	R_ShutdownTextureStreamer();
+	R_ShutdownMultiDraw();
+	R_ShutdownTextureArrays();
+	R_ShutdownBillboards();
+	R_ShutdownGeometryArena();
 	Sys_Quit();
 }
@@ -7,4 +7,9 @@ void Com_Frame();
 
 void Com_Quit();
 
+extern bool show_fps;
+
+// profiler table in the fps label
+extern bool show_profile;
+
 #endif /* !__COMMON_H__ */
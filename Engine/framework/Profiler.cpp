@@ -0,0 +1,400 @@
+#include "Profiler.h"
+#include "../sys/sys_public.h"
+#include "../renderer/GpuTimer.h"
+#include "../common/array.h"
+#include "Trace.h"
+#include <mutex>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+#ifdef _WIN32
+#define vsnprintf _vsnprintf
+#endif
+
+#define PROF_GPU_THREAD MAX_PROFILE_THREADS
+
+typedef struct
+{
+	int zone;
+	int thread;
+	int order;
+	int depth;
+	int calls;
+	float history[PROFILE_HISTORY];
+	float lastMs;
+	float avgMs;
+	float maxMs;
+}profRow_t;
+
+typedef struct
+{
+	double ticks;
+	int calls;
+	int order;		// -1 until the zone is first entered on this thread
+	int depth;
+}profAccum_t;
+
+typedef struct
+{
+	int zone;
+	double start;
+}profOpen_t;
+
+typedef struct
+{
+	int index;
+	char name[32];
+	std::mutex lock;		// taken by the owner on zone end and by Prof_EndFrame
+	profOpen_t stack[MAX_PROFILE_DEPTH];
+	int depth;
+	int numOrdered;
+	profAccum_t accum[MAX_PROFILE_ZONES];
+	profRow_t* rows[MAX_PROFILE_ZONES];
+}profThread_t;
+
+static std::mutex prof_lock;
+static char prof_zoneNames[MAX_PROFILE_ZONES][48];
+static int prof_numZones = 0;
+
+static profThread_t* prof_threads[MAX_PROFILE_THREADS + 1];
+static int prof_numThreads = 0;
+static SYS_THREAD_LOCAL profThread_t* prof_thread = NULL;
+
+static profThread_t* prof_gpu = NULL;
+static GpuTimer* prof_gpuTimers[MAX_PROFILE_ZONES];
+
+static array<profRow_t*> prof_rows;
+static int prof_frame = 0;
+static bool prof_enabled = true;
+
+static profThread_t* Prof_AllocThread( int index, const char* name )
+{
+	profThread_t* t = new profThread_t;
+	t->index = index;
+	strncpy(t->name, name, sizeof(t->name) - 1);
+	t->name[sizeof(t->name) - 1] = 0;
+	t->depth = 0;
+	t->numOrdered = 0;
+	for (int i = 0; i < MAX_PROFILE_ZONES; i++)
+	{
+		t->accum[i].ticks = 0.0;
+		t->accum[i].calls = 0;
+		t->accum[i].order = -1;
+		t->accum[i].depth = 0;
+		t->rows[i] = NULL;
+	}
+	return t;
+}
+
+static profThread_t* Prof_GetThread()
+{
+	if (prof_thread != NULL)
+		return prof_thread;
+
+	std::lock_guard<std::mutex> guard(prof_lock);
+	if (prof_numThreads >= MAX_PROFILE_THREADS)
+		return NULL;
+
+	char name[32];
+	if (prof_numThreads == 0)
+		strcpy(name, "main");
+	else
+		sprintf(name, "thread %d", prof_numThreads);
+
+	prof_thread = Prof_AllocThread(prof_numThreads, name);
+	prof_threads[prof_numThreads++] = prof_thread;
+	return prof_thread;
+}
+
+int Prof_RegisterZone( const char* name )
+{
+	std::lock_guard<std::mutex> guard(prof_lock);
+	for (int i = 0; i < prof_numZones; i++)
+	{
+		if (strcmp(prof_zoneNames[i], name) == 0)
+			return i;
+	}
+
+	if (prof_numZones >= MAX_PROFILE_ZONES)
+		return -1;
+
+	strncpy(prof_zoneNames[prof_numZones], name, sizeof(prof_zoneNames[0]) - 1);
+	prof_zoneNames[prof_numZones][sizeof(prof_zoneNames[0]) - 1] = 0;
+	return prof_numZones++;
+}
+
+static void Prof_Enter( profThread_t* t, int zone, double start )
+{
+	if (t->depth < MAX_PROFILE_DEPTH)
+	{
+		t->stack[t->depth].zone = prof_enabled ? zone : -1;
+		t->stack[t->depth].start = start;
+		if (zone >= 0 && t->accum[zone].order < 0)
+		{
+			t->accum[zone].order = t->numOrdered++;
+			t->accum[zone].depth = t->depth;
+		}
+	}
+	t->depth++;
+}
+
+static int Prof_Leave( profThread_t* t, double* start )
+{
+	t->depth--;
+	if (t->depth < 0 || t->depth >= MAX_PROFILE_DEPTH)
+	{
+		if (t->depth < 0)
+			t->depth = 0;
+		return -1;
+	}
+	*start = t->stack[t->depth].start;
+	return t->stack[t->depth].zone;
+}
+
+void Prof_BeginZone( int zone )
+{
+	profThread_t* t = Prof_GetThread();
+	if (t != NULL)
+		Prof_Enter(t, zone, Sys_GetClockTicks());
+}
+
+void Prof_EndZone()
+{
+	double end = Sys_GetClockTicks();
+	profThread_t* t = Prof_GetThread();
+	if (t == NULL)
+		return;
+
+	double start;
+	int zone = Prof_Leave(t, &start);
+	if (zone < 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(t->lock);
+		t->accum[zone].ticks += end - start;
+		t->accum[zone].calls++;
+	}
+
+	if (Trace_IsCapturing())
+		Trace_Zone(zone, start, end);
+}
+
+void Prof_BeginGpuZone( const char* name )
+{
+	if (prof_gpu == NULL)
+		prof_gpu = Prof_AllocThread(PROF_GPU_THREAD, "gpu");
+
+	int zone = prof_enabled ? Prof_RegisterZone(name) : -1;
+	Prof_Enter(prof_gpu, zone, 0.0);
+	if (zone < 0)
+		return;
+
+	if (prof_gpuTimers[zone] == NULL)
+		prof_gpuTimers[zone] = new GpuTimer;
+	prof_gpuTimers[zone]->Begin();
+}
+
+void Prof_EndGpuZone()
+{
+	if (prof_gpu == NULL)
+		return;
+
+	double start;
+	int zone = Prof_Leave(prof_gpu, &start);
+	if (zone < 0)
+		return;
+
+	prof_gpuTimers[zone]->End();
+	prof_gpu->accum[zone].calls++;
+}
+
+static profRow_t* Prof_AddRow( profThread_t* t, int zone )
+{
+	profRow_t* row = new profRow_t;
+	memset(row, 0, sizeof(profRow_t));
+	row->zone = zone;
+	row->thread = t->index;
+	row->order = t->accum[zone].order;
+	row->depth = t->accum[zone].depth;
+	t->rows[zone] = row;
+
+	// keep the list sorted by thread, then by first entry
+	prof_rows.push_back(row);
+	for (int i = (int)prof_rows.size() - 1; i > 0; i--)
+	{
+		profRow_t* prev = prof_rows[i - 1];
+		if (prev->thread < row->thread || (prev->thread == row->thread && prev->order < row->order))
+			break;
+		prof_rows[i] = prev;
+		prof_rows[i - 1] = row;
+	}
+	return row;
+}
+
+static void Prof_GatherThread( profThread_t* t, int slot, double msPerTick )
+{
+	std::lock_guard<std::mutex> guard(t->lock);
+	for (int z = 0; z < prof_numZones; z++)
+	{
+		profAccum_t& acc = t->accum[z];
+		profRow_t* row = t->rows[z];
+		if (row == NULL)
+		{
+			if (acc.calls == 0)
+				continue;
+			row = Prof_AddRow(t, z);
+		}
+
+		if (t->index == PROF_GPU_THREAD)
+			row->history[slot] = acc.calls > 0 ? (float)prof_gpuTimers[z]->GetMs() : 0.f;
+		else
+			row->history[slot] = (float)(acc.ticks * msPerTick);
+		row->calls = acc.calls;
+		acc.ticks = 0.0;
+		acc.calls = 0;
+	}
+}
+
+void Prof_EndFrame()
+{
+	if (!prof_enabled)
+		return;
+
+	int slot = prof_frame % PROFILE_HISTORY;
+	double msPerTick = 1000.0 / Sys_ClockTicksPerSecond();
+
+	int numThreads;
+	{
+		std::lock_guard<std::mutex> guard(prof_lock);
+		numThreads = prof_numThreads;
+	}
+	for (int i = 0; i < numThreads; i++)
+		Prof_GatherThread(prof_threads[i], slot, msPerTick);
+	if (prof_gpu != NULL)
+		Prof_GatherThread(prof_gpu, slot, msPerTick);
+
+	Trace_FrameMark(prof_frame);
+
+	prof_frame++;
+	int numFrames = prof_frame < PROFILE_HISTORY ? prof_frame : PROFILE_HISTORY;
+	for (unsigned int r = 0; r < prof_rows.size(); r++)
+	{
+		profRow_t* row = prof_rows[r];
+		float total = 0.f;
+		row->maxMs = 0.f;
+		for (int f = 0; f < numFrames; f++)
+		{
+			total += row->history[f];
+			if (row->history[f] > row->maxMs)
+				row->maxMs = row->history[f];
+		}
+		row->lastMs = row->history[slot];
+		row->avgMs = total / numFrames;
+	}
+}
+
+void Prof_SetEnable( bool enable )
+{
+	prof_enabled = enable;
+}
+
+bool Prof_IsEnabled()
+{
+	return prof_enabled;
+}
+
+void Prof_SetThreadName( const char* name )
+{
+	profThread_t* t = Prof_GetThread();
+	if (t == NULL)
+		return;
+
+	std::lock_guard<std::mutex> guard(t->lock);
+	strncpy(t->name, name, sizeof(t->name) - 1);
+}
+
+const char* Prof_GetZoneName( int zone )
+{
+	if (zone < 0 || zone >= prof_numZones)
+		return "";
+	return prof_zoneNames[zone];
+}
+
+const char* Prof_GetThreadName()
+{
+	profThread_t* t = Prof_GetThread();
+	return t != NULL ? t->name : "";
+}
+
+int Prof_GetNumRows()
+{
+	return prof_rows.size();
+}
+
+void Prof_GetRow( int index, profileRow_t* row )
+{
+	profRow_t* r = prof_rows[index];
+	row->name = prof_zoneNames[r->zone];
+	row->thread = r->thread == PROF_GPU_THREAD ? prof_gpu->name : prof_threads[r->thread]->name;
+	row->depth = r->depth;
+	row->gpu = r->thread == PROF_GPU_THREAD;
+	row->calls = r->calls;
+	row->lastMs = r->lastMs;
+	row->avgMs = r->avgMs;
+	row->maxMs = r->maxMs;
+}
+
+static int Prof_Append( char* buf, int size, int len, const char* fmt, ... )
+{
+	if (len >= size - 1)
+		return len;
+
+	va_list args;
+	va_start(args, fmt);
+	int n = vsnprintf(buf + len, size - len, fmt, args);
+	va_end(args);
+
+	// truncated, _vsnprintf returns -1 and leaves no terminator
+	if (n < 0 || n >= size - len)
+	{
+		buf[size - 1] = 0;
+		return size - 1;
+	}
+	return len + n;
+}
+
+int Prof_FormatTable( char* buf, int size )
+{
+	if (size <= 0)
+		return 0;
+
+	buf[0] = 0;
+	int len = Prof_Append(buf, size, 0, "%-28s %8s %8s %8s %6s\n", "zone", "last", "avg", "max", "calls");
+	const char* thread = NULL;
+	for (int i = 0; i < Prof_GetNumRows(); i++)
+	{
+		profileRow_t row;
+		Prof_GetRow(i, &row);
+		if (row.thread != thread)
+		{
+			thread = row.thread;
+			len = Prof_Append(buf, size, len, "[%s]\n", thread);
+		}
+
+		char name[80];
+		int indent = row.depth * 2 < 16 ? row.depth * 2 : 16;
+		sprintf(name, "%*s%s", indent, "", row.name);
+		len = Prof_Append(buf, size, len, "%-28s %8.3f %8.3f %8.3f %6d\n",
+			name, row.lastMs, row.avgMs, row.maxMs, row.calls);
+	}
+	return len;
+}
+
+void Prof_PrintTable()
+{
+	static char buf[16384];
+	Prof_FormatTable(buf, sizeof(buf));
+	Sys_Printf("%s", buf);
+}
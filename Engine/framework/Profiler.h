@@ -0,0 +1,99 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+/*
+===============================================================================
+
+	Scoped profiler
+
+	Cpu zones are timed with Sys_GetClockTicks and summed per thread and per
+	frame; every thread keeps its own zone stack, so zones nest naturally.
+	Gpu zones are only valid on the render thread and use GpuTimer, their
+	times trail the cpu ones by GPUTIMER_LATENCY frames. Prof_EndFrame folds
+	the frame into a rolling history of PROFILE_HISTORY frames.
+
+	PROFILE_SCOPE("name") times the rest of the enclosing block.
+
+===============================================================================
+*/
+
+#define PROFILE_HISTORY 64
+#define MAX_PROFILE_ZONES 256
+#define MAX_PROFILE_THREADS 16
+#define MAX_PROFILE_DEPTH 32
+
+typedef struct
+{
+	const char* name;
+	const char* thread;		// "gpu" for gpu zones
+	int depth;
+	bool gpu;
+	int calls;				// last frame
+	float lastMs;
+	float avgMs;
+	float maxMs;
+}profileRow_t;
+
+// returns the same id for the same name, thread safe
+int		Prof_RegisterZone(const char* name);
+
+void	Prof_BeginZone(int zone);
+void	Prof_EndZone();
+
+void	Prof_BeginGpuZone(const char* name);
+void	Prof_EndGpuZone();
+
+// once per frame, on the main thread
+void	Prof_EndFrame();
+
+void	Prof_SetEnable(bool enable);
+bool	Prof_IsEnabled();
+
+void	Prof_SetThreadName(const char* name);
+
+// name of the calling thread, the pointer stays valid
+const char* Prof_GetThreadName();
+
+const char* Prof_GetZoneName(int zone);
+
+// rows are grouped by thread, in the order their zones were first entered
+int		Prof_GetNumRows();
+void	Prof_GetRow(int index, profileRow_t* row);
+
+// writes the table as text, returns the length
+int		Prof_FormatTable(char* buf, int size);
+void	Prof_PrintTable();
+
+class ProfileScope
+{
+public:
+	ProfileScope(int zone) { Prof_BeginZone(zone); }
+	~ProfileScope() { Prof_EndZone(); }
+};
+
+class ProfileGpuScope
+{
+public:
+	ProfileGpuScope(const char* name) { Prof_BeginGpuZone(name); }
+	~ProfileGpuScope() { Prof_EndGpuZone(); }
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#ifndef FLIP_NO_PROFILE
+#define PROFILE_SCOPE(name) \
+	static int PROFILE_CONCAT(prof_zone_, __LINE__) = Prof_RegisterZone(name); \
+	ProfileScope PROFILE_CONCAT(prof_scope_, __LINE__)(PROFILE_CONCAT(prof_zone_, __LINE__))
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+// for names only known at run time, looks the zone up every time
+#define PROFILE_DYNAMIC(name) ProfileScope PROFILE_CONCAT(prof_scope_, __LINE__)(Prof_RegisterZone(name))
+#define PROFILE_GPU(name) ProfileGpuScope PROFILE_CONCAT(prof_gpu_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_DYNAMIC(name)
+#define PROFILE_GPU(name)
+#endif
+
+#endif
@@ -0,0 +1,260 @@
+#include "Trace.h"
+#include "Profiler.h"
+#include "CmdSystem.h"
+#include "../sys/sys_public.h"
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum
+{
+	eTrace_Zone,
+	eTrace_Frame,
+	eTrace_Counter,
+}traceEventType_t;
+
+typedef struct
+{
+	int type;
+	int name;
+	double ticks;
+	double value;		// end ticks for zones, frame number, counter value
+}traceEvent_t;
+
+typedef struct
+{
+	unsigned long tid;
+	const char* name;
+	traceEvent_t* events;
+	std::atomic<int> count;
+	std::atomic<int> generation;	// capture the events belong to
+	int dropped;
+}traceBuffer_t;
+
+static std::mutex trace_lock;		// buffer registration only
+static traceBuffer_t* trace_buffers[MAX_PROFILE_THREADS];
+static int trace_numBuffers = 0;
+static SYS_THREAD_LOCAL traceBuffer_t* trace_buffer = NULL;
+
+static std::atomic<bool> trace_capturing(false);
+static std::atomic<int> trace_generation(0);
+static char trace_filename[256];
+static int trace_framesLeft = 0;
+static double trace_startTicks = 0.0;
+static bool trace_profilerWasOff = false;
+
+static traceBuffer_t* Trace_GetBuffer()
+{
+	if (trace_buffer != NULL)
+		return trace_buffer;
+
+	std::lock_guard<std::mutex> guard(trace_lock);
+	if (trace_numBuffers >= MAX_PROFILE_THREADS)
+		return NULL;
+
+	traceBuffer_t* buf = new traceBuffer_t;
+	buf->tid = Sys_GetThreadId();
+	buf->name = Prof_GetThreadName();
+	buf->events = (traceEvent_t*)malloc(sizeof(traceEvent_t) * TRACE_BUFFER_EVENTS);
+	buf->count.store(0);
+	buf->generation.store(-1);
+	buf->dropped = 0;
+
+	trace_buffers[trace_numBuffers++] = buf;
+	trace_buffer = buf;
+	return buf;
+}
+
+static void Trace_Push( int type, int name, double ticks, double value )
+{
+	if (!trace_capturing.load(std::memory_order_acquire))
+		return;
+
+	traceBuffer_t* buf = Trace_GetBuffer();
+	if (buf == NULL)
+		return;
+
+	// first event of a new capture, only the owner resets its buffer
+	int gen = trace_generation.load(std::memory_order_relaxed);
+	if (buf->generation.load(std::memory_order_relaxed) != gen)
+	{
+		buf->count.store(0, std::memory_order_relaxed);
+		buf->dropped = 0;
+		buf->generation.store(gen, std::memory_order_release);
+	}
+
+	int n = buf->count.load(std::memory_order_relaxed);
+	if (n >= TRACE_BUFFER_EVENTS)
+	{
+		buf->dropped++;
+		return;
+	}
+
+	traceEvent_t& ev = buf->events[n];
+	ev.type = type;
+	ev.name = name;
+	ev.ticks = ticks;
+	ev.value = value;
+	buf->count.store(n + 1, std::memory_order_release);
+}
+
+bool Trace_IsCapturing()
+{
+	return trace_capturing.load(std::memory_order_relaxed);
+}
+
+void Trace_Zone( int name, double startTicks, double endTicks )
+{
+	Trace_Push(eTrace_Zone, name, startTicks, endTicks);
+}
+
+void Trace_FrameMark( int frame )
+{
+	if (!Trace_IsCapturing())
+		return;
+
+	Trace_Push(eTrace_Frame, -1, Sys_GetClockTicks(), frame);
+	if (trace_framesLeft > 0 && --trace_framesLeft == 0)
+		Trace_Stop();
+}
+
+void Trace_Counter( int name, double value )
+{
+	Trace_Push(eTrace_Counter, name, Sys_GetClockTicks(), value);
+}
+
+bool Trace_Start( const char* filename, int frames )
+{
+	if (Trace_IsCapturing())
+	{
+		Sys_Printf("trace: already capturing to %s\n", trace_filename);
+		return false;
+	}
+
+	strncpy(trace_filename, filename, sizeof(trace_filename) - 1);
+	trace_filename[sizeof(trace_filename) - 1] = 0;
+	trace_framesLeft = frames;
+	trace_startTicks = Sys_GetClockTicks();
+
+	// zones and frame marks come from the profiler, it runs for the capture
+	trace_profilerWasOff = !Prof_IsEnabled();
+	Prof_SetEnable(true);
+	trace_generation.fetch_add(1);
+	trace_capturing.store(true, std::memory_order_release);
+
+	if (frames > 0)
+		Sys_Printf("trace: capturing %d frames to %s\n", frames, trace_filename);
+	else
+		Sys_Printf("trace: capturing to %s\n", trace_filename);
+	return true;
+}
+
+static void Trace_WriteString( FILE* f, const char* s )
+{
+	fputc('"', f);
+	for (; *s; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			fprintf(f, "\\%c", *s);
+		else if ((unsigned char)*s < ' ')
+			fprintf(f, "\\u%04x", (unsigned char)*s);
+		else
+			fputc(*s, f);
+	}
+	fputc('"', f);
+}
+
+void Trace_Stop()
+{
+	if (!Trace_IsCapturing())
+		return;
+	trace_capturing.store(false, std::memory_order_release);
+	if (trace_profilerWasOff)
+		Prof_SetEnable(false);
+	trace_profilerWasOff = false;
+
+	FILE* f = fopen(trace_filename, "w");
+	if (f == NULL)
+	{
+		Sys_Printf("trace: couldn't open %s\n", trace_filename);
+		return;
+	}
+
+	double usPerTick = 1000000.0 / Sys_ClockTicksPerSecond();
+	int gen = trace_generation.load();
+	int numBuffers;
+	{
+		std::lock_guard<std::mutex> guard(trace_lock);
+		numBuffers = trace_numBuffers;
+	}
+
+	int numEvents = 0;
+	int dropped = 0;
+	fprintf(f, "{\"traceEvents\":[\n");
+	fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"FlipEngine\"}}");
+	for (int b = 0; b < numBuffers; b++)
+	{
+		traceBuffer_t* buf = trace_buffers[b];
+		if (buf->generation.load(std::memory_order_acquire) != gen)
+			continue;
+
+		fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":", buf->tid);
+		Trace_WriteString(f, buf->name);
+		fprintf(f, "}}");
+
+		int count = buf->count.load(std::memory_order_acquire);
+		for (int i = 0; i < count; i++)
+		{
+			const traceEvent_t& ev = buf->events[i];
+			double ts = (ev.ticks - trace_startTicks) * usPerTick;
+			switch (ev.type)
+			{
+			case eTrace_Zone:
+				fprintf(f, ",\n{\"name\":");
+				Trace_WriteString(f, Prof_GetZoneName(ev.name));
+				fprintf(f, ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+					buf->tid, ts, (ev.value - ev.ticks) * usPerTick);
+				break;
+			case eTrace_Frame:
+				fprintf(f, ",\n{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"args\":{\"frame\":%d}}",
+					buf->tid, ts, (int)ev.value);
+				break;
+			case eTrace_Counter:
+				fprintf(f, ",\n{\"name\":");
+				Trace_WriteString(f, Prof_GetZoneName(ev.name));
+				fprintf(f, ",\"ph\":\"C\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+					buf->tid, ts, ev.value);
+				break;
+			}
+		}
+		numEvents += count;
+		dropped += buf->dropped;
+	}
+	fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(f);
+
+	Sys_Printf("trace: wrote %d events to %s", numEvents, trace_filename);
+	if (dropped > 0)
+		Sys_Printf(", %d dropped", dropped);
+	Sys_Printf("\n");
+}
+
+static void Trace_Start_f( int argc, const char** argv )
+{
+	int frames = argc > 1 ? atoi(argv[1]) : 0;
+	const char* filename = argc > 2 ? argv[2] : "trace.json";
+	Trace_Start(filename, frames);
+}
+
+static void Trace_Stop_f( int argc, const char** argv )
+{
+	Trace_Stop();
+}
+
+void Trace_Init()
+{
+	Cmd_AddCommand("trace_start", Trace_Start_f, "trace_start [frames] [file], 0 frames runs until trace_stop");
+	Cmd_AddCommand("trace_stop", Trace_Stop_f, "stop the capture and write the trace");
+}
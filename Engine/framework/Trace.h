@@ -0,0 +1,36 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+/*
+===============================================================================
+
+	Timeline capture
+
+	While a capture runs, profiler zones, frame markers and counters are
+	appended to a buffer owned by the thread that produced them. Only the
+	owner writes to its buffer and publishes the event count with a release
+	store, so recording takes no lock. Trace_Stop writes everything as
+	chrome trace event json, which chrome://tracing and Perfetto can load.
+
+	Start and stop on the main thread only.
+
+===============================================================================
+*/
+
+#define TRACE_BUFFER_EVENTS (1 << 18)
+
+// frames = 0 records until Trace_Stop; a disabled profiler is turned on
+// for the capture
+bool	Trace_Start(const char* filename, int frames);
+void	Trace_Stop();
+bool	Trace_IsCapturing();
+
+// called by the profiler, name is a profiler zone id
+void	Trace_Zone(int name, double startTicks, double endTicks);
+void	Trace_FrameMark(int frame);
+void	Trace_Counter(int name, double value);
+
+// trace_start [frames] [file] and trace_stop
+void	Trace_Init();
+
+#endif
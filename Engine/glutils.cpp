@@ -1,17 +1,18 @@
 #include "glutils.h"
 #include "sys/sys_public.h"
+#include "renderer/ProgramCache.h"
+#include "renderer/GpuMemory.h"
 
 #include <stdio.h>
 #include <string.h>
 
-static GLuint GL_CompileShader(GLenum shaderType, const char* source)
-{
-	GLuint shader = glCreateShader(shaderType);
-	if (!shader)
-		return 0;
+// KHR_parallel_shader_compile, not in the bundled glew
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
-	glShaderSource(shader, 1, &source, NULL);
-	glCompileShader(shader);
+static bool GL_CheckShader(GLuint shader, GLenum shaderType)
+{
 	GLint compiled = 0;
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
 	if (!compiled) {
@@ -20,13 +21,36 @@ static GLuint GL_CompileShader(GLenum shaderType, const char* source)
 		glGetShaderInfoLog(shader, 1024, &len, buf);
 		Sys_Printf("Could not compile shader %d:\n%s\n",
 			shaderType, buf);
+		return false;
+	}
+	return true;
+}
+
+static GLuint GL_SubmitShader(GLenum shaderType, const char* source)
+{
+	GLuint shader = glCreateShader(shaderType);
+	if (!shader)
+		return 0;
+
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+static GLuint GL_CompileShader(GLenum shaderType, const char* source)
+{
+	GLuint shader = GL_SubmitShader(shaderType, source);
+	if (!shader)
+		return 0;
+
+	if (!GL_CheckShader(shader, shaderType)) {
 		glDeleteShader(shader);
 		return 0;
 	}
     return shader;
 }
 
-static GLuint GL_CompileShaderFromFile( GLenum target, const char* filename)
+static char* GL_ReadShaderFile(const char* filename)
 {
     FILE *shaderFile;
     char *text;
@@ -36,7 +60,7 @@ static GLuint GL_CompileShaderFromFile( GLenum target, const char* filename)
     shaderFile = fopen( filename, "rb");
 
     if ( shaderFile == NULL)
-        return 0;
+        return NULL;
 
     fseek( shaderFile, 0, SEEK_END);
     size = ftell(shaderFile);
@@ -46,34 +70,56 @@ static GLuint GL_CompileShaderFromFile( GLenum target, const char* filename)
     fclose( shaderFile);
 
     text[size] = '\0';
-    GLuint object = GL_CompileShader( target, text);
-    delete []text;
-    return object;
+    return text;
 }
 
-GLuint GL_LinkProgram(GLuint vert, GLuint pixel)
+glCounters_t glCounters;
+
+// vertex arrays are fed by fixed index (see attribType_t), so the
+// locations have to be bound before the link to take effect
+static GLuint GL_SubmitLink(GLuint vert, GLuint pixel)
 {
+	static const char* attribs[] = { "vPosition", "vTexCoord", "vNormal", "vTangent", "vBinormal" };
+
 	GLuint program = glCreateProgram();
 	if (program) {
 		glAttachShader(program, vert);
 		glAttachShader(program, pixel);
+		for (int i = 0; i < 5; i++)
+			glBindAttribLocation(program, i, attribs[i]);
+		if (GL_IsProgramCacheEnabled())
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(program);
-		GLint linkStatus = GL_FALSE;
-		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-		if (linkStatus != GL_TRUE) {
-			GLint bufLength = 0;
-			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &bufLength);
-			if (bufLength) {
-				char* buf = (char*)malloc(bufLength);
-				if (buf) {
-					glGetProgramInfoLog(program, bufLength, NULL, buf);
-					Sys_Printf("Could not link program:\n%s\n", buf);
-					free(buf);
-				}
+	}
+	return program;
+}
+
+static bool GL_CheckLink(GLuint program)
+{
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE) {
+		GLint bufLength = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &bufLength);
+		if (bufLength) {
+			char* buf = (char*)malloc(bufLength);
+			if (buf) {
+				glGetProgramInfoLog(program, bufLength, NULL, buf);
+				Sys_Printf("Could not link program:\n%s\n", buf);
+				free(buf);
 			}
-			glDeleteProgram(program);
-			program = 0;
 		}
+		return false;
+	}
+	return true;
+}
+
+GLuint GL_LinkProgram(GLuint vert, GLuint pixel)
+{
+	GLuint program = GL_SubmitLink(vert, pixel);
+	if (program && !GL_CheckLink(program)) {
+		glDeleteProgram(program);
+		program = 0;
 	}
 	return program;
 }
@@ -84,6 +130,8 @@ GLuint GL_GenTextureRGBA(int w, int h, void* data)
 	glGenTextures(1, &texId);
 	glBindTexture(GL_TEXTURE_2D, texId);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_BGRA, w, h, 0, GL_BGRA , GL_UNSIGNED_BYTE, data);
+	glCounters.uploadBytes += w * h * 4;
+	R_GpuMemAlloc(GL_TEXTURE, texId, GPUMEM_TEXTURE, w * h * 4);
 
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
@@ -99,6 +147,8 @@ GLuint GL_GenTextureRGB(int w, int h, void* data)
 	glGenTextures(1, &texId);
 	glBindTexture(GL_TEXTURE_2D, texId);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+	glCounters.uploadBytes += w * h * 3;
+	R_GpuMemAlloc(GL_TEXTURE, texId, GPUMEM_TEXTURE, w * h * 3);
 
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
@@ -109,6 +159,11 @@ GLuint GL_GenTextureRGB(int w, int h, void* data)
 }
 
 GLuint GL_CreateProgram(const char* pVertexSource, const char* pFragmentSource) {
+	GLuint program = GL_LoadCachedProgram(pVertexSource, pFragmentSource);
+	if (program) {
+		return program;
+	}
+
 	GLuint vertexShader = GL_CompileShader(GL_VERTEX_SHADER, pVertexSource);
 	if (!vertexShader) {
 		return 0;
@@ -116,23 +171,116 @@ GLuint GL_CreateProgram(const char* pVertexSource, const char* pFragmentSource)
 
 	GLuint pixelShader = GL_CompileShader(GL_FRAGMENT_SHADER, pFragmentSource);
 	if (!pixelShader) {
+		glDeleteShader(vertexShader);
 		return 0;
 	}
 
-	return GL_LinkProgram(vertexShader, pixelShader);
+	program = GL_LinkProgram(vertexShader, pixelShader);
+	// the program keeps its own copy once linked
+	glDeleteShader(vertexShader);
+	glDeleteShader(pixelShader);
+
+	GL_StoreCachedProgram(program, pVertexSource, pFragmentSource);
+	return program;
 }
 
 GLuint GL_CreateProgramFromFile(const char* vert, const char* frag)
 {
-	GLuint v, f;
+	char* v, *f;
+
+    if(! (v = GL_ReadShaderFile(vert)))
+        v = GL_ReadShaderFile(&vert[3]); //skip the first three chars to deal with path differences
 
-    if(! (v = GL_CompileShaderFromFile(GL_VERTEX_SHADER, vert)))
-        v = GL_CompileShaderFromFile(GL_VERTEX_SHADER, &vert[3]); //skip the first three chars to deal with path differences
+    if(! (f = GL_ReadShaderFile(frag)))
+        f = GL_ReadShaderFile(&frag[3]); //skip the first three chars to deal with path differences
 
-    if(! (f = GL_CompileShaderFromFile(GL_FRAGMENT_SHADER, frag)))
-        f = GL_CompileShaderFromFile(GL_FRAGMENT_SHADER, &frag[3]); //skip the first three chars to deal with path differences
+	GLuint program = 0;
+	if (v && f)
+		program = GL_CreateProgram(v, f);
+	delete []v;
+	delete []f;
+	return program;
+}
 
-	return GL_LinkProgram(v, f);
+static char* GL_CopySource(const char* source)
+{
+	size_t len = strlen(source);
+	char* copy = new char[len + 1];
+	memcpy(copy, source, len + 1);
+	return copy;
+}
+
+bool GL_SubmitProgram(pendingProgram_t& pending, const char* pVertexSource, const char* pFragmentSource)
+{
+	static int parallelCompile = -1;
+	if (parallelCompile < 0) {
+		const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+		parallelCompile = extensions != NULL && strstr(extensions, "GL_KHR_parallel_shader_compile") != NULL;
+		Sys_Printf("parallel shader compile: %s\n", parallelCompile ? "yes" : "no, deferring status queries");
+	}
+
+	memset(&pending, 0, sizeof(pending));
+	pending.submitTime = Sys_Milliseconds();
+	pending.parallel = parallelCompile != 0;
+
+	pending.program = GL_LoadCachedProgram(pVertexSource, pFragmentSource);
+	if (pending.program)
+		return true;
+
+	pending.vert = GL_SubmitShader(GL_VERTEX_SHADER, pVertexSource);
+	pending.frag = GL_SubmitShader(GL_FRAGMENT_SHADER, pFragmentSource);
+	if (!pending.vert || !pending.frag) {
+		GL_FinishProgram(pending);
+		return false;
+	}
+
+	pending.program = GL_SubmitLink(pending.vert, pending.frag);
+	pending.vertSource = GL_CopySource(pVertexSource);
+	pending.fragSource = GL_CopySource(pFragmentSource);
+	return pending.program != 0;
+}
+
+bool GL_IsProgramComplete(const pendingProgram_t& pending)
+{
+	// cache hits and failed submits have nothing to wait for
+	if (!pending.vert || !pending.frag || !pending.program)
+		return true;
+
+	if (pending.parallel) {
+		GLint complete = GL_FALSE;
+		glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete == GL_TRUE;
+	}
+
+	// without the extension any status query blocks, so give the driver
+	// a few frames before asking
+	return Sys_Milliseconds() - pending.submitTime >= GL_PROGRAM_DEFER_MSEC;
+}
+
+GLuint GL_FinishProgram(pendingProgram_t& pending)
+{
+	GLuint program = pending.program;
+	if (pending.vert && pending.frag && program) {
+		bool compiled = GL_CheckShader(pending.vert, GL_VERTEX_SHADER);
+		compiled = GL_CheckShader(pending.frag, GL_FRAGMENT_SHADER) && compiled;
+		if (!compiled || !GL_CheckLink(program)) {
+			glDeleteProgram(program);
+			program = 0;
+		}
+		else {
+			GL_StoreCachedProgram(program, pending.vertSource, pending.fragSource);
+		}
+	}
+
+	if (pending.vert)
+		glDeleteShader(pending.vert);
+	if (pending.frag)
+		glDeleteShader(pending.frag);
+	delete []pending.vertSource;
+	delete []pending.fragSource;
+
+	memset(&pending, 0, sizeof(pending));
+	return program;
 }
 
 void RB_SetGL2D( void ) 
@@ -180,7 +328,7 @@ void GL_CheckError(const char* op)
 				strcpy( s, "GL_OUT_OF_MEMORY" );
 				break;
 			default:
-				sprintf_s( s, sizeof(s), "%i", err);
+				sprintf( s, "%i", err);
 				break;
 		}
 
@@ -1,13 +1,20 @@
 #ifndef __GLUTILS_H__
 #define __GLUTILS_H__
 
-#ifdef _WIN32
+#if defined(FLIP_GL_RECORD)
+// only the declarations are used, calls go to the recorder
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#elif defined(_WIN32)
 //#  include <GL/glew.h>
-#include "gl/glew.h"
+#include "GL/glew.h"
 #elif __APPLE__
 #  include <openGLES/ES2/gl.h>
 #else
-#include <GLES2/gl2.h>
+// mesa exports every entry point, so no loader is needed
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
 #endif
 
 
@@ -17,6 +24,14 @@
 class Texture;
 typedef unsigned short glIndex_t;
 
+// per frame statistics, reset by the render system after every frame
+typedef struct {
+	int			drawCalls;
+	int			uploadBytes;		// buffer and texture data sent to the driver
+} glCounters_t;
+
+extern glCounters_t glCounters;
+
 typedef struct {
 	int			width;
 	int			height;
@@ -32,6 +47,26 @@ GLuint GL_GenTextureRGB(int w, int h, void* data);
 GLuint GL_CreateProgram(const char* pVertexSource, const char* pFragmentSource);
 GLuint GL_CreateProgramFromFile(const char* vert, const char* frag);
 
+// status queries wait this long without KHR_parallel_shader_compile
+#define GL_PROGRAM_DEFER_MSEC	32
+
+// a program whose compile and link were issued but not waited on
+typedef struct {
+	GLuint		program;
+	GLuint		vert;
+	GLuint		frag;
+	char*		vertSource;		// for the program cache once linked
+	char*		fragSource;
+	int			submitTime;
+	bool		parallel;		// completion can be polled
+} pendingProgram_t;
+
+bool GL_SubmitProgram(pendingProgram_t& pending, const char* pVertexSource, const char* pFragmentSource);
+// never blocks, true once GL_FinishProgram won't stall
+bool GL_IsProgramComplete(const pendingProgram_t& pending);
+// checks the compile and link, 0 when either failed
+GLuint GL_FinishProgram(pendingProgram_t& pending);
+
 void GL_CheckError(const char* op);
 
 void RB_SetGL2D( void );
@@ -42,4 +77,14 @@ void GL_SwapBuffers( void );
 
 void Test_2DDraw();
 
+// a recorded run reads and writes none of the disk caches (program
+// binaries, the variant list, cooked textures), so its command log only
+// depends on the code and the data
+#ifdef FLIP_GL_RECORD
+#define GL_DISK_CACHES		0
+#include "renderer/gl_record.h"
+#else
+#define GL_DISK_CACHES		1
+#endif
+
 #endif
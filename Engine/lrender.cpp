@@ -1,8 +1,9 @@
 #include "../luautils.h"
-#include "../renderer\RenderSystem.h"
+#include "../renderer/RenderSystem.h"
 #include "../Sprite.h"
 #include "../Model.h"
 #include "../Camera.h"
+#include "../renderer/GpuMemory.h"
 
 static RenderSystem* get_render(lua_State* L) {
 	lua_getglobal(L, "renderSys");
@@ -65,6 +66,55 @@ static int rendersystem_addanimodel(lua_State* L){
     return 0;
 }
 
+// render.gpumem() -> { total, peak, upload, peakupload, budget, evicted,
+//   categories = { { name, objects, bytes, peak }, ... } }
+static int render_gpumem(lua_State* L){
+	gpuMemStats_t stats;
+	R_GetGpuMemStats(&stats);
+
+	lua_createtable(L, 0, 7);
+	lua_pushnumber(L, (lua_Number)stats.totalBytes);
+	lua_setfield(L, -2, "total");
+	lua_pushnumber(L, (lua_Number)stats.peakTotalBytes);
+	lua_setfield(L, -2, "peak");
+	lua_pushinteger(L, stats.frameUploadBytes);
+	lua_setfield(L, -2, "upload");
+	lua_pushinteger(L, stats.peakFrameUploadBytes);
+	lua_setfield(L, -2, "peakupload");
+	lua_pushnumber(L, (lua_Number)stats.budget);
+	lua_setfield(L, -2, "budget");
+	lua_pushnumber(L, (lua_Number)stats.evictedBytes);
+	lua_setfield(L, -2, "evicted");
+
+	lua_createtable(L, GPUMEM_NUM_CATEGORIES, 0);
+	for (int i = 0; i < GPUMEM_NUM_CATEGORIES; i++) {
+		lua_createtable(L, 0, 4);
+		lua_pushstring(L, R_GpuMemCategoryName(i));
+		lua_setfield(L, -2, "name");
+		lua_pushinteger(L, stats.objects[i]);
+		lua_setfield(L, -2, "objects");
+		lua_pushnumber(L, (lua_Number)stats.bytes[i]);
+		lua_setfield(L, -2, "bytes");
+		lua_pushnumber(L, (lua_Number)stats.peakBytes[i]);
+		lua_setfield(L, -2, "peak");
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "categories");
+	return 1;
+}
+
+static int render_gpumemprint(lua_State* L){
+	R_PrintGpuMemory();
+	return 0;
+}
+
+// render.gpumembudget(MB, [evict])
+static int render_gpumembudget(lua_State* L){
+	int mb = luaL_checkint(L, 1);
+	R_SetGpuMemBudget((long long)mb * 1024 * 1024, lua_toboolean(L, 2) ? GPUMEM_BUDGET_EVICT : GPUMEM_BUDGET_WARN);
+	return 0;
+}
+
 static const luaL_Reg syslib[] = {
   {"newsprite", render_newSprite},
   {"newmodel", render_newModel},
@@ -73,6 +123,9 @@ static const luaL_Reg syslib[] = {
   {"addsprite", render_addsprite},
   {"addmodel", rendersystem_addmodel},
   {"addanimodel", rendersystem_addanimodel},
+  {"gpumem", render_gpumem},
+  {"gpumemprint", render_gpumemprint},
+  {"gpumembudget", render_gpumembudget},
   {NULL, NULL}
 };
 
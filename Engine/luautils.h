@@ -44,6 +44,8 @@ int luaopen_camera(lua_State* L);
 
 int luaopen_animodel(lua_State* L);
 
+int luaopen_profile(lua_State* L);
+
 #endif
 
 
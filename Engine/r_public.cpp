@@ -2,6 +2,8 @@
 #include "DrawVert.h"
 #include "sys/sys_public.h"
 #include "File.h"
+#include "renderer/GeometryArena.h"
+#include "renderer/GpuMemory.h"
 
 static const int SHADOWMAP_DEPTH_SIZE = 1024;
 
@@ -25,26 +27,8 @@ material_t* R_AllocMaterail()
 
 void R_GenerateGeometryVbo( srfTriangles_t *tri )
 {
-	if (tri->vbo[0] != 0)
-		glDeleteBuffers(1, &tri->vbo[0]);
-
-	if (tri->vbo[1] != 0)
-		glDeleteBuffers(1, &tri->vbo[0]);
-
-	glGenBuffers(1, &tri->vbo[0]);
-	glGenBuffers(1, &tri->vbo[1]);
-
-	// Stick the data for the vertices into its VBO
-	glBindBuffer(GL_ARRAY_BUFFER, tri->vbo[0]);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(DrawVert) * tri->numVerts, tri->verts, GL_STATIC_DRAW);
-
-	// Stick the data for the indices into its VBO
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(glIndex_t) * tri->numIndexes, tri->indexes, GL_STATIC_DRAW);
-
-	// Clear the VBO state
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	// ranges of the shared buffers, updated in place when the counts stay
+	R_AllocGeometry(tri);
 }
 
 drawSurf_t* R_AllocDrawSurf()
@@ -124,6 +108,7 @@ shadowMap_t* R_GenerateShadowMap()
 	glGenTextures(1, &shadowMap->texId);
 	glBindTexture(GL_TEXTURE_2D, shadowMap->texId);
 	glTexStorage2D( GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, SHADOWMAP_DEPTH_SIZE, SHADOWMAP_DEPTH_SIZE);
+	R_GpuMemAlloc(GL_TEXTURE, shadowMap->texId, GPUMEM_SHADOW_MAP, SHADOWMAP_DEPTH_SIZE * SHADOWMAP_DEPTH_SIZE * 4);
 
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
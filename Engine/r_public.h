@@ -11,6 +11,15 @@ class DrawVert;
 class Shader;
 class Material;
 
+// elements of a geometry arena block (see renderer/GeometryArena.h),
+// count 0 when nothing is allocated
+typedef struct
+{
+	int block;
+	int offset;
+	int count;
+}geoRange_t;
+
 // our only drawing geometry type
 typedef struct srfTriangles_s 
 {
@@ -22,7 +31,9 @@ typedef struct srfTriangles_s
 	int	numIndexes;			
 	glIndex_t* indexes;
 
-	GLuint vbo[2];
+	GLuint vbo[2];				// the arena blocks holding the ranges
+	geoRange_t vertexRange;		// offset is the base vertex
+	geoRange_t indexRange;
 
 	aabb3d aabb;
 
@@ -55,6 +66,8 @@ typedef struct{
 	bool bShaowmap;
 	bool bShowBound;
 	bool bHit;
+	bool bTranslucent;	// blended, skipped by the depth pre-pass
+	int variant;		// mtr->Variant(mask), 0 is the base program
 } drawSurf_t;
 
 typedef struct
@@ -76,6 +89,11 @@ void	R_AllocStaticTriSurfIndexes( srfTriangles_t *tri, int numIndexes );
 
 material_t* R_AllocMaterail();
 
+// resolves space separated keywords against the surface's material into
+// drawSurf_t::variant once (see Material.cpp); giving the surface another
+// material needs another call
+void R_SetSurfaceKeywords(drawSurf_t* surf, const char* keywords);
+
 
 /**
  * fast methods
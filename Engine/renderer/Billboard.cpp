@@ -0,0 +1,232 @@
+#include "Billboard.h"
+#include "GpuMemory.h"
+#include "../Sprite.h"
+#include "../Texture.h"
+#include "../Shader.h"
+#include "../ShaderSource.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include "../common/array.h"
+#include "../common/RadixSort.h"
+#include <string.h>
+
+typedef struct
+{
+	Texture* tex;
+	mat4* view;
+	mat4* viewProj;
+	int first;				// into bb_order and the instances
+	int count;
+}billboardGroup_t;
+
+typedef struct
+{
+	int sprites;
+	int draws;
+}billboardStats_t;
+
+static bool bb_initialized = false;
+static Shader* bb_shader = NULL;
+static GLuint bb_cornerVbo = 0;
+static GLuint bb_instanceVbo = 0;
+static billboardStats_t bb_stats;
+
+static array<billboardGroup_t> bb_groups;
+static array<int> bb_groupOf;			// group of each sprite, -1 when not drawn
+static array<Sprite*> bb_order;			// sprites by group, back to front
+static array<float> bb_keys;
+static array<float> bb_instances;
+static RadixSort bb_sort;
+
+static void R_Billboards_f(int argc, const char** argv)
+{
+	Sys_Printf("billboards: %d sprites in %d draws\n", bb_stats.sprites, bb_stats.draws);
+}
+
+static bool R_InitBillboards()
+{
+	bb_initialized = true;
+	Cmd_AddCommand("billboards", R_Billboards_f, "billboard sprites and instanced draws of the last frame");
+
+	bb_shader = new Shader;
+	bb_shader->LoadFromBuffer(billboard_vert, billboard_frag);
+	bb_shader->SetName("billboard");
+	bb_shader->GetUniformLocation(eUniform_MVP);
+	bb_shader->GetUniformLocation(eUniform_Samper0);
+	bb_shader->GetUniformLocation(eUniform_CameraRight);
+	bb_shader->GetUniformLocation(eUniform_CameraUp);
+
+	// corners of the quad as a triangle strip, they are also the uvs
+	static const float corners[] = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+	glGenBuffers(1, &bb_cornerVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, bb_cornerVbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	R_GpuMemAlloc(GL_BUFFER, bb_cornerVbo, GPUMEM_VERTEX_BUFFER, sizeof(corners));
+	glGenBuffers(1, &bb_instanceVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GL_CheckError("billboard:init");
+	return bb_shader->GetProgarm() != 0;
+}
+
+static int R_FindGroup(Sprite* sprite)
+{
+	Texture* tex = sprite->_drawSurf->shaderParms->tex;
+	for (unsigned int i = 0; i < bb_groups.size(); i++)
+	{
+		const billboardGroup_t& group = bb_groups[i];
+		if (group.tex == tex && group.view == sprite->_view && group.viewProj == sprite->_drawSurf->viewProj)
+			return i;
+	}
+
+	billboardGroup_t group;
+	group.tex = tex;
+	group.view = sprite->_view;
+	group.viewProj = sprite->_drawSurf->viewProj;
+	group.first = 0;
+	group.count = 0;
+	bb_groups.push_back(group);
+	return bb_groups.size() - 1;
+}
+
+// buckets the sprites by group, then sorts every group back to front and
+// writes its instances
+static int R_BuildInstances(Sprite* const* sprites, int count)
+{
+	bb_groups.set_used(0);
+	bb_groupOf.set_used(count);
+	int total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		drawSurf_t* surf = sprites[i]->_drawSurf;
+		if (surf->shaderParms->tex == NULL || surf->viewProj == NULL || sprites[i]->_view == NULL)
+		{
+			bb_groupOf[i] = -1;
+			continue;
+		}
+		int g = R_FindGroup(sprites[i]);
+		bb_groupOf[i] = g;
+		bb_groups[g].count++;
+		total++;
+	}
+
+	int first = 0;
+	for (unsigned int g = 0; g < bb_groups.size(); g++)
+	{
+		bb_groups[g].first = first;
+		first += bb_groups[g].count;
+		bb_groups[g].count = 0;
+	}
+	bb_order.set_used(total);
+	for (int i = 0; i < count; i++)
+	{
+		int g = bb_groupOf[i];
+		if (g >= 0)
+			bb_order[bb_groups[g].first + bb_groups[g].count++] = sprites[i];
+	}
+
+	bb_instances.set_used(total * BILLBOARD_INSTANCE_FLOATS);
+	for (unsigned int g = 0; g < bb_groups.size(); g++)
+	{
+		const billboardGroup_t& group = bb_groups[g];
+		Sprite* const* groupSprites = bb_order.const_pointer() + group.first;
+
+		// the view looks down -z, the most negative depth is the farthest
+		const float* m = group.view->m;
+		bb_keys.set_used(group.count);
+		for (int i = 0; i < group.count; i++)
+		{
+			const vec3& p = groupSprites[i]->_position;
+			bb_keys[i] = m[2] * p.x + m[6] * p.y + m[10] * p.z;
+		}
+		const unsigned int* order = bb_sort.Sort(bb_keys.const_pointer(), group.count);
+
+		float* instance = bb_instances.pointer() + group.first * BILLBOARD_INSTANCE_FLOATS;
+		for (int i = 0; i < group.count; i++, instance += BILLBOARD_INSTANCE_FLOATS)
+		{
+			const Sprite* sprite = groupSprites[order[i]];
+			instance[0] = sprite->_position.x;
+			instance[1] = sprite->_position.y;
+			instance[2] = sprite->_position.z;
+			instance[3] = sprite->_size.x;
+			instance[4] = sprite->_size.y;
+			memcpy(instance + 5, sprite->_uvRect, 4 * sizeof(float));
+		}
+	}
+	return total;
+}
+
+void RB_DrawBillboards(Sprite* const* sprites, int count)
+{
+	bb_stats.sprites = 0;
+	bb_stats.draws = 0;
+	if (count == 0)
+		return;
+	if (!bb_initialized && !R_InitBillboards())
+		return;
+	if (bb_shader->GetProgarm() == 0)
+		return;
+
+	int total = R_BuildInstances(sprites, count);
+	if (total == 0)
+		return;
+
+	int bytes = total * BILLBOARD_INSTANCE_FLOATS * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, bb_instanceVbo);
+	glBufferData(GL_ARRAY_BUFFER, bytes, bb_instances.const_pointer(), GL_STREAM_DRAW);
+	R_GpuMemDelete(GL_BUFFER, bb_instanceVbo);
+	R_GpuMemAlloc(GL_BUFFER, bb_instanceVbo, GPUMEM_STAGING, bytes);
+	glCounters.uploadBytes += bytes;
+
+	glUseProgram(bb_shader->GetProgarm());
+	glUniform1i(bb_shader->GetUniform(eUniform_Samper0), 0);
+	glEnable(GL_BLEND);
+	glDepthMask(GL_FALSE);
+
+	glBindBuffer(GL_ARRAY_BUFFER, bb_cornerVbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, bb_instanceVbo);
+	for (int i = 1; i <= 3; i++)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+
+	const int stride = BILLBOARD_INSTANCE_FLOATS * sizeof(float);
+	for (unsigned int g = 0; g < bb_groups.size(); g++)
+	{
+		const billboardGroup_t& group = bb_groups[g];
+		const float* view = group.view->m;
+		glUniformMatrix4fv(bb_shader->GetUniform(eUniform_MVP), 1, GL_FALSE, group.viewProj->m);
+		glUniform3f(bb_shader->GetUniform(eUniform_CameraRight), view[0], view[4], view[8]);
+		glUniform3f(bb_shader->GetUniform(eUniform_CameraUp), view[1], view[5], view[9]);
+		glBindTexture(GL_TEXTURE_2D, group.tex->GetName());
+
+		size_t offset = group.first * stride;
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offset);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 12));
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 20));
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, group.count);
+		glCounters.drawCalls++;
+	}
+	bb_stats.sprites = total;
+	bb_stats.draws = bb_groups.size();
+
+	for (int i = 0; i <= 3; i++)
+	{
+		glVertexAttribDivisor(i, 0);
+		glDisableVertexAttribArray(i);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	GL_CheckError("billboard:draw");
+}
+
+void R_ShutdownBillboards()
+{
+	delete bb_shader;
+	bb_shader = NULL;
+	R_DeleteBuffer(bb_cornerVbo);
+	R_DeleteBuffer(bb_instanceVbo);
+}
@@ -0,0 +1,37 @@
+#ifndef __BILLBOARD_H__
+#define __BILLBOARD_H__
+
+#include "../glutils.h"
+
+class Sprite;
+
+#define BILLBOARD_INSTANCE_FLOATS	9		// position, size, uv rect
+
+/*
+===============================================================================
+
+	Billboards
+
+	A sprite switched to billboard mode with Sprite::LookAtView isn't a
+	draw surface: every frame it only hands over its world position,
+	size and uv rect. The sprites are grouped by texture and camera, each
+	group sorted back to front in view space with a RadixSort, and the
+	instances of all groups are written to one stream buffer. Every group
+	is a single glDrawArraysInstanced of a four vertex strip; the vertex
+	shader spans the quad along the camera's right and up axes, taken
+	from the rows of the view matrix, so there is no matrix per sprite.
+
+	The position is the quad's lower left corner like the regular sprite
+	quad. Billboards are blended like the other sprites, after the
+	translucent queue and without depth writes; groups are not sorted
+	against each other.
+
+===============================================================================
+*/
+
+// draws the billboard sprites, one instanced draw per texture and camera
+void	RB_DrawBillboards(Sprite* const* sprites, int count);
+
+void	R_ShutdownBillboards();
+
+#endif
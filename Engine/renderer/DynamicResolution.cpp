@@ -0,0 +1,92 @@
+#include "DynamicResolution.h"
+#include "GpuTimer.h"
+#include <math.h>
+
+// frames to wait after a change, gpu times arrive GPUTIMER_LATENCY late
+static const int dynres_cooldown = GPUTIMER_LATENCY + 1;
+
+// leave some room so the controller does not sit right at the budget
+static const float dynres_headroom = 0.9f;
+
+DynamicResolution::DynamicResolution():_enabled(false),
+	_useGpuTime(true),
+	_targetMs(16.6f),
+	_minScale(0.5f),
+	_maxScale(1.f),
+	_scale(1.f),
+	_cooldown(0),
+	_numSamples(0),
+	_head(0)
+{
+}
+
+void DynamicResolution::SetEnable( bool enable )
+{
+	_enabled = enable;
+	_scale = _maxScale;
+	_cooldown = 0;
+}
+
+void DynamicResolution::SetScaleRange( float minScale, float maxScale )
+{
+	_minScale = minScale < DYNRES_STEP ? DYNRES_STEP : minScale;
+	_maxScale = maxScale > 1.f ? 1.f : maxScale;
+	if (_maxScale < _minScale)
+		_maxScale = _minScale;
+
+	if (_scale < _minScale) _scale = _minScale;
+	if (_scale > _maxScale) _scale = _maxScale;
+}
+
+float DynamicResolution::Update( float frameMs, float gpuMs )
+{
+	dynResSample_t& sample = _history[_head];
+	sample.frameMs = frameMs;
+	sample.gpuMs = gpuMs;
+	sample.scale = GetScale();
+	_head = (_head + 1) % DYNRES_HISTORY;
+	if (_numSamples < DYNRES_HISTORY)
+		_numSamples++;
+
+	if (!_enabled)
+		return 1.f;
+
+	if (_cooldown > 0)
+	{
+		_cooldown--;
+		return _scale;
+	}
+
+	float ms = _useGpuTime ? gpuMs : frameMs;
+	if (ms <= 0.f)
+		return _scale;
+
+	float ideal = _scale * sqrtf(_targetMs * dynres_headroom / ms);
+	float scale = _scale + (ideal - _scale) * 0.5f;
+	scale = floorf(scale / DYNRES_STEP + 0.5f) * DYNRES_STEP;
+
+	if (scale < _minScale) scale = _minScale;
+	if (scale > _maxScale) scale = _maxScale;
+
+	if (fabsf(scale - _scale) > DYNRES_STEP * 0.5f)
+	{
+		_scale = scale;
+		_cooldown = dynres_cooldown;
+	}
+	return _scale;
+}
+
+void DynamicResolution::GetScaledSize( int w, int h, int* scaledW, int* scaledH )
+{
+	float scale = GetScale();
+	*scaledW = (int)(w * scale);
+	*scaledH = (int)(h * scale);
+	if (*scaledW < 1) *scaledW = 1;
+	if (*scaledH < 1) *scaledH = 1;
+}
+
+const dynResSample_t& DynamicResolution::GetHistory( int index )
+{
+	int first = (_head - _numSamples + DYNRES_HISTORY) % DYNRES_HISTORY;
+	return _history[(first + index) % DYNRES_HISTORY];
+}
@@ -0,0 +1,72 @@
+#ifndef __DYNAMICRESOLUTION_H__
+#define __DYNAMICRESOLUTION_H__
+
+#define DYNRES_HISTORY 128
+#define DYNRES_STEP 0.05f
+
+typedef struct
+{
+	float frameMs;
+	float gpuMs;
+	float scale;		// scale the frame was rendered at
+}dynResSample_t;
+
+/*
+===============================================================================
+
+	Dynamic resolution controller
+
+	Fed once per frame with the measured frame and scene gpu time. Pixel
+	cost grows with the square of the scale, so the scale is moved towards
+	sqrt(budget / time), damped, and snapped to DYNRES_STEP so the render
+	target pool only ever sees a handful of sizes. After a change it waits
+	for the gpu timers to catch up before looking at the timings again.
+
+===============================================================================
+*/
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+
+	void SetEnable(bool enable);
+
+	bool IsEnabled() { return _enabled; }
+
+	// frame budget in milliseconds
+	void SetTargetMs(float ms) { _targetMs = ms; }
+
+	float GetTargetMs() { return _targetMs; }
+
+	void SetScaleRange(float minScale, float maxScale);
+
+	// drive the controller with the scene gpu time instead of the frame time
+	void SetUseGpuTime(bool use) { _useGpuTime = use; }
+
+	// record the last frame, returns the scale for the next one
+	float Update(float frameMs, float gpuMs);
+
+	float GetScale() { return _enabled ? _scale : 1.f; }
+
+	void GetScaledSize(int w, int h, int* scaledW, int* scaledH);
+
+	// oldest first
+	int GetHistorySize() { return _numSamples; }
+
+	const dynResSample_t& GetHistory(int index);
+
+private:
+	bool _enabled;
+	bool _useGpuTime;
+	float _targetMs;
+	float _minScale;
+	float _maxScale;
+	float _scale;
+	int _cooldown;
+
+	dynResSample_t _history[DYNRES_HISTORY];
+	int _numSamples;
+	int _head;
+};
+
+#endif
@@ -0,0 +1,404 @@
+#include "GeometryArena.h"
+#include "GpuMemory.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include "../common/array.h"
+#include <string.h>
+
+typedef struct
+{
+	int offset;
+	int count;
+}geoFreeRange_t;
+
+typedef struct
+{
+	GLuint buffer;			// 0 for a released slot
+	int capacity;			// in elements
+	int used;
+	array<geoFreeRange_t> freeRanges;	// sorted by offset, never adjacent
+	array<srfTriangles_t*> owners;
+}geoBlock_t;
+
+typedef struct
+{
+	GLenum target;
+	int stride;
+	int blockSize;			// bytes
+	gpuMemCategory_t category;
+	array<geoBlock_t*> blocks;
+}geoPool_t;
+
+static array<geoPool_t*> ga_vertexPools;
+static geoPool_t* ga_indexPool = NULL;
+static bool ga_initialized = false;
+
+static void R_GeoArena_f(int argc, const char** argv)
+{
+	if (argc > 1 && !strcmp(argv[1], "defrag"))
+		R_DefragGeometry();
+	R_PrintGeometryArena();
+}
+
+static geoPool_t* R_NewPool(GLenum target, int stride, int blockSize, gpuMemCategory_t category)
+{
+	if (!ga_initialized)
+	{
+		ga_initialized = true;
+		Cmd_AddCommand("geoarena", R_GeoArena_f, "geometry arena stats, geoarena defrag packs the blocks");
+	}
+
+	geoPool_t* pool = new geoPool_t;
+	pool->target = target;
+	pool->stride = stride;
+	pool->blockSize = blockSize;
+	pool->category = category;
+	return pool;
+}
+
+static geoPool_t* R_VertexPool(int stride)
+{
+	for (unsigned int i = 0; i < ga_vertexPools.size(); i++)
+	{
+		if (ga_vertexPools[i]->stride == stride)
+			return ga_vertexPools[i];
+	}
+	geoPool_t* pool = R_NewPool(GL_ARRAY_BUFFER, stride, GEOARENA_VERTEX_BLOCK, GPUMEM_VERTEX_BUFFER);
+	ga_vertexPools.push_back(pool);
+	return pool;
+}
+
+static geoPool_t* R_IndexPool()
+{
+	if (ga_indexPool == NULL)
+		ga_indexPool = R_NewPool(GL_ELEMENT_ARRAY_BUFFER, sizeof(glIndex_t), GEOARENA_INDEX_BLOCK, GPUMEM_INDEX_BUFFER);
+	return ga_indexPool;
+}
+
+static geoRange_t& R_OwnerRange(const geoPool_t* pool, srfTriangles_t* tri)
+{
+	return pool->target == GL_ELEMENT_ARRAY_BUFFER ? tri->indexRange : tri->vertexRange;
+}
+
+static GLuint& R_OwnerBuffer(const geoPool_t* pool, srfTriangles_t* tri)
+{
+	return pool->target == GL_ELEMENT_ARRAY_BUFFER ? tri->vbo[1] : tri->vbo[0];
+}
+
+static GLuint R_NewBlockBuffer(geoPool_t* pool, int capacity)
+{
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(pool->target, buffer);
+	glBufferData(pool->target, capacity * pool->stride, NULL, GL_STATIC_DRAW);
+	glBindBuffer(pool->target, 0);
+	R_GpuMemAlloc(GL_BUFFER, buffer, pool->category, capacity * pool->stride);
+	return buffer;
+}
+
+static int R_NewBlock(geoPool_t* pool, int count)
+{
+	int capacity = pool->blockSize / pool->stride;
+	if (count > capacity)
+		capacity = count;
+
+	// released slots are reused, ranges keep their block index
+	int index = -1;
+	for (unsigned int i = 0; i < pool->blocks.size(); i++)
+	{
+		if (pool->blocks[i]->buffer == 0)
+		{
+			index = i;
+			break;
+		}
+	}
+	if (index < 0)
+	{
+		index = pool->blocks.size();
+		pool->blocks.push_back(new geoBlock_t);
+	}
+
+	geoBlock_t* block = pool->blocks[index];
+	block->buffer = R_NewBlockBuffer(pool, capacity);
+	block->capacity = capacity;
+	block->used = 0;
+	block->freeRanges.clear();
+	block->owners.clear();
+	geoFreeRange_t all = { 0, capacity };
+	block->freeRanges.push_back(all);
+	return index;
+}
+
+static bool R_BlockAlloc(geoBlock_t* block, int count, int* offset)
+{
+	for (unsigned int i = 0; i < block->freeRanges.size(); i++)
+	{
+		geoFreeRange_t& r = block->freeRanges[i];
+		if (r.count < count)
+			continue;
+
+		*offset = r.offset;
+		r.offset += count;
+		r.count -= count;
+		if (r.count == 0)
+			block->freeRanges.erase(i);
+		block->used += count;
+		return true;
+	}
+	return false;
+}
+
+static void R_PoolAlloc(geoPool_t* pool, srfTriangles_t* tri, int count)
+{
+	geoRange_t& range = R_OwnerRange(pool, tri);
+	int offset = 0;
+	int index = -1;
+	for (unsigned int i = 0; i < pool->blocks.size(); i++)
+	{
+		if (pool->blocks[i]->buffer != 0 && R_BlockAlloc(pool->blocks[i], count, &offset))
+		{
+			index = i;
+			break;
+		}
+	}
+	if (index < 0)
+	{
+		index = R_NewBlock(pool, count);
+		R_BlockAlloc(pool->blocks[index], count, &offset);
+	}
+
+	geoBlock_t* block = pool->blocks[index];
+	block->owners.push_back(tri);
+	range.block = index;
+	range.offset = offset;
+	range.count = count;
+	R_OwnerBuffer(pool, tri) = block->buffer;
+}
+
+static void R_PoolFree(geoPool_t* pool, srfTriangles_t* tri)
+{
+	geoRange_t& range = R_OwnerRange(pool, tri);
+	if (range.count == 0)
+		return;
+
+	geoBlock_t* block = pool->blocks[range.block];
+	for (unsigned int i = 0; i < block->owners.size(); i++)
+	{
+		if (block->owners[i] == tri)
+		{
+			block->owners.erase(i);
+			break;
+		}
+	}
+
+	// insert sorted, then merge with the neighbours
+	unsigned int pos = 0;
+	while (pos < block->freeRanges.size() && block->freeRanges[pos].offset < range.offset)
+		pos++;
+	geoFreeRange_t r = { range.offset, range.count };
+	block->freeRanges.push_back(r);
+	for (unsigned int i = block->freeRanges.size() - 1; i > pos; i--)
+		block->freeRanges[i] = block->freeRanges[i - 1];
+	block->freeRanges[pos] = r;
+	if (pos + 1 < block->freeRanges.size()
+		&& block->freeRanges[pos].offset + block->freeRanges[pos].count == block->freeRanges[pos + 1].offset)
+	{
+		block->freeRanges[pos].count += block->freeRanges[pos + 1].count;
+		block->freeRanges.erase(pos + 1);
+	}
+	if (pos > 0
+		&& block->freeRanges[pos - 1].offset + block->freeRanges[pos - 1].count == block->freeRanges[pos].offset)
+	{
+		block->freeRanges[pos - 1].count += block->freeRanges[pos].count;
+		block->freeRanges.erase(pos);
+	}
+	block->used -= range.count;
+
+	range.block = 0;
+	range.offset = 0;
+	range.count = 0;
+	R_OwnerBuffer(pool, tri) = 0;
+}
+
+static void R_PoolUpload(geoPool_t* pool, srfTriangles_t* tri, const void* data)
+{
+	const geoRange_t& range = R_OwnerRange(pool, tri);
+	GLuint buffer = pool->blocks[range.block]->buffer;
+	R_OwnerBuffer(pool, tri) = buffer;
+	glBindBuffer(pool->target, buffer);
+	glBufferSubData(pool->target, range.offset * pool->stride, range.count * pool->stride, data);
+	glBindBuffer(pool->target, 0);
+	glCounters.uploadBytes += range.count * pool->stride;
+}
+
+bool R_AllocGeometry(srfTriangles_t* tri)
+{
+	if (tri->numVerts <= 0 || tri->numIndexes <= 0 || tri->verts == NULL || tri->indexes == NULL)
+		return false;
+
+	geoPool_t* vertexPool = R_VertexPool(sizeof(DrawVert));
+	if (tri->vertexRange.count != tri->numVerts)
+	{
+		R_PoolFree(vertexPool, tri);
+		R_PoolAlloc(vertexPool, tri, tri->numVerts);
+	}
+	R_PoolUpload(vertexPool, tri, tri->verts);
+
+	geoPool_t* indexPool = R_IndexPool();
+	if (tri->indexRange.count != tri->numIndexes)
+	{
+		R_PoolFree(indexPool, tri);
+		R_PoolAlloc(indexPool, tri, tri->numIndexes);
+	}
+	R_PoolUpload(indexPool, tri, tri->indexes);
+	return true;
+}
+
+void R_FreeGeometry(srfTriangles_t* tri)
+{
+	if (tri->vertexRange.count != 0)
+		R_PoolFree(R_VertexPool(sizeof(DrawVert)), tri);
+	if (tri->indexRange.count != 0)
+		R_PoolFree(R_IndexPool(), tri);
+}
+
+static void R_ReleaseBlock(geoBlock_t* block)
+{
+	R_DeleteBuffer(block->buffer);
+	block->capacity = 0;
+	block->used = 0;
+	block->freeRanges.clear();
+	block->owners.clear();
+}
+
+static void R_SortOwners(const geoPool_t* pool, geoBlock_t* block)
+{
+	// insertion sort by offset, a block has few owners
+	for (unsigned int i = 1; i < block->owners.size(); i++)
+	{
+		srfTriangles_t* tri = block->owners[i];
+		int offset = R_OwnerRange(pool, tri).offset;
+		int j = i - 1;
+		while (j >= 0 && R_OwnerRange(pool, block->owners[j]).offset > offset)
+		{
+			block->owners[j + 1] = block->owners[j];
+			j--;
+		}
+		block->owners[j + 1] = tri;
+	}
+}
+
+static void R_DefragBlock(geoPool_t* pool, geoBlock_t* block)
+{
+	// already packed: one hole at the end, or none
+	if (block->freeRanges.size() == 0
+		|| (block->freeRanges.size() == 1 && block->freeRanges[0].offset == block->used))
+		return;
+
+	GLuint buffer = R_NewBlockBuffer(pool, block->capacity);
+	glBindBuffer(GL_COPY_READ_BUFFER, block->buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+	R_SortOwners(pool, block);
+	int offset = 0;
+	for (unsigned int i = 0; i < block->owners.size(); i++)
+	{
+		srfTriangles_t* tri = block->owners[i];
+		geoRange_t& range = R_OwnerRange(pool, tri);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			range.offset * pool->stride, offset * pool->stride, range.count * pool->stride);
+		range.offset = offset;
+		R_OwnerBuffer(pool, tri) = buffer;
+		offset += range.count;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	R_DeleteBuffer(block->buffer);
+	block->buffer = buffer;
+
+	block->freeRanges.clear();
+	geoFreeRange_t rest = { offset, block->capacity - offset };
+	if (rest.count > 0)
+		block->freeRanges.push_back(rest);
+}
+
+static void R_DefragPool(geoPool_t* pool)
+{
+	for (unsigned int i = 0; i < pool->blocks.size(); i++)
+	{
+		geoBlock_t* block = pool->blocks[i];
+		if (block->buffer == 0)
+			continue;
+		if (block->used == 0)
+			R_ReleaseBlock(block);
+		else
+			R_DefragBlock(pool, block);
+	}
+}
+
+void R_DefragGeometry()
+{
+	for (unsigned int i = 0; i < ga_vertexPools.size(); i++)
+		R_DefragPool(ga_vertexPools[i]);
+	if (ga_indexPool != NULL)
+		R_DefragPool(ga_indexPool);
+}
+
+static void R_PrintPool(const char* name, const geoPool_t* pool)
+{
+	int blocks = 0, capacity = 0, used = 0, holes = 0, largest = 0, surfaces = 0;
+	for (unsigned int i = 0; i < pool->blocks.size(); i++)
+	{
+		const geoBlock_t* block = pool->blocks[i];
+		if (block->buffer == 0)
+			continue;
+		blocks++;
+		capacity += block->capacity;
+		used += block->used;
+		surfaces += block->owners.size();
+		holes += block->freeRanges.size();
+		for (unsigned int j = 0; j < block->freeRanges.size(); j++)
+		{
+			if (block->freeRanges[j].count > largest)
+				largest = block->freeRanges[j].count;
+		}
+	}
+	Sys_Printf("%-10s stride %2d: %d blocks, %d surfaces, %d of %d bytes used, %d free ranges, largest %d bytes\n",
+		name, pool->stride, blocks, surfaces, used * pool->stride, capacity * pool->stride, holes, largest * pool->stride);
+}
+
+void R_PrintGeometryArena()
+{
+	for (unsigned int i = 0; i < ga_vertexPools.size(); i++)
+		R_PrintPool("vertexes", ga_vertexPools[i]);
+	if (ga_indexPool != NULL)
+		R_PrintPool("indexes", ga_indexPool);
+}
+
+static void R_FreePool(geoPool_t* pool)
+{
+	for (unsigned int i = 0; i < pool->blocks.size(); i++)
+	{
+		geoBlock_t* block = pool->blocks[i];
+		for (unsigned int j = 0; j < block->owners.size(); j++)
+		{
+			srfTriangles_t* tri = block->owners[j];
+			memset(&R_OwnerRange(pool, tri), 0, sizeof(geoRange_t));
+			R_OwnerBuffer(pool, tri) = 0;
+		}
+		R_ReleaseBlock(block);
+		delete block;
+	}
+	delete pool;
+}
+
+void R_ShutdownGeometryArena()
+{
+	for (unsigned int i = 0; i < ga_vertexPools.size(); i++)
+		R_FreePool(ga_vertexPools[i]);
+	ga_vertexPools.clear();
+	if (ga_indexPool != NULL)
+		R_FreePool(ga_indexPool);
+	ga_indexPool = NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef __GEOMETRYARENA_H__
+#define __GEOMETRYARENA_H__
+
+#include "../r_public.h"
+
+#define GEOARENA_VERTEX_BLOCK		(4 * 1024 * 1024)	// bytes of a vertex buffer
+#define GEOARENA_INDEX_BLOCK		(1 * 1024 * 1024)	// bytes of an index buffer
+
+/*
+===============================================================================
+
+	Geometry arena
+
+	Static surfaces don't get buffers of their own. Vertices go into a few
+	large vertex buffers, one pool per vertex size, indexes into a shared
+	index pool, and each srfTriangles_t keeps the ranges it was given; the
+	draws bind the block's buffers and use the range starts as base vertex
+	and first index, so the indexes stay relative to the surface.
+
+	Each block hands out ranges first fit from a free list kept sorted and
+	coalesced. A surface regenerated with the same counts is updated in
+	place; a mesh larger than a block gets a block of its own. Freeing
+	leaves holes, R_DefragGeometry (or "geoarena defrag") packs the live
+	ranges of every fragmented block into a new buffer with
+	glCopyBufferSubData and releases the empty blocks.
+
+===============================================================================
+*/
+
+// uploads the surface's vertices and indexes, reusing its ranges when the
+// counts didn't change; sets tri->vbo to the blocks' buffers
+bool	R_AllocGeometry(srfTriangles_t* tri);
+void	R_FreeGeometry(srfTriangles_t* tri);
+
+void	R_DefragGeometry();
+void	R_PrintGeometryArena();
+void	R_ShutdownGeometryArena();
+
+#endif
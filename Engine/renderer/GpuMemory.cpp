@@ -0,0 +1,257 @@
+#include "GpuMemory.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include "../common/array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define GPUMEM_MAX_EVICTORS		8
+
+enum
+{
+	GPUMEM_KIND_TEXTURE,
+	GPUMEM_KIND_BUFFER,
+	GPUMEM_KIND_RENDERBUFFER,
+	GPUMEM_NUM_KINDS
+};
+
+typedef struct
+{
+	int bytes;
+	int category;		// -1 when the name isn't registered
+}gpuAllocation_t;
+
+static const char* gm_categoryNames[GPUMEM_NUM_CATEGORIES] = {
+	"textures", "render targets", "shadow maps", "vertex buffers", "index buffers", "staging"
+};
+
+// gl names are small and dense, so each kind is indexed by name
+static array<gpuAllocation_t> gm_objects[GPUMEM_NUM_KINDS];
+static gpuMemStats_t gm_stats;
+static gpuMemEvictFunc_t gm_evictors[GPUMEM_MAX_EVICTORS];
+static int gm_numEvictors = 0;
+static bool gm_overBudget = false;
+
+static int R_GpuMemKind(GLenum kind)
+{
+	switch (kind)
+	{
+	case GL_TEXTURE:
+		return GPUMEM_KIND_TEXTURE;
+	case GL_BUFFER:
+		return GPUMEM_KIND_BUFFER;
+	case GL_RENDERBUFFER:
+		return GPUMEM_KIND_RENDERBUFFER;
+	}
+	Sys_Error("R_GpuMemKind: bad object kind 0x%x", kind);
+	return 0;
+}
+
+static gpuAllocation_t* R_FindAllocation(GLenum kind, GLuint name, bool create)
+{
+	array<gpuAllocation_t>& objects = gm_objects[R_GpuMemKind(kind)];
+	if (name >= objects.size())
+	{
+		if (!create)
+			return NULL;
+		unsigned int used = objects.size();
+		objects.set_used(name + 1);
+		for (unsigned int i = used; i < objects.size(); i++)
+		{
+			objects[i].bytes = 0;
+			objects[i].category = -1;
+		}
+	}
+	gpuAllocation_t* a = &objects[name];
+	if (a->category < 0 && !create)
+		return NULL;
+	return a;
+}
+
+static void R_GpuMemChange(int category, int bytes)
+{
+	gm_stats.bytes[category] += bytes;
+	gm_stats.totalBytes += bytes;
+	if (gm_stats.bytes[category] > gm_stats.peakBytes[category])
+		gm_stats.peakBytes[category] = gm_stats.bytes[category];
+	if (gm_stats.totalBytes > gm_stats.peakTotalBytes)
+		gm_stats.peakTotalBytes = gm_stats.totalBytes;
+}
+
+void R_GpuMemAlloc(GLenum kind, GLuint name, gpuMemCategory_t category, int bytes)
+{
+	if (name == 0)
+		return;
+
+	gpuAllocation_t* a = R_FindAllocation(kind, name, true);
+	if (a->category < 0)
+	{
+		a->category = category;
+		gm_stats.objects[category]++;
+	}
+	a->bytes += bytes;
+	R_GpuMemChange(a->category, bytes);
+}
+
+void R_GpuMemRelease(GLenum kind, GLuint name, int bytes)
+{
+	gpuAllocation_t* a = R_FindAllocation(kind, name, false);
+	if (a == NULL)
+		return;
+
+	if (bytes > a->bytes)
+		bytes = a->bytes;
+	a->bytes -= bytes;
+	R_GpuMemChange(a->category, -bytes);
+}
+
+void R_GpuMemDelete(GLenum kind, GLuint name)
+{
+	gpuAllocation_t* a = R_FindAllocation(kind, name, false);
+	if (a == NULL)
+		return;
+
+	R_GpuMemChange(a->category, -a->bytes);
+	gm_stats.objects[a->category]--;
+	a->bytes = 0;
+	a->category = -1;
+}
+
+void R_DeleteTexture(GLuint& name)
+{
+	if (name == 0)
+		return;
+	R_GpuMemDelete(GL_TEXTURE, name);
+	glDeleteTextures(1, &name);
+	name = 0;
+}
+
+void R_DeleteBuffer(GLuint& name)
+{
+	if (name == 0)
+		return;
+	R_GpuMemDelete(GL_BUFFER, name);
+	glDeleteBuffers(1, &name);
+	name = 0;
+}
+
+void R_DeleteRenderbuffer(GLuint& name)
+{
+	if (name == 0)
+		return;
+	R_GpuMemDelete(GL_RENDERBUFFER, name);
+	glDeleteRenderbuffers(1, &name);
+	name = 0;
+}
+
+void R_AddGpuMemEvictor(gpuMemEvictFunc_t func)
+{
+	for (int i = 0; i < gm_numEvictors; i++)
+	{
+		if (gm_evictors[i] == func)
+			return;
+	}
+	if (gm_numEvictors == GPUMEM_MAX_EVICTORS)
+	{
+		Sys_Printf("R_AddGpuMemEvictor: too many evictors\n");
+		return;
+	}
+	gm_evictors[gm_numEvictors++] = func;
+}
+
+static void R_GpuMem_f(int argc, const char** argv)
+{
+	if (argc > 1 && !strcmp(argv[1], "resetpeak"))
+	{
+		for (int i = 0; i < GPUMEM_NUM_CATEGORIES; i++)
+			gm_stats.peakBytes[i] = gm_stats.bytes[i];
+		gm_stats.peakTotalBytes = gm_stats.totalBytes;
+		gm_stats.peakFrameUploadBytes = 0;
+	}
+	R_PrintGpuMemory();
+}
+
+static void R_GpuMemBudget_f(int argc, const char** argv)
+{
+	if (argc > 1)
+	{
+		gpuMemBudgetMode_t mode = gm_stats.budgetMode;
+		if (argc > 2)
+			mode = strcmp(argv[2], "evict") ? GPUMEM_BUDGET_WARN : GPUMEM_BUDGET_EVICT;
+		R_SetGpuMemBudget(atoll(argv[1]) * 1024 * 1024, mode);
+	}
+	Sys_Printf("gpu memory budget %lld MB, %s\n", gm_stats.budget / (1024 * 1024),
+		gm_stats.budgetMode == GPUMEM_BUDGET_EVICT ? "evict" : "warn");
+}
+
+void R_InitGpuMemory()
+{
+	gm_stats.budget = GPUMEM_DEFAULT_BUDGET;
+	gm_stats.budgetMode = GPUMEM_BUDGET_WARN;
+	Cmd_AddCommand("gpumem", R_GpuMem_f, "gpu memory by category, gpumem resetpeak restarts the peaks");
+	Cmd_AddCommand("gpumem_budget", R_GpuMemBudget_f, "gpumem_budget [MB] [warn|evict]");
+}
+
+void R_SetGpuMemBudget(long long bytes, gpuMemBudgetMode_t mode)
+{
+	gm_stats.budget = bytes > 0 ? bytes : GPUMEM_DEFAULT_BUDGET;
+	gm_stats.budgetMode = mode;
+	gm_overBudget = false;
+}
+
+void R_UpdateGpuMemory()
+{
+	gm_stats.frameUploadBytes = glCounters.uploadBytes;
+	if (gm_stats.frameUploadBytes > gm_stats.peakFrameUploadBytes)
+		gm_stats.peakFrameUploadBytes = gm_stats.frameUploadBytes;
+
+	if (gm_stats.totalBytes <= gm_stats.budget)
+	{
+		gm_overBudget = false;
+		return;
+	}
+
+	if (gm_stats.budgetMode == GPUMEM_BUDGET_EVICT)
+	{
+		for (int i = 0; i < gm_numEvictors && gm_stats.totalBytes > gm_stats.budget; i++)
+		{
+			// evictors count in int, they get asked again next frame
+			long long over = gm_stats.totalBytes - gm_stats.budget;
+			gm_stats.evictedBytes += gm_evictors[i](over > INT_MAX ? INT_MAX : (int)over);
+		}
+		if (gm_stats.totalBytes <= gm_stats.budget)
+			return;
+	}
+
+	// once per crossing, not every frame spent over it
+	if (!gm_overBudget)
+		Sys_Printf("gpu memory over budget: %lld of %lld bytes\n", gm_stats.totalBytes, gm_stats.budget);
+	gm_overBudget = true;
+}
+
+void R_GetGpuMemStats(gpuMemStats_t* stats)
+{
+	*stats = gm_stats;
+}
+
+const char* R_GpuMemCategoryName(int category)
+{
+	if (category < 0 || category >= GPUMEM_NUM_CATEGORIES)
+		return "";
+	return gm_categoryNames[category];
+}
+
+void R_PrintGpuMemory()
+{
+	Sys_Printf("%-16s %8s %12s %12s\n", "category", "objects", "bytes", "peak");
+	for (int i = 0; i < GPUMEM_NUM_CATEGORIES; i++)
+	{
+		Sys_Printf("%-16s %8d %12lld %12lld\n", gm_categoryNames[i], gm_stats.objects[i],
+			gm_stats.bytes[i], gm_stats.peakBytes[i]);
+	}
+	Sys_Printf("%-16s %8s %12lld %12lld\n", "total", "", gm_stats.totalBytes, gm_stats.peakTotalBytes);
+	Sys_Printf("uploads %d bytes last frame, %d peak; budget %lld bytes (%s), %lld evicted\n",
+		gm_stats.frameUploadBytes, gm_stats.peakFrameUploadBytes, gm_stats.budget,
+		gm_stats.budgetMode == GPUMEM_BUDGET_EVICT ? "evict" : "warn", gm_stats.evictedBytes);
+}
@@ -0,0 +1,92 @@
+#ifndef __GPUMEMORY_H__
+#define __GPUMEMORY_H__
+
+#include "../glutils.h"
+
+/*
+===============================================================================
+
+	Gpu memory registry
+
+	Every texture, render target, renderbuffer and buffer the renderer
+	creates is registered here with the bytes its storage takes, under
+	the gl object name and a category. Textures add their levels as they
+	are uploaded and take them off as the streamer drops them; deleting
+	an object through R_DeleteTexture, R_DeleteBuffer or
+	R_DeleteRenderbuffer takes all of it off. Current and peak bytes are
+	kept per category, and the upload bytes of every frame from
+	glCounters.
+
+	A budget can be set on the total. Over it, the registry either only
+	warns or, in evict mode, asks the registered evictors (the texture
+	streamer drops levels) to free the difference, and warns about what
+	is left. The check runs once a frame after the draws, not on every
+	allocation, so nothing is evicted while a frame still uses it.
+
+	Main thread only, like the gl calls it follows.
+
+===============================================================================
+*/
+
+#define GPUMEM_DEFAULT_BUDGET		(512LL * 1024 * 1024)
+
+typedef enum
+{
+	GPUMEM_TEXTURE,
+	GPUMEM_RENDER_TARGET,
+	GPUMEM_SHADOW_MAP,
+	GPUMEM_VERTEX_BUFFER,
+	GPUMEM_INDEX_BUFFER,
+	GPUMEM_STAGING,				// pixel unpack buffers
+	GPUMEM_NUM_CATEGORIES
+}gpuMemCategory_t;
+
+typedef enum
+{
+	GPUMEM_BUDGET_WARN,
+	GPUMEM_BUDGET_EVICT
+}gpuMemBudgetMode_t;
+
+// totals are 64 bit, a card has more than 2 GB
+typedef struct
+{
+	long long bytes[GPUMEM_NUM_CATEGORIES];
+	long long peakBytes[GPUMEM_NUM_CATEGORIES];
+	int objects[GPUMEM_NUM_CATEGORIES];
+	long long totalBytes;
+	long long peakTotalBytes;
+	int frameUploadBytes;		// last frame
+	int peakFrameUploadBytes;
+	long long budget;
+	gpuMemBudgetMode_t budgetMode;
+	long long evictedBytes;
+}gpuMemStats_t;
+
+// frees up to bytes, returns what it freed
+typedef int (*gpuMemEvictFunc_t)(int bytes);
+
+// registers the commands, before the first object is created
+void	R_InitGpuMemory();
+
+// kind is GL_TEXTURE, GL_BUFFER or GL_RENDERBUFFER; alloc adds to what
+// the object already has (texture levels), release takes bytes off
+void	R_GpuMemAlloc(GLenum kind, GLuint name, gpuMemCategory_t category, int bytes);
+void	R_GpuMemRelease(GLenum kind, GLuint name, int bytes);
+void	R_GpuMemDelete(GLenum kind, GLuint name);
+
+// delete the gl object and its registration, the name is zeroed
+void	R_DeleteTexture(GLuint& name);
+void	R_DeleteBuffer(GLuint& name);
+void	R_DeleteRenderbuffer(GLuint& name);
+
+void	R_AddGpuMemEvictor(gpuMemEvictFunc_t func);
+void	R_SetGpuMemBudget(long long bytes, gpuMemBudgetMode_t mode);
+
+// once a frame, before glCounters is reset
+void	R_UpdateGpuMemory();
+
+void	R_GetGpuMemStats(gpuMemStats_t* stats);
+const char*	R_GpuMemCategoryName(int category);
+void	R_PrintGpuMemory();
+
+#endif
@@ -0,0 +1,70 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer():_current(0), _active(false), _lastMs(0.0)
+{
+	for (int i = 0; i < GPUTIMER_LATENCY; i++)
+	{
+		_queries[i][0] = 0;
+		_queries[i][1] = 0;
+		_pending[i] = false;
+	}
+}
+
+GpuTimer::~GpuTimer()
+{
+	if (_queries[0][0] != 0)
+		glDeleteQueries(GPUTIMER_LATENCY * 2, &_queries[0][0]);
+}
+
+bool GpuTimer::Collect( int slot )
+{
+	if (!_pending[slot])
+		return true;
+
+	// the end stamp lands after the begin one
+	GLint available = 0;
+	glGetQueryObjectiv(_queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	GLuint64 begin = 0, end = 0;
+	glGetQueryObjectui64v(_queries[slot][0], GL_QUERY_RESULT, &begin);
+	glGetQueryObjectui64v(_queries[slot][1], GL_QUERY_RESULT, &end);
+	_lastMs = (end - begin) / 1000000.0;
+	_pending[slot] = false;
+	return true;
+}
+
+void GpuTimer::Begin()
+{
+	if (_queries[0][0] == 0)
+		glGenQueries(GPUTIMER_LATENCY * 2, &_queries[0][0]);
+
+	// pick up everything that finished since last time, oldest first
+	for (int i = 1; i <= GPUTIMER_LATENCY; i++)
+		Collect((_current + i) % GPUTIMER_LATENCY);
+
+	_active = !_pending[_current];
+	if (_active)
+		glQueryCounter(_queries[_current][0], GL_TIMESTAMP);
+}
+
+void GpuTimer::Reset()
+{
+	// a query still in flight is simply issued again
+	for (int i = 0; i < GPUTIMER_LATENCY; i++)
+		_pending[i] = false;
+	_active = false;
+	_lastMs = 0.0;
+}
+
+void GpuTimer::End()
+{
+	if (!_active)
+		return;
+
+	glQueryCounter(_queries[_current][1], GL_TIMESTAMP);
+	_pending[_current] = true;
+	_current = (_current + 1) % GPUTIMER_LATENCY;
+	_active = false;
+}
@@ -0,0 +1,39 @@
+#ifndef __GPUTIMER_H__
+#define __GPUTIMER_H__
+
+#include "../glutils.h"
+
+#define GPUTIMER_LATENCY 4
+
+// ring of GL_TIMESTAMP query pairs. results are read a few frames late so
+// the cpu never waits on the gpu; a frame is skipped when every pair in the
+// ring is still in flight. timestamps, unlike GL_TIME_ELAPSED, can nest.
+class GpuTimer
+{
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	void Begin();
+
+	void End();
+
+	// forget the queries in flight and the last time, when the timer
+	// starts measuring something else
+	void Reset();
+
+	// milliseconds of the latest finished query
+	double GetMs() { return _lastMs; }
+
+private:
+	bool Collect(int slot);
+
+private:
+	GLuint _queries[GPUTIMER_LATENCY][2];
+	bool _pending[GPUTIMER_LATENCY];
+	int _current;
+	bool _active;
+	double _lastMs;
+};
+
+#endif
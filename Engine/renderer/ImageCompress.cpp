@@ -0,0 +1,495 @@
+#include "ImageCompress.h"
+#include "../Image.h"
+#include "../sys/sys_public.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC_USE_SSE
+#include <emmintrin.h>
+#endif
+
+#define BC_MAX_THREADS		8
+#define BC_THREAD_ROWS		32		// block rows a band needs before a level is split
+
+// one block, a float array per channel for the index search
+typedef struct
+{
+	float r[16];
+	float g[16];
+	float b[16];
+}bcColors_t;
+
+typedef struct
+{
+	const unsigned char* pixels;
+	int width;
+	int height;
+	int bpp;
+	bool bgr;
+	bool alpha;				// bc3 instead of bc1
+	unsigned char* out;
+	int firstRow;			// in blocks
+	int numRows;
+	xthreadInfo thread;
+}bcJob_t;
+
+static const float bc_weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };	// of c0, by index
+
+static void BC_UnpackColor(unsigned short c, float* out)
+{
+	int r = (c >> 11) & 31;
+	int g = (c >> 5) & 63;
+	int b = c & 31;
+	out[0] = (float)((r << 3) | (r >> 2));
+	out[1] = (float)((g << 2) | (g >> 4));
+	out[2] = (float)((b << 3) | (b >> 2));
+}
+
+static int BC_Quantize(float v, int bits)
+{
+	int max = (1 << bits) - 1;
+	int q = (int)(v * max / 255.0f + 0.5f);
+	return q < 0 ? 0 : (q > max ? max : q);
+}
+
+static unsigned short BC_PackColor(const float* c)
+{
+	return (unsigned short)((BC_Quantize(c[0], 5) << 11) | (BC_Quantize(c[1], 6) << 5) | BC_Quantize(c[2], 5));
+}
+
+// in index order: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+static void BC_Palette(unsigned short c0, unsigned short c1, float pal[4][3])
+{
+	BC_UnpackColor(c0, pal[0]);
+	BC_UnpackColor(c1, pal[1]);
+	for (int k = 0; k < 3; k++)
+	{
+		pal[2][k] = (2.0f * pal[0][k] + pal[1][k]) / 3.0f;
+		pal[3][k] = (pal[0][k] + 2.0f * pal[1][k]) / 3.0f;
+	}
+}
+
+// nearest palette entry for every pixel, returns the squared error
+static float BC_PickIndices(const bcColors_t& block, const float pal[4][3], int* indices)
+{
+#ifdef BC_USE_SSE
+	__m128 total = _mm_setzero_ps();
+	for (int i = 0; i < 16; i += 4)
+	{
+		__m128 r = _mm_loadu_ps(block.r + i);
+		__m128 g = _mm_loadu_ps(block.g + i);
+		__m128 b = _mm_loadu_ps(block.b + i);
+		__m128 best = _mm_set1_ps(1e30f);
+		__m128 bestIndex = _mm_setzero_ps();
+		for (int k = 0; k < 4; k++)
+		{
+			__m128 dr = _mm_sub_ps(r, _mm_set1_ps(pal[k][0]));
+			__m128 dg = _mm_sub_ps(g, _mm_set1_ps(pal[k][1]));
+			__m128 db = _mm_sub_ps(b, _mm_set1_ps(pal[k][2]));
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+			__m128 closer = _mm_cmplt_ps(d, best);
+			best = _mm_min_ps(d, best);
+			bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)k)), _mm_andnot_ps(closer, bestIndex));
+		}
+		total = _mm_add_ps(total, best);
+		_mm_storeu_si128((__m128i*)(indices + i), _mm_cvttps_epi32(bestIndex));
+	}
+
+	float sums[4];
+	_mm_storeu_ps(sums, total);
+	return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+	float total = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float best = 1e30f;
+		int bestIndex = 0;
+		for (int k = 0; k < 4; k++)
+		{
+			float dr = block.r[i] - pal[k][0];
+			float dg = block.g[i] - pal[k][1];
+			float db = block.b[i] - pal[k][2];
+			float d = dr * dr + dg * dg + db * db;
+			if (d < best)
+			{
+				best = d;
+				bestIndex = k;
+			}
+		}
+		indices[i] = bestIndex;
+		total += best;
+	}
+	return total;
+#endif
+}
+
+// the pixels furthest apart along the principal axis
+static void BC_FitEndpoints(const bcColors_t& block, float* e0, float* e1)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	float mins[3] = { 255.0f, 255.0f, 255.0f };
+	float maxs[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float p[3] = { block.r[i], block.g[i], block.b[i] };
+		for (int k = 0; k < 3; k++)
+		{
+			mean[k] += p[k];
+			mins[k] = p[k] < mins[k] ? p[k] : mins[k];
+			maxs[k] = p[k] > maxs[k] ? p[k] : maxs[k];
+		}
+	}
+	for (int k = 0; k < 3; k++)
+		mean[k] /= 16.0f;
+
+	// rr rg rb gg gb bb
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float r = block.r[i] - mean[0];
+		float g = block.g[i] - mean[1];
+		float b = block.b[i] - mean[2];
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// power iteration, starting from the bounding box diagonal
+	float axis[3] = { maxs[0] - mins[0], maxs[1] - mins[1], maxs[2] - mins[2] };
+	for (int iter = 0; iter < 4; iter++)
+	{
+		float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		float len = fabsf(x) > fabsf(y) ? fabsf(x) : fabsf(y);
+		len = fabsf(z) > len ? fabsf(z) : len;
+		if (len < 1e-6f)
+			break;
+		axis[0] = x / len;
+		axis[1] = y / len;
+		axis[2] = z / len;
+	}
+
+	int minIndex = 0;
+	int maxIndex = 0;
+	float minDot = 1e30f;
+	float maxDot = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float d = block.r[i] * axis[0] + block.g[i] * axis[1] + block.b[i] * axis[2];
+		if (d < minDot)
+		{
+			minDot = d;
+			minIndex = i;
+		}
+		if (d > maxDot)
+		{
+			maxDot = d;
+			maxIndex = i;
+		}
+	}
+
+	e0[0] = block.r[maxIndex];
+	e0[1] = block.g[maxIndex];
+	e0[2] = block.b[maxIndex];
+	e1[0] = block.r[minIndex];
+	e1[1] = block.g[minIndex];
+	e1[2] = block.b[minIndex];
+}
+
+// least squares endpoints for the chosen indices
+static bool BC_RefineEndpoints(const bcColors_t& block, const int* indices, float* e0, float* e1)
+{
+	float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+	float ax[3] = { 0.0f, 0.0f, 0.0f };
+	float bx[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float a = bc_weights[indices[i]];
+		float b = 1.0f - a;
+		float p[3] = { block.r[i], block.g[i], block.b[i] };
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for (int k = 0; k < 3; k++)
+		{
+			ax[k] += a * p[k];
+			bx[k] += b * p[k];
+		}
+	}
+
+	float det = aa * bb - ab * ab;
+	if (fabsf(det) < 1e-6f)
+		return false;
+
+	for (int k = 0; k < 3; k++)
+	{
+		float c0 = (ax[k] * bb - bx[k] * ab) / det;
+		float c1 = (bx[k] * aa - ax[k] * ab) / det;
+		e0[k] = c0 < 0.0f ? 0.0f : (c0 > 255.0f ? 255.0f : c0);
+		e1[k] = c1 < 0.0f ? 0.0f : (c1 > 255.0f ? 255.0f : c1);
+	}
+	return true;
+}
+
+static void BC_EncodeColors(const bcColors_t& block, unsigned char* out)
+{
+	float e0[3], e1[3];
+	BC_FitEndpoints(block, e0, e1);
+
+	unsigned short c0 = BC_PackColor(e0);
+	unsigned short c1 = BC_PackColor(e1);
+	float pal[4][3];
+	int indices[16];
+	BC_Palette(c0, c1, pal);
+	float error = BC_PickIndices(block, pal, indices);
+
+	if (c0 != c1 && BC_RefineEndpoints(block, indices, e0, e1))
+	{
+		unsigned short r0 = BC_PackColor(e0);
+		unsigned short r1 = BC_PackColor(e1);
+		int refined[16];
+		BC_Palette(r0, r1, pal);
+		if (r0 != r1 && BC_PickIndices(block, pal, refined) < error)
+		{
+			c0 = r0;
+			c1 = r1;
+			memcpy(indices, refined, sizeof(indices));
+		}
+	}
+
+	unsigned int bits = 0;
+	for (int i = 15; i >= 0; i--)
+		bits = (bits << 2) | indices[i];
+
+	// four colour mode needs c0 > c1, swapping the endpoints swaps
+	// indices 0/1 and 2/3; equal endpoints would select the three colour
+	// mode where index 3 is black
+	if (c0 < c1)
+	{
+		unsigned short t = c0;
+		c0 = c1;
+		c1 = t;
+		bits ^= 0x55555555;
+	}
+	else if (c0 == c1)
+		bits = 0;
+
+	out[0] = (unsigned char)c0;
+	out[1] = (unsigned char)(c0 >> 8);
+	out[2] = (unsigned char)c1;
+	out[3] = (unsigned char)(c1 >> 8);
+	out[4] = (unsigned char)bits;
+	out[5] = (unsigned char)(bits >> 8);
+	out[6] = (unsigned char)(bits >> 16);
+	out[7] = (unsigned char)(bits >> 24);
+}
+
+static void BC_EncodeAlpha(const unsigned char* rgba, unsigned char* out)
+{
+	int a0 = 0;
+	int a1 = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		int a = rgba[i * 4 + 3];
+		a0 = a > a0 ? a : a0;
+		a1 = a < a1 ? a : a1;
+	}
+
+	out[0] = (unsigned char)a0;
+	out[1] = (unsigned char)a1;
+	if (a0 == a1)
+	{
+		memset(out + 2, 0, 6);
+		return;
+	}
+
+	// a0 > a1 selects the eight value palette
+	int pal[8];
+	pal[0] = a0;
+	pal[1] = a1;
+	for (int k = 1; k < 7; k++)
+		pal[k + 1] = ((7 - k) * a0 + k * a1 + 3) / 7;
+
+	unsigned long long bits = 0;
+	for (int i = 15; i >= 0; i--)
+	{
+		int a = rgba[i * 4 + 3];
+		int best = 0;
+		int bestError = 256;
+		for (int k = 0; k < 8; k++)
+		{
+			int e = a > pal[k] ? a - pal[k] : pal[k] - a;
+			if (e < bestError)
+			{
+				bestError = e;
+				best = k;
+			}
+		}
+		bits = (bits << 3) | best;
+	}
+
+	for (int k = 0; k < 6; k++)
+		out[2 + k] = (unsigned char)(bits >> (8 * k));
+}
+
+void R_EncodeBC1Block(const unsigned char* rgba, unsigned char* out)
+{
+	bcColors_t block;
+	for (int i = 0; i < 16; i++)
+	{
+		block.r[i] = rgba[i * 4 + 0];
+		block.g[i] = rgba[i * 4 + 1];
+		block.b[i] = rgba[i * 4 + 2];
+	}
+	BC_EncodeColors(block, out);
+}
+
+void R_EncodeBC3Block(const unsigned char* rgba, unsigned char* out)
+{
+	BC_EncodeAlpha(rgba, out);
+	R_EncodeBC1Block(rgba, out + 8);
+}
+
+// edge pixels repeat into the blocks that hang over the image
+static void BC_FetchBlock(const bcJob_t* job, int bx, int by, unsigned char* rgba)
+{
+	int r = job->bgr ? 2 : 0;
+	int b = job->bgr ? 0 : 2;
+	for (int y = 0; y < 4; y++)
+	{
+		int sy = by * 4 + y;
+		sy = sy < job->height ? sy : job->height - 1;
+		for (int x = 0; x < 4; x++)
+		{
+			int sx = bx * 4 + x;
+			sx = sx < job->width ? sx : job->width - 1;
+			const unsigned char* p = job->pixels + (sy * job->width + sx) * job->bpp;
+			unsigned char* d = rgba + (y * 4 + x) * 4;
+			d[0] = p[r];
+			d[1] = p[1];
+			d[2] = p[b];
+			d[3] = job->bpp == 4 ? p[3] : 255;
+		}
+	}
+}
+
+static void BC_EncodeRows(bcJob_t* job)
+{
+	int blocksWide = (job->width + 3) / 4;
+	int blockBytes = job->alpha ? BC3_BLOCK_BYTES : BC1_BLOCK_BYTES;
+	unsigned char rgba[64];
+	for (int by = job->firstRow; by < job->firstRow + job->numRows; by++)
+	{
+		unsigned char* out = job->out + by * blocksWide * blockBytes;
+		for (int bx = 0; bx < blocksWide; bx++, out += blockBytes)
+		{
+			BC_FetchBlock(job, bx, by, rgba);
+			if (job->alpha)
+				R_EncodeBC3Block(rgba, out);
+			else
+				R_EncodeBC1Block(rgba, out);
+		}
+	}
+}
+
+static unsigned int BC_EncodeThread(void* parms)
+{
+	BC_EncodeRows((bcJob_t*)parms);
+	return 0;
+}
+
+bool R_CanCompressImage(const Image& image)
+{
+	if (image.IsCompressed() || image.IsCubeMap() || image.IsVolume() || image._type != GL_UNSIGNED_BYTE)
+		return false;
+	if (image._levelCount < 1 || (int)image._data.size() < image._levelCount)
+		return false;
+
+	switch (image._format)
+	{
+	case GL_RGB:
+	case GL_BGR:
+		return image._elementSize == 3;
+	case GL_RGBA:
+	case GL_BGRA:
+		return image._elementSize == 4;
+	}
+	return false;
+}
+
+static bool BC_HasAlpha(const Image& image)
+{
+	if (image._elementSize != 4)
+		return false;
+
+	const unsigned char* p = (const unsigned char*)image.GetLevel(0);
+	int numPixels = image._width * image._height;
+	for (int i = 0; i < numPixels; i++)
+	{
+		if (p[i * 4 + 3] != 255)
+			return true;
+	}
+	return false;
+}
+
+bool R_CompressImage(Image& image)
+{
+	if (!R_CanCompressImage(image))
+		return false;
+
+	bool alpha = BC_HasAlpha(image);
+	int blockBytes = alpha ? BC3_BLOCK_BYTES : BC1_BLOCK_BYTES;
+	int maxJobs = Sys_GetNumCpus();
+	maxJobs = maxJobs < BC_MAX_THREADS ? maxJobs : BC_MAX_THREADS;
+
+	bcJob_t jobs[BC_MAX_THREADS];
+	for (int l = 0; l < image._levelCount; l++)
+	{
+		int w = image._width >> l;
+		int h = image._height >> l;
+		w = w ? w : 1;
+		h = h ? h : 1;
+		int blocksHigh = (h + 3) / 4;
+		unsigned char* out = new unsigned char[((w + 3) / 4) * blocksHigh * blockBytes];
+
+		int numJobs = blocksHigh / BC_THREAD_ROWS;
+		numJobs = numJobs < maxJobs ? numJobs : maxJobs;
+		numJobs = numJobs > 1 ? numJobs : 1;
+		int rows = (blocksHigh + numJobs - 1) / numJobs;
+		for (int j = 0; j < numJobs; j++)
+		{
+			bcJob_t& job = jobs[j];
+			job.pixels = (const unsigned char*)image.GetLevel(l);
+			job.width = w;
+			job.height = h;
+			job.bpp = image._elementSize;
+			job.bgr = image._format == GL_BGR || image._format == GL_BGRA;
+			job.alpha = alpha;
+			job.out = out;
+			job.firstRow = j * rows;
+			job.numRows = blocksHigh - job.firstRow < rows ? blocksHigh - job.firstRow : rows;
+		}
+
+		// the first band runs here
+		for (int j = 1; j < numJobs; j++)
+			Sys_CreateThread(BC_EncodeThread, &jobs[j], jobs[j].thread, "bc encoder");
+		BC_EncodeRows(&jobs[0]);
+		for (int j = 1; j < numJobs; j++)
+			Sys_JoinThread(jobs[j].thread);
+
+		delete [] image._data[l];
+		image._data[l] = out;
+	}
+
+	GLenum format = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	image._format = format;
+	image._internalFormat = format;
+	image._type = format;
+	image._elementSize = blockBytes;
+	return true;
+}
@@ -0,0 +1,37 @@
+#ifndef __IMAGECOMPRESS_H__
+#define __IMAGECOMPRESS_H__
+
+/*
+===============================================================================
+
+	Block compression
+
+	8 bit rgb(a) images are encoded to BC1 (DXT1) when every pixel is
+	opaque and to BC3 (DXT5) otherwise. Colour endpoints come from the
+	principal axis of the block and are refined by a least squares fit of
+	the chosen indices; the index search runs four pixels at a time with
+	SSE when the compiler targets it. Large levels are split into bands of
+	block rows that are encoded on several threads.
+
+===============================================================================
+*/
+
+#define BC_ENCODER_VERSION		1		// bump when the output changes, it keys the cache
+
+#define BC1_BLOCK_BYTES			8
+#define BC3_BLOCK_BYTES			16
+
+class Image;
+
+// rgba is 16 pixels, 4 rows of 4, 4 bytes each
+void	R_EncodeBC1Block(const unsigned char* rgba, unsigned char* out);
+void	R_EncodeBC3Block(const unsigned char* rgba, unsigned char* out);
+
+// 2d 8 bit GL_RGB / GL_BGR / GL_RGBA / GL_BGRA images
+bool	R_CanCompressImage(const Image& image);
+
+// replaces every level with its compressed version, false leaves the
+// image untouched
+bool	R_CompressImage(Image& image);
+
+#endif
@@ -0,0 +1,141 @@
+#include "ImageImport.h"
+#include "ImageCompress.h"
+#include "ImageMips.h"
+#include "TextureCache.h"
+#include "../Image.h"
+#include "../ImageLoader.h"
+#include "../glutils.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the loader threads count into these
+typedef struct
+{
+	std::atomic<int> cooked;
+	std::atomic<int> compressed;
+	std::atomic<int> uncompressed;	// formats the encoder doesn't take
+}imageImportStats_t;
+
+static bool import_supported = false;
+static bool import_compress = false;
+static mipSettings_t import_mips = { MIP_FILTER_KAISER, true, 0.5f };
+static imageImportStats_t import_stats;
+
+static const char* mip_filterNames[] = { "none", "box", "kaiser" };
+
+// fnv-1a over 64 bit words of the file, then everything that changes
+// the output
+static bool R_ImportKey(const char* file, unsigned long long* key)
+{
+	int size = 0;
+	const void* data = Sys_MapFile(file, &size);
+	if (data == NULL)
+		return false;
+
+	const unsigned long long prime = 1099511628211ull;
+	unsigned long long h = 14695981039346656037ull;
+	const unsigned char* p = (const unsigned char*)data;
+	int words = size / 8;
+	for (int i = 0; i < words; i++, p += 8)
+	{
+		unsigned long long w;
+		memcpy(&w, p, 8);
+		h = (h ^ w) * prime;
+	}
+	for (int i = words * 8; i < size; i++, p++)
+		h = (h ^ *p) * prime;
+	Sys_UnmapFile(data, size);
+
+	unsigned int settings[] = { (unsigned int)size, import_compress, BC_ENCODER_VERSION, MIP_GENERATOR_VERSION,
+		(unsigned int)import_mips.filter, import_mips.gamma, (unsigned int)(import_mips.alphaRef * 255.0f) };
+	for (int i = 0; i < (int)(sizeof(settings) / sizeof(settings[0])); i++)
+		h = (h ^ settings[i]) * prime;
+
+	*key = h;
+	return true;
+}
+
+static void R_ImageCompress_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetImageCompression(atoi(argv[1]) != 0);
+	Sys_Printf("image compression %s: %d images cooked, %d compressed, %d left uncompressed\n",
+		import_compress ? "on" : "off", (int)import_stats.cooked, (int)import_stats.compressed,
+		(int)import_stats.uncompressed);
+}
+
+static void R_ImageMips_f(int argc, const char** argv)
+{
+	for (int i = 0; argc > 1 && i < (int)(sizeof(mip_filterNames) / sizeof(mip_filterNames[0])); i++)
+	{
+		if (strcmp(argv[1], mip_filterNames[i]) == 0)
+			import_mips.filter = (mipFilter_t)i;
+	}
+	if (argc > 2)
+		import_mips.gamma = atoi(argv[2]) != 0;
+	Sys_Printf("image mips: %s filter, gamma %s, alpha coverage at %g\n",
+		mip_filterNames[import_mips.filter], import_mips.gamma ? "on" : "off", import_mips.alphaRef);
+}
+
+void R_InitImageImport()
+{
+	Cmd_AddCommand("image_compress", R_ImageCompress_f, "block compression of imported images, image_compress 0/1 toggles it");
+	Cmd_AddCommand("image_mips", R_ImageMips_f, "image_mips [none|box|kaiser] [gamma 0/1], mip chain of imported images");
+	R_InitTextureCache();
+
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	import_supported = extensions != NULL && strstr(extensions, "GL_EXT_texture_compression_s3tc") != NULL;
+	if (!import_supported)
+	{
+		Sys_Printf("image import: driver has no s3tc, textures stay uncompressed\n");
+		return;
+	}
+	import_compress = true;
+}
+
+bool R_ImportImage(const char* file, loadImageFunc func, Image& image)
+{
+	if (func == loadImageDDS)
+		return func(file, image);
+
+	char path[256];
+	unsigned long long key;
+	bool keyed = GL_DISK_CACHES && R_ImportKey(file, &key);
+	if (keyed)
+	{
+		R_TextureCachePath(path, key);
+		if (R_LoadCookedTexture(path, key, image))
+			return true;
+	}
+
+	if (!func(file, image))
+		return false;
+
+	R_GenerateMipmaps(image, import_mips);
+	if (import_compress)
+	{
+		if (R_CompressImage(image))
+			import_stats.compressed++;
+		else
+			import_stats.uncompressed++;
+	}
+
+	import_stats.cooked++;
+	if (keyed)
+		R_StoreCookedTexture(path, key, image);
+	return true;
+}
+
+void R_SetImageCompression(bool enable)
+{
+	import_compress = enable && import_supported;
+}
+
+bool R_IsImageCompressionEnabled()
+{
+	return import_compress;
+}
@@ -0,0 +1,31 @@
+#ifndef __IMAGEIMPORT_H__
+#define __IMAGEIMPORT_H__
+
+#include "../ResourceSystem.h"
+
+/*
+===============================================================================
+
+	Image import
+
+	Source images go through here on their way to a texture. A decoded
+	image gets its mip chain (see ImageMips.h), is block compressed when
+	that is on (see ImageCompress.h) and goes to the cooked texture cache
+	(see TextureCache.h) under a hash of the source bytes and the import
+	settings. The next run maps the cooked file instead of decoding, an
+	edited source or a changed setting simply misses. Safe to call from
+	the texture loader threads.
+
+===============================================================================
+*/
+
+// main thread once the gl context exists; compression stays off when the
+// driver has no s3tc support
+void	R_InitImageImport();
+
+bool	R_ImportImage(const char* file, loadImageFunc func, Image& image);
+
+void	R_SetImageCompression(bool enable);
+bool	R_IsImageCompressionEnabled();
+
+#endif
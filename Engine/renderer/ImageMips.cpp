@@ -0,0 +1,361 @@
+#include "ImageMips.h"
+#include "../Image.h"
+#include "../sys/sys_public.h"
+#include <math.h>
+#include <string.h>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_USE_SSE
+#include <emmintrin.h>
+#endif
+
+#define MIP_MAX_THREADS		8
+#define MIP_THREAD_ROWS		128		// rows a band needs before a level is split
+#define MIP_KAISER_TAPS		8
+#define MIP_SRGB_STEPS		16384
+#define MIP_CUTOUT_SHARE	0.9f	// share of pixels at alpha 0 or 1 that makes a cutout
+
+typedef struct
+{
+	int width;
+	int height;
+	float* pixels;		// rgba
+}mipLevel_t;
+
+typedef struct mipJob_s
+{
+	void (*func)(const struct mipJob_s* job);
+	const mipLevel_t* src;
+	mipLevel_t* dst;
+	float* temp;		// kaiser, the horizontal pass: dst width x src height
+	int firstRow;
+	int numRows;
+	xthreadInfo thread;
+}mipJob_t;
+
+static float mip_toLinear[256];
+static unsigned char mip_toSrgb[MIP_SRGB_STEPS];
+static float mip_kaiser[MIP_KAISER_TAPS];
+static std::once_flag mip_tablesOnce;
+
+static float R_BesselI0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 16; k++)
+	{
+		float t = x / (2.0f * k);
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+static void R_InitMipTables()
+{
+	for (int i = 0; i < 256; i++)
+	{
+		float c = i / 255.0f;
+		mip_toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+	}
+	for (int i = 0; i < MIP_SRGB_STEPS; i++)
+	{
+		float l = i / (float)(MIP_SRGB_STEPS - 1);
+		float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+		mip_toSrgb[i] = (unsigned char)(c * 255.0f + 0.5f);
+	}
+
+	// sinc stretched for a 2:1 reduction, windowed over 4 source pixels
+	// each side; taps sit at -3.5 .. 3.5 from the destination centre
+	const float beta = 4.0f;
+	const float pi = 3.14159265f;
+	float sum = 0.0f;
+	for (int k = 0; k < MIP_KAISER_TAPS; k++)
+	{
+		float d = k - 3.5f;
+		float x = pi * d * 0.5f;
+		float r = d / 4.0f;
+		mip_kaiser[k] = sinf(x) / x * R_BesselI0(beta * sqrtf(1.0f - r * r)) / R_BesselI0(beta);
+		sum += mip_kaiser[k];
+	}
+	for (int k = 0; k < MIP_KAISER_TAPS; k++)
+		mip_kaiser[k] /= sum;
+}
+
+static void R_BoxRows(const mipJob_t* job)
+{
+	const mipLevel_t* src = job->src;
+	mipLevel_t* dst = job->dst;
+	for (int y = job->firstRow; y < job->firstRow + job->numRows; y++)
+	{
+		int y1 = 2 * y + 1 < src->height ? 2 * y + 1 : src->height - 1;
+		const float* r0 = src->pixels + 2 * y * src->width * 4;
+		const float* r1 = src->pixels + y1 * src->width * 4;
+		float* out = dst->pixels + y * dst->width * 4;
+		for (int x = 0; x < dst->width; x++, out += 4)
+		{
+			int x0 = 2 * x * 4;
+			int x1 = (2 * x + 1 < src->width ? 2 * x + 1 : src->width - 1) * 4;
+#ifdef MIP_USE_SSE
+			__m128 s = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(r0 + x0), _mm_loadu_ps(r0 + x1)),
+				_mm_add_ps(_mm_loadu_ps(r1 + x0), _mm_loadu_ps(r1 + x1)));
+			_mm_storeu_ps(out, _mm_mul_ps(s, _mm_set1_ps(0.25f)));
+#else
+			for (int c = 0; c < 4; c++)
+				out[c] = 0.25f * (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c]);
+#endif
+		}
+	}
+}
+
+// rows of the source into temp
+static void R_KaiserRowsH(const mipJob_t* job)
+{
+	const mipLevel_t* src = job->src;
+	int width = job->dst->width;
+	for (int y = job->firstRow; y < job->firstRow + job->numRows; y++)
+	{
+		const float* row = src->pixels + y * src->width * 4;
+		float* out = job->temp + y * width * 4;
+		for (int x = 0; x < width; x++, out += 4)
+		{
+#ifdef MIP_USE_SSE
+			__m128 acc = _mm_setzero_ps();
+#else
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+#endif
+			for (int k = 0; k < MIP_KAISER_TAPS; k++)
+			{
+				int sx = 2 * x - 3 + k;
+				sx = sx < 0 ? 0 : (sx < src->width ? sx : src->width - 1);
+#ifdef MIP_USE_SSE
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(row + sx * 4), _mm_set1_ps(mip_kaiser[k])));
+#else
+				for (int c = 0; c < 4; c++)
+					acc[c] += row[sx * 4 + c] * mip_kaiser[k];
+#endif
+			}
+#ifdef MIP_USE_SSE
+			_mm_storeu_ps(out, acc);
+#else
+			memcpy(out, acc, sizeof(acc));
+#endif
+		}
+	}
+}
+
+// rows of the destination from temp
+static void R_KaiserRowsV(const mipJob_t* job)
+{
+	mipLevel_t* dst = job->dst;
+	int height = job->src->height;
+	for (int y = job->firstRow; y < job->firstRow + job->numRows; y++)
+	{
+		float* out = dst->pixels + y * dst->width * 4;
+		for (int x = 0; x < dst->width; x++, out += 4)
+		{
+#ifdef MIP_USE_SSE
+			__m128 acc = _mm_setzero_ps();
+#else
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+#endif
+			for (int k = 0; k < MIP_KAISER_TAPS; k++)
+			{
+				int sy = 2 * y - 3 + k;
+				sy = sy < 0 ? 0 : (sy < height ? sy : height - 1);
+				const float* p = job->temp + (sy * dst->width + x) * 4;
+#ifdef MIP_USE_SSE
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(mip_kaiser[k])));
+#else
+				for (int c = 0; c < 4; c++)
+					acc[c] += p[c] * mip_kaiser[k];
+#endif
+			}
+#ifdef MIP_USE_SSE
+			_mm_storeu_ps(out, acc);
+#else
+			memcpy(out, acc, sizeof(acc));
+#endif
+		}
+	}
+}
+
+static unsigned int R_MipThread(void* parms)
+{
+	mipJob_t* job = (mipJob_t*)parms;
+	job->func(job);
+	return 0;
+}
+
+// the first band runs on the calling thread
+static void R_RunBands(void (*func)(const mipJob_t*), const mipLevel_t* src, mipLevel_t* dst, float* temp, int rows)
+{
+	int maxJobs = Sys_GetNumCpus();
+	maxJobs = maxJobs < MIP_MAX_THREADS ? maxJobs : MIP_MAX_THREADS;
+	int numJobs = rows / MIP_THREAD_ROWS;
+	numJobs = numJobs < maxJobs ? numJobs : maxJobs;
+	numJobs = numJobs > 1 ? numJobs : 1;
+	int band = (rows + numJobs - 1) / numJobs;
+
+	mipJob_t jobs[MIP_MAX_THREADS];
+	for (int j = 0; j < numJobs; j++)
+	{
+		jobs[j].func = func;
+		jobs[j].src = src;
+		jobs[j].dst = dst;
+		jobs[j].temp = temp;
+		jobs[j].firstRow = j * band;
+		jobs[j].numRows = rows - jobs[j].firstRow < band ? rows - jobs[j].firstRow : band;
+	}
+
+	for (int j = 1; j < numJobs; j++)
+		Sys_CreateThread(R_MipThread, &jobs[j], jobs[j].thread, "mip filter");
+	func(&jobs[0]);
+	for (int j = 1; j < numJobs; j++)
+		Sys_JoinThread(jobs[j].thread);
+}
+
+static void R_LevelFromImage(const Image& image, mipLevel_t& level, bool gamma)
+{
+	int bpp = image._elementSize;
+	int numPixels = level.width * level.height;
+	const unsigned char* p = (const unsigned char*)image.GetLevel(0);
+	float* out = level.pixels;
+	for (int i = 0; i < numPixels; i++, p += bpp, out += 4)
+	{
+		for (int c = 0; c < 3; c++)
+			out[c] = gamma ? mip_toLinear[p[c]] : p[c] / 255.0f;
+		out[3] = bpp == 4 ? p[3] / 255.0f : 1.0f;
+	}
+}
+
+static unsigned char* R_LevelToBytes(const mipLevel_t& level, int bpp, bool gamma, float alphaScale)
+{
+	int numPixels = level.width * level.height;
+	unsigned char* bytes = new unsigned char[numPixels * bpp];
+	const float* p = level.pixels;
+	unsigned char* out = bytes;
+	for (int i = 0; i < numPixels; i++, p += 4, out += bpp)
+	{
+		// the kaiser lobes overshoot
+		for (int c = 0; c < 3; c++)
+		{
+			float v = p[c] < 0.0f ? 0.0f : (p[c] > 1.0f ? 1.0f : p[c]);
+			out[c] = gamma ? mip_toSrgb[(int)(v * (MIP_SRGB_STEPS - 1) + 0.5f)] : (unsigned char)(v * 255.0f + 0.5f);
+		}
+		if (bpp == 4)
+		{
+			float a = p[3] * alphaScale;
+			a = a < 0.0f ? 0.0f : (a > 1.0f ? 1.0f : a);
+			out[3] = (unsigned char)(a * 255.0f + 0.5f);
+		}
+	}
+	return bytes;
+}
+
+static bool R_IsCutout(const mipLevel_t& level)
+{
+	int numPixels = level.width * level.height;
+	int binary = 0;
+	int opaque = 0;
+	for (int i = 0; i < numPixels; i++)
+	{
+		float a = level.pixels[i * 4 + 3];
+		binary += a < 0.02f || a > 0.98f;
+		opaque += a > 0.98f;
+	}
+	return opaque < numPixels && binary >= numPixels * MIP_CUTOUT_SHARE;
+}
+
+static float R_AlphaCoverage(const mipLevel_t& level, float ref, float scale)
+{
+	int numPixels = level.width * level.height;
+	int passed = 0;
+	for (int i = 0; i < numPixels; i++)
+		passed += level.pixels[i * 4 + 3] * scale > ref;
+	return passed / (float)numPixels;
+}
+
+// the alpha scale that lets the top level's share of pixels pass
+static float R_CoverageScale(const mipLevel_t& level, float ref, float coverage)
+{
+	float lo = 0.0f;
+	float hi = 4.0f;
+	for (int i = 0; i < 10; i++)
+	{
+		float mid = (lo + hi) * 0.5f;
+		if (R_AlphaCoverage(level, ref, mid) < coverage)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return (lo + hi) * 0.5f;
+}
+
+bool R_CanGenerateMipmaps(const Image& image)
+{
+	if (image.IsCompressed() || image.IsCubeMap() || image.IsVolume() || image._type != GL_UNSIGNED_BYTE)
+		return false;
+	if (image._levelCount != 1 || image._data.size() != 1 || (image._width <= 1 && image._height <= 1))
+		return false;
+
+	switch (image._format)
+	{
+	case GL_RGB:
+	case GL_BGR:
+		return image._elementSize == 3;
+	case GL_RGBA:
+	case GL_BGRA:
+		return image._elementSize == 4;
+	}
+	return false;
+}
+
+bool R_GenerateMipmaps(Image& image, const mipSettings_t& settings)
+{
+	if (settings.filter == MIP_FILTER_NONE || !R_CanGenerateMipmaps(image))
+		return false;
+	std::call_once(mip_tablesOnce, R_InitMipTables);
+
+	int bpp = image._elementSize;
+	mipLevel_t src;
+	src.width = image._width;
+	src.height = image._height;
+	src.pixels = new float[src.width * src.height * 4];
+	R_LevelFromImage(image, src, settings.gamma);
+
+	bool cutout = bpp == 4 && settings.alphaRef > 0.0f && R_IsCutout(src);
+	float coverage = cutout ? R_AlphaCoverage(src, settings.alphaRef, 1.0f) : 0.0f;
+
+	int levels = 1;
+	while (src.width > 1 || src.height > 1)
+	{
+		mipLevel_t dst;
+		dst.width = src.width > 1 ? src.width >> 1 : 1;
+		dst.height = src.height > 1 ? src.height >> 1 : 1;
+		dst.pixels = new float[dst.width * dst.height * 4];
+
+		if (settings.filter == MIP_FILTER_KAISER)
+		{
+			float* temp = new float[dst.width * src.height * 4];
+			R_RunBands(R_KaiserRowsH, &src, &dst, temp, src.height);
+			R_RunBands(R_KaiserRowsV, &src, &dst, temp, dst.height);
+			delete [] temp;
+		}
+		else
+			R_RunBands(R_BoxRows, &src, &dst, NULL, dst.height);
+
+		// later levels filter the unscaled alpha
+		float scale = cutout ? R_CoverageScale(dst, settings.alphaRef, coverage) : 1.0f;
+		image._data.push_back(R_LevelToBytes(dst, bpp, settings.gamma, scale));
+		levels++;
+
+		delete [] src.pixels;
+		src = dst;
+	}
+	delete [] src.pixels;
+
+	image._levelCount = levels;
+	return true;
+}
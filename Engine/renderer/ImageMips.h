@@ -0,0 +1,46 @@
+#ifndef __IMAGEMIPS_H__
+#define __IMAGEMIPS_H__
+
+/*
+===============================================================================
+
+	Mipmap generation
+
+	Builds the full chain of an 8 bit rgb(a) image down to 1x1. Levels are
+	filtered in float from the previous float level, not from its 8 bit
+	copy, with a 2x2 box or an 8 tap Kaiser windowed sinc; with gamma on
+	the colour channels are filtered in linear space and stored as srgb
+	again. Each pixel is one SSE register. Cutout images (alpha mostly 0 or
+	255) get their alpha scaled per level so the share of pixels passing the
+	alpha test stays what it is at the top level, which keeps foliage from
+	thinning out in the distance. Large levels are split into row bands
+	filtered on several threads.
+
+===============================================================================
+*/
+
+#define MIP_GENERATOR_VERSION	1		// bump when the output changes, it keys the cache
+
+typedef enum
+{
+	MIP_FILTER_NONE,
+	MIP_FILTER_BOX,
+	MIP_FILTER_KAISER
+}mipFilter_t;
+
+typedef struct
+{
+	mipFilter_t filter;
+	bool gamma;				// colour channels are srgb
+	float alphaRef;			// alpha test reference the coverage is kept for
+}mipSettings_t;
+
+class Image;
+
+// 2d 8 bit GL_RGB / GL_BGR / GL_RGBA / GL_BGRA images with one level
+bool	R_CanGenerateMipmaps(const Image& image);
+
+// appends the levels below the first, false leaves the image untouched
+bool	R_GenerateMipmaps(Image& image, const mipSettings_t& settings);
+
+#endif
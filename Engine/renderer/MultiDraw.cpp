@@ -0,0 +1,142 @@
+#include "MultiDraw.h"
+#include "GpuMemory.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+}drawElementsIndirectCommand_t;
+
+typedef struct
+{
+	int submissions;
+	int draws;
+}multiDrawStats_t;
+
+static const char* md_pathNames[] = { "off", "multi draw base vertex", "multi draw indirect" };
+
+static bool md_initialized = false;
+static bool md_enabled = true;
+static multiDrawPath_t md_supported = MULTIDRAW_NONE;
+static GLuint md_indirectBuffer = 0;
+static GLuint md_drawBuffer = 0;
+static GLuint md_layerBuffer = 0;
+static multiDrawStats_t md_stats;
+
+static drawElementsIndirectCommand_t md_commands[MULTIDRAW_MAX_DRAWS];
+static GLsizei md_counts[MULTIDRAW_MAX_DRAWS];
+static const GLvoid* md_offsets[MULTIDRAW_MAX_DRAWS];
+static GLint md_baseVertices[MULTIDRAW_MAX_DRAWS];
+
+static void R_MultiDraw_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetMultiDraw(atoi(argv[1]) != 0);
+	Sys_Printf("multi draw: %s, %d submissions for %d draws\n",
+		md_pathNames[R_MultiDrawPath()], md_stats.submissions, md_stats.draws);
+}
+
+static void R_InitMultiDraw()
+{
+	md_initialized = true;
+	Cmd_AddCommand("multidraw", R_MultiDraw_f, "multi draw stats, multidraw 0/1 toggles merging draws");
+
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	if (extensions == NULL)
+		return;
+	// the per draw data needs both, the indirect buffer is optional
+	if (strstr(extensions, "GL_ARB_shader_draw_parameters") == NULL
+		|| strstr(extensions, "GL_ARB_shader_storage_buffer_object") == NULL)
+		return;
+	md_supported = strstr(extensions, "GL_ARB_multi_draw_indirect") != NULL ? MULTIDRAW_INDIRECT : MULTIDRAW_DIRECT;
+	Sys_Printf("multi draw: %s\n", md_pathNames[md_supported]);
+}
+
+multiDrawPath_t R_MultiDrawPath()
+{
+	if (!md_initialized)
+		R_InitMultiDraw();
+	return md_enabled ? md_supported : MULTIDRAW_NONE;
+}
+
+void R_SetMultiDraw(bool enable)
+{
+	md_enabled = enable;
+}
+
+// orphans the buffer every submission, the driver renames it
+static void R_StreamBuffer(GLuint& buffer, GLenum target, const void* data, int size)
+{
+	if (buffer == 0)
+		glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, data, GL_STREAM_DRAW);
+	R_GpuMemDelete(GL_BUFFER, buffer);
+	R_GpuMemAlloc(GL_BUFFER, buffer, GPUMEM_STAGING, size);
+	glCounters.uploadBytes += size;
+}
+
+static void RB_SubmitDraws(const srfTriangles_t* const* tris, const mat4* mvps, const int* layers, int count)
+{
+	R_StreamBuffer(md_drawBuffer, GL_SHADER_STORAGE_BUFFER, mvps, count * sizeof(mat4));
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MULTIDRAW_DRAW_BINDING, md_drawBuffer);
+	if (layers != NULL)
+	{
+		R_StreamBuffer(md_layerBuffer, GL_SHADER_STORAGE_BUFFER, layers, count * sizeof(int));
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MULTIDRAW_LAYER_BINDING, md_layerBuffer);
+	}
+
+	if (md_supported == MULTIDRAW_INDIRECT)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			drawElementsIndirectCommand_t& cmd = md_commands[i];
+			cmd.count = tris[i]->numIndexes;
+			cmd.instanceCount = 1;
+			cmd.firstIndex = tris[i]->indexRange.offset;
+			cmd.baseVertex = tris[i]->vertexRange.offset;
+			cmd.baseInstance = 0;
+		}
+		R_StreamBuffer(md_indirectBuffer, GL_DRAW_INDIRECT_BUFFER, md_commands, count * sizeof(drawElementsIndirectCommand_t));
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, count, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else
+	{
+		for (int i = 0; i < count; i++)
+		{
+			md_counts[i] = tris[i]->numIndexes;
+			md_offsets[i] = (const GLvoid*)(size_t)(tris[i]->indexRange.offset * sizeof(glIndex_t));
+			md_baseVertices[i] = tris[i]->vertexRange.offset;
+		}
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, md_counts, GL_UNSIGNED_SHORT, md_offsets, count, md_baseVertices);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glCounters.drawCalls++;
+	md_stats.submissions++;
+	md_stats.draws += count;
+}
+
+void RB_MultiDrawTriangles(const srfTriangles_t* const* tris, const mat4* mvps, const int* layers, int count)
+{
+	for (int first = 0; first < count; first += MULTIDRAW_MAX_DRAWS)
+	{
+		int n = count - first < MULTIDRAW_MAX_DRAWS ? count - first : MULTIDRAW_MAX_DRAWS;
+		RB_SubmitDraws(tris + first, mvps + first, layers != NULL ? layers + first : NULL, n);
+	}
+}
+
+void R_ShutdownMultiDraw()
+{
+	R_DeleteBuffer(md_indirectBuffer);
+	R_DeleteBuffer(md_drawBuffer);
+	R_DeleteBuffer(md_layerBuffer);
+}
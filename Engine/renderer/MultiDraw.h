@@ -0,0 +1,54 @@
+#ifndef __MULTIDRAW_H__
+#define __MULTIDRAW_H__
+
+#include "../r_public.h"
+
+#define MULTIDRAW_KEYWORD		"MULTIDRAW"
+#define MULTIDRAW_MAX_DRAWS		1024		// per submission
+#define MULTIDRAW_DRAW_BINDING	0			// shader storage binding of the per draw data
+#define MULTIDRAW_LAYER_BINDING	1			// and of the texture array layers
+
+/*
+===============================================================================
+
+	Multi draw submission
+
+	Consecutive surfaces of a draw list with the same program, texture and
+	geometry arena blocks go out as one submission. Their ranges become
+	the commands of an indirect buffer for glMultiDrawElementsIndirect, and
+	their model view projections are written in the same order into a
+	shader storage buffer, which the vertex shader indexes with
+	gl_DrawIDARB. Contexts without indirect draws but with draw ids use
+	glMultiDrawElementsBaseVertex with the same storage buffer; without
+	draw ids and storage buffers the surfaces are drawn one by one.
+
+	A material takes part by declaring the MULTIDRAW keyword and reading
+	its WVP from the storage buffer under #ifdef MULTIDRAW (see
+	positiontex.mtr); that variant gets the "#version 430 compatibility"
+	header. Materials without it, and runs of a single surface, use the
+	regular draw. Surfaces with different layers of a texture array page
+	(see TextureArray.h) also share a submission, their layers go into a
+	second storage buffer.
+
+===============================================================================
+*/
+
+typedef enum
+{
+	MULTIDRAW_NONE,			// one draw per surface
+	MULTIDRAW_DIRECT,		// glMultiDrawElementsBaseVertex
+	MULTIDRAW_INDIRECT		// glMultiDrawElementsIndirect
+}multiDrawPath_t;
+
+// the path the context supports, and is enabled
+multiDrawPath_t	R_MultiDrawPath();
+void			R_SetMultiDraw(bool enable);
+
+// draws the surfaces' ranges of the bound arena buffers with the bound
+// program, mvps[i] and layers[i] belong to tris[i]; layers is NULL
+// unless the program samples a texture array
+void			RB_MultiDrawTriangles(const srfTriangles_t* const* tris, const mat4* mvps, const int* layers, int count);
+
+void			R_ShutdownMultiDraw();
+
+#endif
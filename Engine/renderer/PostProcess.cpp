@@ -0,0 +1,275 @@
+#include "PostProcess.h"
+#include "draw_common.h"
+#include "../Shader.h"
+#include "../ShaderSource.h"
+#include "../RenderTexture.h"
+#include "../sys/sys_public.h"
+
+static const char* effectNames[] = 
+{
+	"blur",
+	"outline",
+	"tonemap",
+	"fxaa",
+};
+
+PostProcess::PostProcess():_numEffects(0),
+	_numPasses(0),
+	_lastNumPasses(0),
+	_copyShader(NULL),
+	_blurScale(0.5f),
+	_exposure(1.f)
+{
+	for (int i = 0; i < ePost_Count; i++)
+		_shaders[i] = NULL;
+
+	_outlineColor[0] = 0.f;
+	_outlineColor[1] = 0.f;
+	_outlineColor[2] = 0.f;
+}
+
+PostProcess::~PostProcess()
+{
+	delete _copyShader;
+	for (int i = 0; i < ePost_Count; i++)
+		delete _shaders[i];
+}
+
+Shader* PostProcess::LoadShader( const char* name, const char* frag )
+{
+	Shader* shader = new Shader;
+	shader->LoadFromBuffer(post_vert, frag);
+	shader->SetName(name);
+	shader->GetUniformLocation(eUniform_Samper0);
+	shader->GetUniformLocation(eUniform_TexelSize);
+	shader->GetUniformLocation(eUniform_Direction);
+	shader->GetUniformLocation(eUniform_Color);
+	shader->GetUniformLocation(eUniform_Exposure);
+	GL_CheckError(name);
+	return shader;
+}
+
+bool PostProcess::Init()
+{
+	_copyShader = LoadShader("post_copy", post_copy_frag);
+	_shaders[ePost_Blur] = LoadShader("post_blur", post_blur_frag);
+	_shaders[ePost_Outline] = LoadShader("post_outline", post_outline_frag);
+	_shaders[ePost_Tonemap] = LoadShader("post_tonemap", post_tonemap_frag);
+	_shaders[ePost_Fxaa] = LoadShader("post_fxaa", post_fxaa_frag);
+
+	for (int i = 0; i < ePost_Count; i++)
+	{
+		if (_shaders[i]->GetProgarm() == 0)
+		{
+			Sys_Printf("post process: %s shader failed\n", effectNames[i]);
+			return false;
+		}
+	}
+	return _copyShader->GetProgarm() != 0;
+}
+
+void PostProcess::Push( postEffect_t effect )
+{
+	if (_numEffects >= MAX_POST_EFFECTS)
+	{
+		Sys_Printf("post process: too many effects\n");
+		return;
+	}
+	_effects[_numEffects++] = effect;
+}
+
+void PostProcess::Remove( postEffect_t effect )
+{
+	int n = 0;
+	for (int i = 0; i < _numEffects; i++)
+	{
+		if (_effects[i] != effect)
+			_effects[n++] = _effects[i];
+	}
+	_numEffects = n;
+}
+
+void PostProcess::Clear()
+{
+	_numEffects = 0;
+}
+
+void PostProcess::BeginFrame()
+{
+	_lastNumPasses = _numPasses;
+	_numPasses = 0;
+}
+
+void PostProcess::SetBlurScale( float scale )
+{
+	_blurScale = scale < 0.25f ? 0.25f : (scale > 1.f ? 1.f : scale);
+}
+
+void PostProcess::SetOutlineColor( float r, float g, float b )
+{
+	_outlineColor[0] = r;
+	_outlineColor[1] = g;
+	_outlineColor[2] = b;
+}
+
+GLenum PostProcess::GetSceneFormat()
+{
+	for (int i = 0; i < _numEffects; i++)
+	{
+		if (_effects[i] == ePost_Tonemap)
+			return GL_RGBA16F;
+	}
+	return GL_RGBA8;
+}
+
+void PostProcess::AddCopyPass( RenderGraph* graph, const char* name, rgResource_t src, rgResource_t dst )
+{
+	AddPass(graph, name, ePost_Count, _copyShader, src, dst, 0.f, 0.f);
+}
+
+void PostProcess::Setup( RenderGraph* graph, rgResource_t scene, rgResource_t output )
+{
+	renderTargetDesc_t full = graph->GetDesc(scene);
+	full.depth = false;
+
+	rgResource_t src = scene;
+	for (int i = 0; i < _numEffects; i++)
+	{
+		postEffect_t effect = _effects[i];
+		bool last = (i == _numEffects - 1);
+
+		if (effect == ePost_Blur)
+		{
+			renderTargetDesc_t desc = full;
+			desc.width = (int)(full.width * _blurScale);
+			desc.height = (int)(full.height * _blurScale);
+			if (desc.width < 1) desc.width = 1;
+			if (desc.height < 1) desc.height = 1;
+
+			// the horizontal pass also does the downsample
+			rgResource_t h = graph->CreateTexture("blur_h", desc);
+			src = AddPass(graph, "blur_h", effect, _shaders[effect], src, h, 1.f, 0.f);
+			rgResource_t v = graph->CreateTexture("blur_v", desc);
+			src = AddPass(graph, "blur_v", effect, _shaders[effect], src, v, 0.f, 1.f);
+
+			if (last)
+				AddPass(graph, "post_copy", ePost_Count, _copyShader, src, output, 0.f, 0.f);
+			continue;
+		}
+
+		// everything after the tonemap is in display range
+		if (effect == ePost_Tonemap)
+			full.format = GL_RGBA8;
+
+		rgResource_t dst = last ? output : graph->CreateTexture(effectNames[effect], full);
+		src = AddPass(graph, effectNames[effect], effect, _shaders[effect], src, dst, 0.f, 0.f);
+	}
+}
+
+rgResource_t PostProcess::AddPass( RenderGraph* graph, const char* name, postEffect_t effect, Shader* shader, 
+	rgResource_t src, rgResource_t dst, float dirX, float dirY )
+{
+	// slots are handed out in order; a slot that was idle or ran another
+	// pass last frame would report that pass's time for a few frames
+	int slot = _numPasses++;
+	postPass_t* pass = &_passes[slot];
+	if (slot >= _lastNumPasses || pass->name != name)
+		pass->timer.Reset();
+	pass->owner = this;
+	pass->name = name;
+	pass->effect = effect;
+	pass->shader = shader;
+	pass->src = src;
+	pass->dir[0] = dirX;
+	pass->dir[1] = dirY;
+
+	// blur offsets are in output texels, the rest sample their input 1:1
+	const renderTargetDesc_t& desc = graph->GetDesc(effect == ePost_Blur ? dst : src);
+	pass->texelSize[0] = 1.f / desc.width;
+	pass->texelSize[1] = 1.f / desc.height;
+
+	int p = graph->AddPass(name, PostPass, pass);
+	graph->Read(p, src);
+	graph->Write(p, dst);
+	return dst;
+}
+
+void PostProcess::PostPass( RenderGraph* graph, void* data )
+{
+	postPass_t* pass = (postPass_t*)data;
+	PostProcess* self = pass->owner;
+	Shader* shader = pass->shader;
+	RenderTexture* src = graph->GetTexture(pass->src);
+	if (src == NULL)
+		return;
+
+	pass->timer.Begin();
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(shader->GetProgarm());
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, src->GetName());
+	glUniform1i(shader->GetUniform(eUniform_Samper0), 0);
+
+	switch (pass->effect)
+	{
+	case ePost_Blur:
+		glUniform2fv(shader->GetUniform(eUniform_TexelSize), 1, pass->texelSize);
+		glUniform2fv(shader->GetUniform(eUniform_Direction), 1, pass->dir);
+		break;
+	case ePost_Outline:
+		glUniform2fv(shader->GetUniform(eUniform_TexelSize), 1, pass->texelSize);
+		glUniform3fv(shader->GetUniform(eUniform_Color), 1, self->_outlineColor);
+		break;
+	case ePost_Tonemap:
+		glUniform1f(shader->GetUniform(eUniform_Exposure), self->_exposure);
+		break;
+	case ePost_Fxaa:
+		glUniform2fv(shader->GetUniform(eUniform_TexelSize), 1, pass->texelSize);
+		break;
+	default:
+		break;
+	}
+
+	RB_DrawFullscreenQuad();
+
+	glEnable(GL_DEPTH_TEST);
+
+	pass->timer.End();
+	GL_CheckError(pass->name);
+}
+
+const char* PostProcess::GetPassName( int pass )
+{
+	if (pass < 0 || pass >= _numPasses)
+		return NULL;
+	return _passes[pass].name;
+}
+
+double PostProcess::GetPassTime( int pass )
+{
+	if (pass < 0 || pass >= _numPasses)
+		return 0.0;
+	return _passes[pass].timer.GetMs();
+}
+
+void PostProcess::PrintStats()
+{
+	double total = 0.0;
+	Sys_Printf("post process: %d passes\n", _numPasses);
+	for (int i = 0; i < _numPasses; i++)
+	{
+		Sys_Printf("  %-12s %.3f ms\n", _passes[i].name, _passes[i].timer.GetMs());
+		total += _passes[i].timer.GetMs();
+	}
+	Sys_Printf("  total        %.3f ms\n", total);
+}
+
+const char* PostProcess::GetEffectName( postEffect_t effect )
+{
+	if (effect < 0 || effect >= ePost_Count)
+		return "copy";
+	return effectNames[effect];
+}
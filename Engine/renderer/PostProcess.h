@@ -0,0 +1,120 @@
+#ifndef __POSTPROCESS_H__
+#define __POSTPROCESS_H__
+
+#include "RenderGraph.h"
+#include "GpuTimer.h"
+
+class Shader;
+
+typedef enum
+{
+	ePost_Blur,
+	ePost_Outline,
+	ePost_Tonemap,
+	ePost_Fxaa,
+
+	ePost_Count,
+}postEffect_t;
+
+#define MAX_POST_EFFECTS 8
+#define MAX_POST_PASSES (MAX_POST_EFFECTS * 2 + 1)
+
+/*
+===============================================================================
+
+	Post processing stack
+
+	Effects run in the order they were pushed, each as one or more full
+	screen passes in the render graph. Every pass reads the previous output
+	and writes a new transient target, so the pool ping-pongs between two
+	targets of each size and format and nothing is allocated once the stack
+	has run for a frame. The blur is separable and runs at a reduced size.
+
+===============================================================================
+*/
+class PostProcess
+{
+public:
+	PostProcess();
+	~PostProcess();
+
+	bool Init();
+
+	void Push(postEffect_t effect);
+
+	void Remove(postEffect_t effect);
+
+	void Clear();
+
+	bool IsActive() { return _numEffects > 0; }
+
+	// 0.5 or 0.25 of the screen
+	void SetBlurScale(float scale);
+
+	void SetExposure(float exposure) { _exposure = exposure; }
+
+	void SetOutlineColor(float r, float g, float b);
+
+	// the scene is rendered in float when it still has to be tonemapped
+	GLenum GetSceneFormat();
+
+	// forget last frame's passes, every frame before Setup or AddCopyPass,
+	// so a frame without post passes counts none
+	void BeginFrame();
+
+	// declare the passes that turn scene into output
+	void Setup(RenderGraph* graph, rgResource_t scene, rgResource_t output);
+
+	// bilinear copy, used to upscale a reduced size scene
+	void AddCopyPass(RenderGraph* graph, const char* name, rgResource_t src, rgResource_t dst);
+
+	int GetNumPasses() { return _numPasses; }
+
+	const char* GetPassName(int pass);
+
+	// gpu time of the pass, a few frames old
+	double GetPassTime(int pass);
+
+	void PrintStats();
+
+	static const char* GetEffectName(postEffect_t effect);
+
+private:
+	typedef struct
+	{
+		PostProcess* owner;
+		const char* name;
+		postEffect_t effect;
+		Shader* shader;
+		rgResource_t src;
+		float texelSize[2];
+		float dir[2];
+		GpuTimer timer;		// reset when the slot gets another pass
+	}postPass_t;
+
+	// returns dst so passes can be chained
+	rgResource_t AddPass(RenderGraph* graph, const char* name, postEffect_t effect, Shader* shader,
+		rgResource_t src, rgResource_t dst, float dirX, float dirY);
+
+	static void PostPass(RenderGraph* graph, void* data);
+
+
+	static Shader* LoadShader(const char* name, const char* frag);
+
+private:
+	postEffect_t _effects[MAX_POST_EFFECTS];
+	int _numEffects;
+
+	postPass_t _passes[MAX_POST_PASSES];
+	int _numPasses;
+	int _lastNumPasses;
+
+	Shader* _copyShader;
+	Shader* _shaders[ePost_Count];
+
+	float _blurScale;
+	float _exposure;
+	float _outlineColor[3];
+};
+
+#endif
@@ -0,0 +1,230 @@
+#include "ProgramCache.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGRAM_CACHE_MAGIC 0x42504c46	// "FLPB"
+
+typedef struct
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int key[2];
+	unsigned int vertLength;
+	unsigned int fragLength;
+	unsigned int format;
+	unsigned int length;
+}programCacheHeader_t;
+
+typedef struct
+{
+	int hits;
+	int misses;
+	int rejected;		// binaries the driver didn't take any more
+	int stored;
+}programCacheStats_t;
+
+static bool cache_initialized = false;
+static bool cache_enabled = false;
+static char cache_dir[256];
+static unsigned long long cache_driverHash = 0;
+static programCacheStats_t cache_stats;
+
+// fnv-1a, 64 bit
+static unsigned long long GL_HashString(unsigned long long h, const char* s)
+{
+	if (s == NULL)
+		s = "";
+	for (; *s; s++)
+		h = (h ^ (unsigned char)*s) * 1099511628211ull;
+	// separator so "ab" + "c" and "a" + "bc" differ
+	return (h ^ 0xff) * 1099511628211ull;
+}
+
+static unsigned long long GL_ProgramKey(const char* vert, const char* frag)
+{
+	unsigned long long h = cache_driverHash;
+	h = GL_HashString(h, vert);
+	h = GL_HashString(h, frag);
+	return h;
+}
+
+static void GL_ProgramCachePath(char* path, unsigned long long key)
+{
+	sprintf(path, "%s/%08x%08x.bin", cache_dir, (unsigned int)(key >> 32), (unsigned int)key);
+}
+
+static void GL_ProgramCache_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		GL_SetProgramCacheEnable(atoi(argv[1]) != 0);
+	GL_PrintProgramCacheStats();
+}
+
+void GL_InitProgramCache(const char* directory)
+{
+	cache_initialized = true;
+	strncpy(cache_dir, directory, sizeof(cache_dir) - 1);
+	Cmd_AddCommand("progcache", GL_ProgramCache_f, "program binary cache stats, progcache 0/1 toggles it");
+
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	cache_enabled = formats > 0;
+	if (!cache_enabled)
+	{
+		Sys_Printf("program cache: driver has no binary formats, disabled\n");
+		return;
+	}
+
+	char version[32];
+	sprintf(version, "%d", PROGRAM_CACHE_VERSION);
+	unsigned long long h = 14695981039346656037ull;
+	h = GL_HashString(h, (const char*)glGetString(GL_VENDOR));
+	h = GL_HashString(h, (const char*)glGetString(GL_RENDERER));
+	h = GL_HashString(h, (const char*)glGetString(GL_VERSION));
+	cache_driverHash = GL_HashString(h, version);
+
+	// both levels, the default directory is nested
+	char path[256];
+	strcpy(path, cache_dir);
+	for (char* s = path; *s; s++)
+	{
+		if (*s == '/')
+		{
+			*s = '\0';
+			Sys_Mkdir(path);
+			*s = '/';
+		}
+	}
+	Sys_Mkdir(path);
+
+	Sys_Printf("program cache: %s\n", cache_dir);
+}
+
+bool GL_IsProgramCacheEnabled()
+{
+	if (!cache_initialized)
+		GL_InitProgramCache(PROGRAM_CACHE_DIR);
+	return cache_enabled;
+}
+
+void GL_SetProgramCacheEnable(bool enable)
+{
+	if (!cache_initialized)
+		GL_InitProgramCache(PROGRAM_CACHE_DIR);
+
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	cache_enabled = enable && formats > 0;
+}
+
+GLuint GL_LoadCachedProgram(const char* vert, const char* frag)
+{
+	if (!GL_IsProgramCacheEnabled())
+		return 0;
+
+	unsigned long long key = GL_ProgramKey(vert, frag);
+	char path[320];
+	GL_ProgramCachePath(path, key);
+
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		cache_stats.misses++;
+		return 0;
+	}
+
+	// the lengths catch the unlikely hash collision
+	programCacheHeader_t header;
+	void* binary = NULL;
+	bool valid = fread(&header, sizeof(header), 1, f) == 1
+		&& header.magic == PROGRAM_CACHE_MAGIC
+		&& header.version == PROGRAM_CACHE_VERSION
+		&& header.key[0] == (unsigned int)key && header.key[1] == (unsigned int)(key >> 32)
+		&& header.vertLength == strlen(vert) && header.fragLength == strlen(frag)
+		&& header.length > 0;
+	if (valid)
+	{
+		binary = malloc(header.length);
+		valid = fread(binary, header.length, 1, f) == 1;
+	}
+	fclose(f);
+
+	GLuint program = 0;
+	if (valid)
+	{
+		program = glCreateProgram();
+		glProgramBinary(program, header.format, binary, header.length);
+
+		GLint linkStatus = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if (linkStatus != GL_TRUE)
+		{
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	free(binary);
+
+	if (program == 0)
+	{
+		cache_stats.rejected++;
+		remove(path);
+		return 0;
+	}
+
+	cache_stats.hits++;
+	return program;
+}
+
+void GL_StoreCachedProgram(GLuint program, const char* vert, const char* frag)
+{
+	if (program == 0 || !GL_IsProgramCacheEnabled())
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	programCacheHeader_t header;
+	void* binary = malloc(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &written, &format, binary);
+	if (written <= 0)
+	{
+		free(binary);
+		return;
+	}
+
+	unsigned long long key = GL_ProgramKey(vert, frag);
+	header.magic = PROGRAM_CACHE_MAGIC;
+	header.version = PROGRAM_CACHE_VERSION;
+	header.key[0] = (unsigned int)key;
+	header.key[1] = (unsigned int)(key >> 32);
+	header.vertLength = strlen(vert);
+	header.fragLength = strlen(frag);
+	header.format = format;
+	header.length = written;
+
+	char path[320];
+	GL_ProgramCachePath(path, key);
+	FILE* f = fopen(path, "wb");
+	if (f != NULL)
+	{
+		fwrite(&header, sizeof(header), 1, f);
+		fwrite(binary, written, 1, f);
+		fclose(f);
+		cache_stats.stored++;
+	}
+	free(binary);
+}
+
+void GL_PrintProgramCacheStats()
+{
+	Sys_Printf("program cache %s: %d hits, %d misses, %d rejected, %d stored\n",
+		cache_enabled ? "on" : "off", cache_stats.hits, cache_stats.misses, cache_stats.rejected, cache_stats.stored);
+}
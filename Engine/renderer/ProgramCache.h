@@ -0,0 +1,34 @@
+#ifndef __PROGRAMCACHE_H__
+#define __PROGRAMCACHE_H__
+
+#include "../glutils.h"
+
+/*
+===============================================================================
+
+	Program binary cache
+
+	Linked programs are written to disk with glGetProgramBinary and loaded
+	back with glProgramBinary on the next run. Entries are keyed by the
+	shader sources and the driver strings, so an edited shader or a new
+	driver just misses and the program is compiled again; a binary the
+	driver refuses is deleted and rebuilt the same way.
+
+===============================================================================
+*/
+
+#define PROGRAM_CACHE_DIR		"cache/programs"
+#define PROGRAM_CACHE_VERSION	1		// bump when GL_LinkProgram binds differently
+
+// called on the first lookup when not called before
+void	GL_InitProgramCache(const char* directory);
+bool	GL_IsProgramCacheEnabled();
+void	GL_SetProgramCacheEnable(bool enable);
+
+// 0 when the program isn't cached or the driver refuses the binary
+GLuint	GL_LoadCachedProgram(const char* vert, const char* frag);
+void	GL_StoreCachedProgram(GLuint program, const char* vert, const char* frag);
+
+void	GL_PrintProgramCacheStats();
+
+#endif
@@ -0,0 +1,372 @@
+#include "RenderGraph.h"
+#include "../RenderTexture.h"
+#include "../sys/sys_public.h"
+#include "../framework/Profiler.h"
+
+RenderGraph::RenderGraph( RenderTargetPool* pool ) : _pool(pool),
+	_numPasses(0),
+	_backbuffer(RG_INVALID),
+	_winWidth(0),
+	_winHeight(0),
+	_numCulled(0),
+	_transientSize(0),
+	_aliasedSize(0)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	for (unsigned int i = 0; i < _passes.size(); i++)
+		delete _passes[i];
+}
+
+void RenderGraph::Reset( int winWidth, int winHeight )
+{
+	_winWidth = winWidth;
+	_winHeight = winHeight;
+
+	// pass records are kept around so a steady frame allocates nothing
+	_numPasses = 0;
+	_textures.set_used(0);
+	_order.set_used(0);
+
+	rgTexture_t backbuffer;
+	backbuffer.name = "backbuffer";
+	backbuffer.desc.width = winWidth;
+	backbuffer.desc.height = winHeight;
+	backbuffer.desc.format = GL_RGBA8;
+	backbuffer.desc.depth = true;
+	backbuffer.rt = NULL;
+	backbuffer.imported = true;
+	backbuffer.backbuffer = true;
+	backbuffer.firstUse = -1;
+	backbuffer.lastUse = -1;
+	_textures.push_back(backbuffer);
+	_backbuffer = 0;
+}
+
+rgResource_t RenderGraph::CreateTexture( const char* name, const renderTargetDesc_t& desc )
+{
+	rgTexture_t tex;
+	tex.name = name;
+	tex.desc = desc;
+	tex.rt = NULL;
+	tex.imported = false;
+	tex.backbuffer = false;
+	tex.firstUse = -1;
+	tex.lastUse = -1;
+	_textures.push_back(tex);
+	return _textures.size() - 1;
+}
+
+rgResource_t RenderGraph::ImportTexture( const char* name, RenderTexture* rt )
+{
+	renderTargetDesc_t desc;
+	desc.width = rt->_pixelsWide;
+	desc.height = rt->_pixelsHigh;
+	desc.format = rt->GetFormat();
+	desc.depth = rt->HasDepth();
+
+	rgResource_t res = CreateTexture(name, desc);
+	_textures[res].rt = rt;
+	_textures[res].imported = true;
+	return res;
+}
+
+int RenderGraph::AddPass( const char* name, RenderPassFunc func, void* data )
+{
+	if (_numPasses == (int)_passes.size())
+		_passes.push_back(new rgPass_t);
+
+	rgPass_t* pass = _passes[_numPasses];
+	pass->name = name;
+	pass->func = func;
+	pass->data = data;
+	pass->reads.set_used(0);
+	pass->writes.set_used(0);
+	pass->deps.set_used(0);
+	pass->waits.set_used(0);
+	pass->sideEffect = false;
+	pass->culled = false;
+	pass->refCount = 0;
+	return _numPasses++;
+}
+
+void RenderGraph::Read( int pass, rgResource_t res )
+{
+	if (pass < 0 || pass >= _numPasses || res < 0 || res >= (int)_textures.size())
+	{
+		Sys_Error("RenderGraph::Read: bad pass %d or resource %d\n", pass, res);
+		return;
+	}
+	_passes[pass]->reads.push_back(res);
+}
+
+void RenderGraph::Write( int pass, rgResource_t res )
+{
+	if (pass < 0 || pass >= _numPasses || res < 0 || res >= (int)_textures.size())
+	{
+		Sys_Error("RenderGraph::Write: bad pass %d or resource %d\n", pass, res);
+		return;
+	}
+	_passes[pass]->writes.push_back(res);
+
+	// writing something that lives past the frame is observable
+	if (_textures[res].imported)
+		_passes[pass]->sideEffect = true;
+}
+
+void RenderGraph::SetSideEffect( int pass )
+{
+	if (pass >= 0 && pass < _numPasses)
+		_passes[pass]->sideEffect = true;
+}
+
+static bool R_Contains(array<int>& arr, int value)
+{
+	for (unsigned int i = 0; i < arr.size(); i++)
+	{
+		if (arr[i] == value)
+			return true;
+	}
+	return false;
+}
+
+int RenderGraph::LastWriter( rgResource_t res, int before )
+{
+	for (int j = before - 1; j >= 0; j--)
+	{
+		if (R_Contains(_passes[j]->writes, res))
+			return j;
+	}
+	return -1;
+}
+
+bool RenderGraph::Compile()
+{
+	// dependencies in declaration order: a reader needs the last writer
+	// before it, a writer keeps the last writer before it and waits for the
+	// readers in between so it doesn't overwrite what they still use
+	for (int i = 0; i < _numPasses; i++)
+	{
+		rgPass_t* pass = _passes[i];
+		for (unsigned int r = 0; r < pass->reads.size(); r++)
+		{
+			int writer = LastWriter(pass->reads[r], i);
+			if (writer != -1 && !R_Contains(pass->deps, writer))
+				pass->deps.push_back(writer);
+		}
+
+		for (unsigned int w = 0; w < pass->writes.size(); w++)
+		{
+			rgResource_t res = pass->writes[w];
+			int writer = LastWriter(res, i);
+			if (writer != -1 && !R_Contains(pass->deps, writer))
+				pass->deps.push_back(writer);
+
+			for (int j = writer + 1; j < i; j++)
+			{
+				if (R_Contains(_passes[j]->reads, res) && !R_Contains(pass->waits, j))
+					pass->waits.push_back(j);
+			}
+		}
+	}
+
+	// culling: everything a side effect pass depends on stays alive
+	for (int i = 0; i < _numPasses; i++)
+		_passes[i]->culled = !_passes[i]->sideEffect;
+
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (int i = 0; i < _numPasses; i++)
+		{
+			rgPass_t* pass = _passes[i];
+			if (pass->culled)
+				continue;
+
+			for (unsigned int d = 0; d < pass->deps.size(); d++)
+			{
+				rgPass_t* dep = _passes[pass->deps[d]];
+				if (dep->culled)
+				{
+					dep->culled = false;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	// ordering: kahn's algorithm, declaration order breaks ties
+	_numCulled = 0;
+	for (int i = 0; i < _numPasses; i++)
+	{
+		rgPass_t* pass = _passes[i];
+		pass->refCount = 0;
+		if (pass->culled)
+		{
+			_numCulled++;
+			continue;
+		}
+
+		for (unsigned int d = 0; d < pass->deps.size(); d++)
+		{
+			if (!_passes[pass->deps[d]]->culled)
+				pass->refCount++;
+		}
+		for (unsigned int d = 0; d < pass->waits.size(); d++)
+		{
+			if (!_passes[pass->waits[d]]->culled)
+				pass->refCount++;
+		}
+	}
+
+	_order.set_used(0);
+	int numAlive = _numPasses - _numCulled;
+	while ((int)_order.size() < numAlive)
+	{
+		int next = -1;
+		for (int i = 0; i < _numPasses; i++)
+		{
+			rgPass_t* pass = _passes[i];
+			if (!pass->culled && pass->refCount == 0 && !R_Contains(_order, i))
+			{
+				next = i;
+				break;
+			}
+		}
+
+		if (next == -1)
+		{
+			Sys_Error("RenderGraph::Compile: dependency cycle\n");
+			return false;
+		}
+
+		_order.push_back(next);
+		for (int i = 0; i < _numPasses; i++)
+		{
+			if (R_Contains(_passes[i]->deps, next))
+				_passes[i]->refCount--;
+			if (R_Contains(_passes[i]->waits, next))
+				_passes[i]->refCount--;
+		}
+	}
+
+	// lifetimes of the transient targets in execution order
+	for (unsigned int t = 0; t < _textures.size(); t++)
+	{
+		_textures[t].firstUse = -1;
+		_textures[t].lastUse = -1;
+	}
+
+	for (unsigned int o = 0; o < _order.size(); o++)
+	{
+		rgPass_t* pass = _passes[_order[o]];
+		for (int k = 0; k < 2; k++)
+		{
+			array<rgResource_t>& list = k == 0 ? pass->reads : pass->writes;
+			for (unsigned int r = 0; r < list.size(); r++)
+			{
+				rgTexture_t& tex = _textures[list[r]];
+				if (tex.firstUse == -1)
+					tex.firstUse = o;
+				tex.lastUse = o;
+			}
+		}
+	}
+
+	_transientSize = 0;
+	_aliasedSize = 0;
+	for (unsigned int t = 0; t < _textures.size(); t++)
+	{
+		if (!_textures[t].imported && _textures[t].firstUse != -1)
+			_transientSize += DescSize(_textures[t].desc);
+	}
+
+	return true;
+}
+
+void RenderGraph::Execute()
+{
+	int liveSize = 0;
+	for (unsigned int o = 0; o < _order.size(); o++)
+	{
+		rgPass_t* pass = _passes[_order[o]];
+
+		for (unsigned int t = 0; t < _textures.size(); t++)
+		{
+			rgTexture_t& tex = _textures[t];
+			if (!tex.imported && tex.firstUse == (int)o)
+			{
+				tex.rt = _pool->Acquire(tex.desc);
+				liveSize += DescSize(tex.desc);
+			}
+		}
+
+		if (liveSize > _aliasedSize)
+			_aliasedSize = liveSize;
+
+		{
+			PROFILE_DYNAMIC(pass->name.c_str());
+			PROFILE_GPU(pass->name.c_str());
+			BindTarget(pass);
+			pass->func(this, pass->data);
+		}
+
+		for (unsigned int t = 0; t < _textures.size(); t++)
+		{
+			rgTexture_t& tex = _textures[t];
+			if (!tex.imported && tex.lastUse == (int)o)
+			{
+				_pool->Release(tex.rt);
+				tex.rt = NULL;
+				liveSize -= DescSize(tex.desc);
+			}
+		}
+	}
+
+	RenderTexture::BindDefault(_winWidth, _winHeight);
+	GL_CheckError("RenderGraph::Execute");
+}
+
+RenderTexture* RenderGraph::GetTexture( rgResource_t res )
+{
+	if (res < 0 || res >= (int)_textures.size())
+		return NULL;
+	return _textures[res].rt;
+}
+
+const renderTargetDesc_t& RenderGraph::GetDesc( rgResource_t res )
+{
+	return _textures[res].desc;
+}
+
+void RenderGraph::BindTarget( rgPass_t* pass )
+{
+	if (pass->writes.size() == 0)
+		return;
+
+	rgTexture_t& tex = _textures[pass->writes[0]];
+	if (tex.backbuffer)
+		RenderTexture::BindDefault(_winWidth, _winHeight);
+	else if (tex.rt != NULL)
+		tex.rt->Bind();
+}
+
+int RenderGraph::DescSize( const renderTargetDesc_t& desc )
+{
+	int size = desc.width * desc.height * RenderTexture::BytesPerPixel(desc.format);
+	if (desc.depth && !RenderTexture::IsDepthFormat(desc.format))
+		size += desc.width * desc.height * 4;
+	return size;
+}
+
+void RenderGraph::PrintStats()
+{
+	Sys_Printf("render graph: %d passes, %d culled\n", _numPasses, _numCulled);
+	for (unsigned int o = 0; o < _order.size(); o++)
+		Sys_Printf("  %d: %s\n", o, _passes[_order[o]]->name.c_str());
+	Sys_Printf("transient targets: %d KB, aliased: %d KB, pool: %d KB in %d targets\n",
+		_transientSize / 1024, _aliasedSize / 1024, _pool->GetMemorySize() / 1024, _pool->GetNumTargets());
+}
@@ -0,0 +1,130 @@
+#ifndef __RENDERGRAPH_H__
+#define __RENDERGRAPH_H__
+
+#include "RenderTargetPool.h"
+#include "../common/Str.h"
+
+class RenderGraph;
+class RenderTexture;
+
+typedef int rgResource_t;
+
+#define RG_INVALID -1
+
+typedef void (*RenderPassFunc)(RenderGraph* graph, void* data);
+
+// called every frame to declare extra passes before the graph is compiled
+typedef void (*RenderGraphSetupFunc)(RenderGraph* graph, void* data);
+
+/*
+===============================================================================
+
+	Frame graph
+
+	Passes are declared every frame together with the render targets they
+	read and write. A pass reading a target depends on the last pass
+	declared before it that wrote it; a pass writing one also runs after
+	the previous writer and the readers in between. Compile() drops passes
+	whose output is never consumed, orders the rest by their dependencies and computes the lifetime of every
+	transient target, so Execute() can take targets from the pool right before
+	their first use and hand them back after their last one. Targets with
+	disjoint lifetimes end up sharing the same fbo.
+
+===============================================================================
+*/
+class RenderGraph
+{
+public:
+	RenderGraph(RenderTargetPool* pool);
+	~RenderGraph();
+
+	// forget last frame's passes and resources
+	void Reset(int winWidth, int winHeight);
+
+	rgResource_t CreateTexture(const char* name, const renderTargetDesc_t& desc);
+
+	// persistent target owned by the caller, e.g. a shadow map
+	rgResource_t ImportTexture(const char* name, RenderTexture* rt);
+
+	rgResource_t GetBackbuffer() { return _backbuffer; }
+
+	int AddPass(const char* name, RenderPassFunc func, void* data);
+
+	void Read(int pass, rgResource_t res);
+
+	// the first target written by a pass is bound before the pass runs
+	void Write(int pass, rgResource_t res);
+
+	// keep the pass even when nothing reads its output
+	void SetSideEffect(int pass);
+
+	bool Compile();
+
+	void Execute();
+
+	// only valid while the pass that declared the resource is running
+	RenderTexture* GetTexture(rgResource_t res);
+
+	const renderTargetDesc_t& GetDesc(rgResource_t res);
+
+	int GetNumPasses() { return _numPasses; }
+
+	int GetNumCulledPasses() { return _numCulled; }
+
+	// bytes the transient targets would need without aliasing
+	int GetTransientSize() { return _transientSize; }
+
+	// bytes actually held by the transient targets at the peak of the frame
+	int GetAliasedSize() { return _aliasedSize; }
+
+	void PrintStats();
+
+private:
+	typedef struct
+	{
+		lfStr name;
+		renderTargetDesc_t desc;
+		RenderTexture* rt;
+		bool imported;
+		bool backbuffer;
+		int firstUse;		// execution order index
+		int lastUse;
+	}rgTexture_t;
+
+	typedef struct
+	{
+		lfStr name;
+		RenderPassFunc func;
+		void* data;
+		array<rgResource_t> reads;
+		array<rgResource_t> writes;
+		array<int> deps;
+		array<int> waits;		// only run after these, doesn't keep them alive
+		bool sideEffect;
+		bool culled;
+		int refCount;
+	}rgPass_t;
+
+	int LastWriter(rgResource_t res, int before);
+
+	void BindTarget(rgPass_t* pass);
+
+	static int DescSize(const renderTargetDesc_t& desc);
+
+private:
+	RenderTargetPool* _pool;
+	array<rgTexture_t> _textures;
+	array<rgPass_t*> _passes;
+	int _numPasses;
+	array<int> _order;
+	rgResource_t _backbuffer;
+
+	int _winWidth;
+	int _winHeight;
+
+	int _numCulled;
+	int _transientSize;
+	int _aliasedSize;
+};
+
+#endif
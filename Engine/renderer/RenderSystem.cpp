@@ -16,9 +16,20 @@
 #include "../Mesh.h"
 #include "../File.h"
 #include "../Camera.h"
+#include "../RenderTexture.h"
+#include "../framework/Profiler.h"
+#include "../framework/Trace.h"
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
+#include "GpuMemory.h"
+#include "Billboard.h"
+#include "../ParticleSystem.h"
+#include "../Terrain.h"
+#include "../MapFile.h"
 
 static const int view_width = 800;
 static const int view_height = 600;
+static const int shadowmap_size = 1024;
 
 
 RenderSystemLocal::RenderSystemLocal(glimpParms_t *glimpParms)
@@ -26,6 +37,18 @@ RenderSystemLocal::RenderSystemLocal(glimpParms_t *glimpParms)
 	GL_CreateDevice(glimpParms);
 	_winWidth = glimpParms->width;
 	_winHeight = glimpParms->height;
+	_sceneWidth = _winWidth;
+	_sceneHeight = _winHeight;
+
+	_depthPrepass = false;
+	_measureOverdraw = false;
+	_overdraw = 0.f;
+	_overdrawCovered = 0.f;
+
+	_dynRes = new DynamicResolution;
+	_particles = new ParticleSystem;
+	_sceneTimer = NULL;
+	_lastFrameTicks = 0.0;
 }
 
 void RenderSystemLocal::Init()
@@ -39,13 +62,11 @@ void RenderSystemLocal::Init()
 	glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);	
 	glViewport(0, 0, _winWidth, _winHeight);
 
-	// ıҪ
-	glEnable(GL_BLEND);
-
 	glEnable(GL_CULL_FACE);
 	glFrontFace(GL_CCW);// The initial value is GL_CCW.
 	glCullFace(GL_BACK);// The initial value is GL_BACK.
 
+	// blending is only on for the translucent queue and the ui
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	glActiveTexture(GL_TEXTURE0);
@@ -56,7 +77,15 @@ void RenderSystemLocal::Init()
 	_camera = new Camera;
 	_camera->Setup2DCamera(view_width, view_height);
 
+	R_InitGpuMemory();
 	resourceSys->LoadGLResource();
+
+	_rtPool = new RenderTargetPool;
+	_renderGraph = new RenderGraph(_rtPool);
+	_sceneTimer = new GpuTimer;
+	_postProcess = new PostProcess;
+	if (!_postProcess->Init())
+		Sys_Printf("post process init failed\n");
 	
 	// fps  init
 	_defaultSprite = new Sprite;
@@ -81,28 +110,176 @@ void draw3DCoordinate()
 
 void RenderSystemLocal::FrameUpdate()
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-	
-	RenderCommon();
+	PROFILE_SCOPE("render");
+
+	double ticks = Sys_GetClockTicks();
+	if (_lastFrameTicks > 0.0)
+	{
+		float frameMs = (float)((ticks - _lastFrameTicks) * 1000.0 / Sys_ClockTicksPerSecond());
+		_dynRes->Update(frameMs, (float)_sceneTimer->GetMs());
+		PROFILE_SCOPE("particles");
+		_particles->Update(frameMs * 0.001f);
+	}
+	_lastFrameTicks = ticks;
 
-	//RenderPasses();
+	// mip selection and terrain lod go by the pixels actually rendered
+	_dynRes->GetScaledSize(_winWidth, _winHeight, &_sceneWidth, &_sceneHeight);
 
-	RenderBounds();
+	{
+		PROFILE_SCOPE("texture upload");
+		for (unsigned int i = 0; i < _surfaces.size(); i++)
+		{
+			if (IsUISurf(_surfaces[i]))
+				R_MarkTextureFullSize(_surfaces[i]);
+			else
+				R_MarkTextureUsage(_surfaces[i], _sceneWidth, _sceneHeight);
+		}
+		for (unsigned int i = 0; i < _billboards.size(); i++)
+			R_MarkTextureFullSize(_billboards[i]->_drawSurf);
+		R_UpdateTextureStreaming();
+		R_UploadTextures();
+	}
 
+	SetupGraph();
+
+	if (_renderGraph->Compile())
+		_renderGraph->Execute();
+	_rtPool->NextFrame();
+	R_UpdateGpuMemory();
+
+	if (Trace_IsCapturing())
+	{
+		static int drawCalls = Prof_RegisterZone("draw calls");
+		static int uploadBytes = Prof_RegisterZone("upload bytes");
+		static int transientBytes = Prof_RegisterZone("transient targets");
+		static int gpuBytes = Prof_RegisterZone("gpu memory");
+		Trace_Counter(drawCalls, glCounters.drawCalls);
+		Trace_Counter(uploadBytes, glCounters.uploadBytes);
+		Trace_Counter(transientBytes, _renderGraph->GetAliasedSize());
+		gpuMemStats_t gpuMem;
+		R_GetGpuMemStats(&gpuMem);
+		Trace_Counter(gpuBytes, gpuMem.totalBytes);
+	}
+	memset(&glCounters, 0, sizeof(glCounters));
+
+	PROFILE_SCOPE("swap");
 	GL_SwapBuffers();
 }
 
-void RenderSystemLocal::RenderShadowMap(drawSurf_t* drawSur)
+void RenderSystemLocal::SetupGraph()
 {
-	glViewport(0, 0, 1024, 1024);
+	_renderGraph->Reset(_winWidth, _winHeight);
+	rgResource_t backbuffer = _renderGraph->GetBackbuffer();
 
-	glClearColor(1.0, 1.0, 1.0, 1.0);
-	glBindFramebuffer(GL_FRAMEBUFFER, _shadowMap->fbo);
-	glClear(GL_DEPTH_BUFFER_BIT);
+	bool castShadows = false;
+	for (unsigned int i = 0; i < _surfaces.size(); i++)
+		castShadows |= _surfaces[i]->bShaowmap;
+
+	// nothing samples the shadow map yet, so the graph culls this pass
+	// until a material reads it
+	if (castShadows)
+	{
+		renderTargetDesc_t desc;
+		desc.width = shadowmap_size;
+		desc.height = shadowmap_size;
+		desc.format = GL_DEPTH_COMPONENT32F;
+		desc.depth = true;
+		rgResource_t shadowMap = _renderGraph->CreateTexture("shadowmap", desc);
+
+		int shadow = _renderGraph->AddPass("shadow", ShadowPass, this);
+		_renderGraph->Write(shadow, shadowMap);
+	}
+
+	// with a post stack or a reduced resolution the scene goes to an
+	// offscreen target first
+	rgResource_t sceneColor = backbuffer;
+	if (_postProcess->IsActive() || _sceneWidth != _winWidth || _sceneHeight != _winHeight)
+	{
+		renderTargetDesc_t desc;
+		desc.width = _sceneWidth;
+		desc.height = _sceneHeight;
+		desc.format = _postProcess->GetSceneFormat();
+		desc.depth = true;
+		sceneColor = _renderGraph->CreateTexture("scene", desc);
+	}
+
+	int common = _renderGraph->AddPass("common", CommonPass, this);
+	_renderGraph->Write(common, sceneColor);
+
+	if (_measureOverdraw)
+	{
+		int overdraw = _renderGraph->AddPass("overdraw", OverdrawPass, this);
+		_renderGraph->Write(overdraw, sceneColor);
+	}
+
+	int bounds = _renderGraph->AddPass("bounds", BoundsPass, this);
+	_renderGraph->Write(bounds, sceneColor);
 
+	// the last post pass samples the scene at whatever size it has, so it
+	// doubles as the upscale
+	_postProcess->BeginFrame();
+	if (_postProcess->IsActive())
+		_postProcess->Setup(_renderGraph, sceneColor, backbuffer);
+	else if (sceneColor != backbuffer)
+		_postProcess->AddCopyPass(_renderGraph, "upscale", sceneColor, backbuffer);
+
+	int ui = _renderGraph->AddPass("ui", UIPass, this);
+	_renderGraph->Write(ui, backbuffer);
+
+	for (unsigned int i = 0; i < _graphSetups.size(); i++)
+		_graphSetups[i].func(_renderGraph, _graphSetups[i].data);
+}
+
+void RenderSystemLocal::ShadowPass( RenderGraph* graph, void* data )
+{
+	RenderSystemLocal* self = (RenderSystemLocal*)data;
+	glClear(GL_DEPTH_BUFFER_BIT);
 	glCullFace(GL_FRONT);
+	for (unsigned int i = 0; i < self->_surfaces.size(); i++)
+	{
+		if (self->_surfaces[i]->bShaowmap)
+			self->RenderShadowMap(self->_surfaces[i]);
+	}
+	glCullFace(GL_BACK);
+}
+
+void RenderSystemLocal::CommonPass( RenderGraph* graph, void* data )
+{
+	RenderSystemLocal* self = (RenderSystemLocal*)data;
+	self->_sceneTimer->Begin();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	self->RenderCommon();
+	self->_sceneTimer->End();
+}
+
+void RenderSystemLocal::UIPass( RenderGraph* graph, void* data )
+{
+	// ui is always on top of the scene
+	glClear(GL_DEPTH_BUFFER_BIT);
+	((RenderSystemLocal*)data)->RenderUI();
+}
+
+void RenderSystemLocal::BoundsPass( RenderGraph* graph, void* data )
+{
+	((RenderSystemLocal*)data)->RenderBounds();
+}
+
+void RenderSystemLocal::OverdrawPass( RenderGraph* graph, void* data )
+{
+	((RenderSystemLocal*)data)->ReadOverdraw();
+}
+
+void RenderSystemLocal::AddGraphSetup( RenderGraphSetupFunc func, void* data )
+{
+	graphSetup_t setup;
+	setup.func = func;
+	setup.data = data;
+	_graphSetups.push_back(setup);
+}
+
+void RenderSystemLocal::RenderShadowMap(drawSurf_t* drawSur)
+{
 	R_RenderShadowMap(drawSur, R_DrawPositon);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void RenderSystemLocal::DrawString( const char* text )
@@ -180,31 +357,190 @@ void RenderSystemLocal::RenderPasses()
 
 void RenderSystemLocal::RenderCommon()
 {
+	if (_depthPrepass)
+		RenderDepth();
+
+	// every fragment that passes the depth test bumps the stencil
+	if (_measureOverdraw)
+	{
+		glEnable(GL_STENCIL_TEST);
+		glStencilFunc(GL_ALWAYS, 0, 0xff);
+		glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+	}
+
+	// opaque surfaces in the order they were added, which keeps batches
+	_drawList.set_used(0);
+	for (unsigned int i = 0; i < _surfaces.size(); i++)
+	{
+		if (!_surfaces[i]->bTranslucent)
+			_drawList.push_back(_surfaces[i]);
+	}
+	if (_depthPrepass)
+	{
+		// opaque depth is final, only the visible fragment gets shaded. the
+		// pre-pass and the materials compute gl_Position in different
+		// programs (a uniform, or the multi-draw matrix buffer) and nothing
+		// makes them bit exact, so GL_EQUAL could drop visible fragments;
+		// LEQUAL, left from RenderDepth, keeps them
+		glDepthMask(GL_FALSE);
+	}
+	R_RenderCommonList(_drawList.pointer(), _drawList.size());
+	if (_depthPrepass)
+		glDepthMask(GL_TRUE);
+	for (unsigned int i = 0; i < _terrains.size(); i++)
+		_terrains[i]->Draw(_sceneHeight);
+	for (unsigned int i = 0; i < _maps.size(); i++)
+		_maps[i]->Draw();
+
+	// translucent surfaces back to front, tested against the opaque depth
+	// but not writing it
+	_drawList.set_used(0);
+	for (unsigned int i = 0; i < _surfaces.size(); i++)
+	{
+		if (_surfaces[i]->bTranslucent && !IsUISurf(_surfaces[i]))
+			_drawList.push_back(_surfaces[i]);
+	}
+	if (_drawList.size() > 0)
+	{
+		SortTranslucent();
+		glEnable(GL_BLEND);
+		glDepthMask(GL_FALSE);
+		R_RenderCommonList(_drawList.pointer(), _drawList.size());
+		glDepthMask(GL_TRUE);
+		glDisable(GL_BLEND);
+	}
+	RB_DrawBillboards(_billboards.pointer(), _billboards.size());
+	_particles->Draw();
+	GL_CheckError("RenderCommon");
+
+	if (_measureOverdraw)
+		glDisable(GL_STENCIL_TEST);
+}
+
+void RenderSystemLocal::RenderUI()
+{
+	_drawList.set_used(0);
 	for (unsigned int i = 0; i < _surfaces.size(); i++)
 	{
-		if (_surfaces[i]->id == 99)
-			_surfaces[i]->id = 99;
+		if (IsUISurf(_surfaces[i]))
+			_drawList.push_back(_surfaces[i]);
+	}
+	// in the order added, later ui draws over earlier
+	glEnable(GL_BLEND);
+	R_RenderCommonList(_drawList.pointer(), _drawList.size());
+	glDisable(GL_BLEND);
+	GL_CheckError("RenderUI");
+}
+
+bool RenderSystemLocal::IsUISurf( drawSurf_t* surf )
+{
+	return surf->viewProj == _camera->GetViewProj();
+}
+
+void RenderSystemLocal::RenderDepth()
+{
+	Shader* shader = resourceSys->FindShader(eShader_Position);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthFunc(GL_LESS);
+	for (unsigned int i = 0; i < _surfaces.size(); i++)
+	{
+		if (!_surfaces[i]->bTranslucent)
+			R_RenderDepth(_surfaces[i], shader);
+	}
+	glDepthFunc(GL_LEQUAL);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void RenderSystemLocal::SortTranslucent()
+{
+	// clip z grows with the distance for perspective and ortho projections
+	// alike, the key is its negative so the far ones come first
+	int count = _drawList.size();
+	_sortKeys.set_used(count);
+	for (int i = 0; i < count; i++)
+	{
+		drawSurf_t* surf = _drawList[i];
+		if (surf->viewProj == NULL)
+		{
+			_sortKeys[i] = 0.f;
+			continue;
+		}
+
+		vec3 center(0.f, 0.f, 0.f);
+		if (surf->geo != NULL)
+			center = (surf->geo->aabb._min + surf->geo->aabb._max) * 0.5f;
+		vec4 clip = ((*surf->viewProj) * surf->matModel) * vec4(center, 1.f);
+		_sortKeys[i] = -clip.z;
+	}
+
+	const unsigned int* order = _translucentSort.Sort(_sortKeys.const_pointer(), count);
+	_sortedList.set_used(count);
+	for (int i = 0; i < count; i++)
+		_sortedList[i] = _drawList[order[i]];
+	for (int i = 0; i < count; i++)
+		_drawList[i] = _sortedList[i];
+}
 
-		R_RenderCommon(_surfaces[i]);
-		GL_CheckError("i=====");
+void RenderSystemLocal::ReadOverdraw()
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	int numPixels = viewport[2] * viewport[3];
+	if (numPixels <= 0)
+		return;
+
+	_stencilData.set_used(numPixels);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, viewport[2], viewport[3], GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, _stencilData.pointer());
+
+	int writes = 0;
+	int covered = 0;
+	const unsigned char* data = _stencilData.const_pointer();
+	for (int i = 0; i < numPixels; i++)
+	{
+		writes += data[i];
+		if (data[i] > 0)
+			covered++;
 	}
+
+	_overdraw = (float)writes / numPixels;
+	_overdrawCovered = covered > 0 ? (float)writes / covered : 0.f;
+	GL_CheckError("ReadOverdraw");
+}
+
+void RenderSystemLocal::GetOverdraw( float* average, float* covered )
+{
+	if (average)
+		*average = _overdraw;
+	if (covered)
+		*covered = _overdrawCovered;
 }
 
 bool RenderSystemLocal::AddUISurf( drawSurf_t* drawSurf )
 {
 	if (drawSurf->viewProj == NULL)
 		drawSurf->viewProj = _camera->GetViewProj();
+	drawSurf->bTranslucent = true;
 
 	drawSurf->shaderParms->shader = resourceSys->FindShader(eShader_PositionTex);
 	if (drawSurf->shaderParms->tex == NULL)
 		drawSurf->shaderParms->tex = resourceSys->AddTexture(".png");
 
-	drawSurf->mtr = resourceSys->AddMaterial("../media/mtr/positiontex.mtr");
+	if (!drawSurf->mtr)
+		drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/positiontex.mtr");
 	return AddDrawSur(drawSurf);
 }
 
 bool RenderSystemLocal::AddSprite( Sprite* sprite )
 {
+	// billboards skip the draw surface, they are instanced per texture
+	if (sprite->IsBillboard())
+	{
+		_billboards.push_back(sprite);
+		return true;
+	}
+
 	drawSurf_t* drawSurf = sprite->_drawSurf;
 	AddUISurf(drawSurf);
 	return true;
@@ -215,16 +551,36 @@ bool RenderSystemLocal::AddModel( Model* model )
 	drawSurf_t* drawSurf = model->_drawSurf;
 	drawSurf->shaderParms->shader = resourceSys->FindShader(eShader_PositionTex);
 	if (!drawSurf->mtr)
-		drawSurf->mtr = resourceSys->AddMaterial("../media/mtr/positiontex.mtr");
+		drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/positiontex.mtr");
 	AddDrawSur(drawSurf);
 	return true;
 }
 
+void RenderSystemLocal::AddEmitter( ParticleEmitter* emitter )
+{
+	_particles->AddEmitter(emitter);
+}
+
+void RenderSystemLocal::RemoveEmitter( ParticleEmitter* emitter )
+{
+	_particles->RemoveEmitter(emitter);
+}
+
+void RenderSystemLocal::AddTerrain( Terrain* terrain )
+{
+	_terrains.push_back(terrain);
+}
+
+void RenderSystemLocal::AddMap( MapFile* map )
+{
+	_maps.push_back(map);
+}
+
 bool RenderSystemLocal::AddAnimModel( AniModel* model )
 {
 	drawSurf_t* drawSurf = model->_drawSurf;
 	drawSurf->shaderParms->shader = resourceSys->FindShader(eShader_PositionTex);
-	drawSurf->mtr = resourceSys->AddMaterial("../media/mtr/positiontex.mtr");
+	drawSurf->mtr = resourceSys->AddMaterial("../Media/mtr/positiontex.mtr");
 	AddDrawSur(drawSurf);
 	return true;
 }
@@ -3,7 +3,11 @@
 #include "../glutils.h"
 #include "../common/mat4.h"
 #include "../common/array.h"
+#include "../common/RadixSort.h"
 #include "../r_public.h"
+#include "RenderGraph.h"
+#include "PostProcess.h"
+#include "DynamicResolution.h"
 
 class Pipeline;
 class Model;
@@ -11,6 +15,10 @@ class Sprite;
 class Material;
 class Camera;
 class AniModel;
+class ParticleEmitter;
+class ParticleSystem;
+class Terrain;
+class MapFile;
 
 
 class RenderSystem
@@ -35,6 +43,35 @@ public:
 	virtual bool AddAnimModel(AniModel* model) = 0;
 
 	virtual int GetNumSurf() = 0;
+
+	virtual void AddGraphSetup(RenderGraphSetupFunc func, void* data) = 0;
+
+	virtual PostProcess* GetPostProcess() = 0;
+
+	// lay down depth for opaque surfaces first, then shade them without
+	// writing depth
+	virtual void SetDepthPrepass(bool enable) = 0;
+
+	// count fragment writes per pixel in the stencil buffer, costs a readback
+	virtual void SetMeasureOverdraw(bool enable) = 0;
+
+	// average writes per pixel over the screen and over covered pixels
+	virtual void GetOverdraw(float* average, float* covered) = 0;
+
+	// the 3d scene is rendered at GetScale() of the window and upscaled,
+	// ui is always drawn at the window size
+	virtual DynamicResolution* GetDynamicResolution() = 0;
+
+	// simulated every frame and drawn after the translucent surfaces
+	virtual void AddEmitter(ParticleEmitter* emitter) = 0;
+
+	virtual void RemoveEmitter(ParticleEmitter* emitter) = 0;
+
+	// drawn with the opaque surfaces, at the levels its camera needs
+	virtual void AddTerrain(Terrain* terrain) = 0;
+
+	// only its potentially visible leaves are drawn, with the opaque surfaces
+	virtual void AddMap(MapFile* map) = 0;
 };
 
 class RenderSystemLocal : public RenderSystem
@@ -60,10 +97,54 @@ public:
 	virtual bool AddAnimModel(AniModel* model);
 
 	virtual int GetNumSurf(){ return _surfaces.size(); }
+
+	virtual void AddGraphSetup(RenderGraphSetupFunc func, void* data);
+
+	virtual PostProcess* GetPostProcess() { return _postProcess; }
+
+	virtual void SetDepthPrepass(bool enable) { _depthPrepass = enable; }
+
+	virtual void SetMeasureOverdraw(bool enable) { _measureOverdraw = enable; }
+
+	virtual void GetOverdraw(float* average, float* covered);
+
+	virtual DynamicResolution* GetDynamicResolution() { return _dynRes; }
+
+	virtual void AddEmitter(ParticleEmitter* emitter);
+
+	virtual void RemoveEmitter(ParticleEmitter* emitter);
+
+	virtual void AddTerrain(Terrain* terrain);
+
+	virtual void AddMap(MapFile* map);
 private:
 	
+	void SetupGraph();
+
+	static void ShadowPass(RenderGraph* graph, void* data);
+
+	static void CommonPass(RenderGraph* graph, void* data);
+
+	static void BoundsPass(RenderGraph* graph, void* data);
+
+	static void OverdrawPass(RenderGraph* graph, void* data);
+
+	static void UIPass(RenderGraph* graph, void* data);
+
+	// drawn with the 2d camera
+	bool IsUISurf(drawSurf_t* surf);
+
 	void RenderCommon();
 
+	void RenderUI();
+
+	void RenderDepth();
+
+	// orders _drawList back to front by view depth, stable
+	void SortTranslucent();
+
+	void ReadOverdraw();
+
 	void RenderPasses();
 
 	void RenderBounds();
@@ -71,11 +152,41 @@ private:
 private:
 	Camera* _camera;
 	array<drawSurf_t*> _surfaces;
+	array<Sprite*> _billboards;
+	array<Terrain*> _terrains;
+	array<MapFile*> _maps;
+	array<drawSurf_t*> _drawList;		// the surfaces of one pass, in order
+	array<drawSurf_t*> _sortedList;
+	array<float> _sortKeys;
+	RadixSort _translucentSort;
 	Sprite*	_defaultSprite;
-	shadowMap_t* _shadowMap;
+
+	typedef struct
+	{
+		RenderGraphSetupFunc func;
+		void* data;
+	}graphSetup_t;
+
+	RenderTargetPool* _rtPool;
+	RenderGraph* _renderGraph;
+	array<graphSetup_t> _graphSetups;
+	PostProcess* _postProcess;
+
+	bool _depthPrepass;
+	bool _measureOverdraw;
+	array<unsigned char> _stencilData;
+	float _overdraw;
+	float _overdrawCovered;
+
+	DynamicResolution* _dynRes;
+	ParticleSystem* _particles;
+	GpuTimer* _sceneTimer;
+	double _lastFrameTicks;
 
 	int _winWidth;
 	int _winHeight;
+	int _sceneWidth;		// the window scaled by _dynRes, this frame
+	int _sceneHeight;
 };
 
 #endif
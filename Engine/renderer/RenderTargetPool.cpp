@@ -0,0 +1,86 @@
+#include "RenderTargetPool.h"
+#include "../RenderTexture.h"
+
+static bool R_DescEqual(const renderTargetDesc_t& a, const renderTargetDesc_t& b)
+{
+	return a.width == b.width && a.height == b.height &&
+		a.format == b.format && a.depth == b.depth;
+}
+
+RenderTargetPool::RenderTargetPool():_frame(0), _numAllocations(0)
+{
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+	for (unsigned int i = 0; i < _targets.size(); i++)
+		delete _targets[i].rt;
+	_targets.clear();
+}
+
+RenderTexture* RenderTargetPool::Acquire( const renderTargetDesc_t& desc )
+{
+	for (unsigned int i = 0; i < _targets.size(); i++)
+	{
+		if (!_targets[i].inUse && R_DescEqual(_targets[i].desc, desc))
+		{
+			_targets[i].inUse = true;
+			_targets[i].lastFrame = _frame;
+			return _targets[i].rt;
+		}
+	}
+
+	poolTarget_t target;
+	target.rt = new RenderTexture(desc.width, desc.height, desc.format, desc.depth);
+	target.desc = desc;
+	target.inUse = true;
+	target.lastFrame = _frame;
+	_targets.push_back(target);
+	_numAllocations++;
+	return target.rt;
+}
+
+void RenderTargetPool::Release( RenderTexture* rt )
+{
+	for (unsigned int i = 0; i < _targets.size(); i++)
+	{
+		if (_targets[i].rt == rt)
+		{
+			_targets[i].inUse = false;
+			return;
+		}
+	}
+}
+
+void RenderTargetPool::Purge()
+{
+	for (int i = (int)_targets.size() - 1; i >= 0; i--)
+	{
+		if (_targets[i].inUse)
+			continue;
+
+		delete _targets[i].rt;
+		_targets.erase(i);
+	}
+}
+
+void RenderTargetPool::NextFrame()
+{
+	_frame++;
+	for (int i = (int)_targets.size() - 1; i >= 0; i--)
+	{
+		if (_targets[i].inUse || _frame - _targets[i].lastFrame < POOL_MAX_IDLE_FRAMES)
+			continue;
+
+		delete _targets[i].rt;
+		_targets.erase(i);
+	}
+}
+
+int RenderTargetPool::GetMemorySize()
+{
+	int size = 0;
+	for (unsigned int i = 0; i < _targets.size(); i++)
+		size += _targets[i].rt->GetMemorySize();
+	return size;
+}
@@ -0,0 +1,59 @@
+#ifndef __RENDERTARGETPOOL_H__
+#define __RENDERTARGETPOOL_H__
+
+#include "../glutils.h"
+#include "../common/array.h"
+
+class RenderTexture;
+
+typedef struct
+{
+	int width;
+	int height;
+	GLenum format;
+	bool depth;
+}renderTargetDesc_t;
+
+#define POOL_MAX_IDLE_FRAMES 60
+
+// hands out RenderTextures by size and format; a released target is
+// given to the next Acquire with a matching description, in this frame or
+// a later one. targets left idle for POOL_MAX_IDLE_FRAMES are deleted.
+class RenderTargetPool
+{
+public:
+	RenderTargetPool();
+	~RenderTargetPool();
+
+	RenderTexture* Acquire(const renderTargetDesc_t& desc);
+
+	void Release(RenderTexture* rt);
+
+	// delete every target that is not in use
+	void Purge();
+
+	// once per frame, drops targets nobody asked for in a while
+	void NextFrame();
+
+	// number of RenderTextures created so far, stays flat after warm-up
+	int GetNumAllocations() { return _numAllocations; }
+
+	int GetNumTargets() { return _targets.size(); }
+
+	int GetMemorySize();
+
+private:
+	typedef struct
+	{
+		RenderTexture* rt;
+		renderTargetDesc_t desc;
+		bool inUse;
+		int lastFrame;
+	}poolTarget_t;
+
+	array<poolTarget_t> _targets;
+	int _frame;
+	int _numAllocations;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "TextureArray.h"
+#include "GpuMemory.h"
+#include "../Texture.h"
+#include "../Image.h"
+#include "../common/array.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+	GLuint name;
+	int width;
+	int height;
+	GLenum format;			// sized internal format
+	int levels;
+	int layers;
+	int used;				// layers handed out at least once
+	int live;				// layers a texture holds
+	int bytes;
+}texArrayPage_t;
+
+typedef struct
+{
+	GLuint page;
+	int layer;
+}texArrayLayer_t;
+
+static bool ta_initialized = false;
+static bool ta_supported = false;
+static bool ta_enabled = true;
+static int ta_maxLayers = TEXARRAY_MIN_LAYERS;
+static array<texArrayPage_t> ta_pages;
+static array<texArrayLayer_t> ta_freeLayers;	// given back, reused first
+
+static void R_TexArray_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		ta_enabled = atoi(argv[1]) != 0;
+	R_PrintTextureArrays();
+}
+
+static void R_InitTextureArrays()
+{
+	ta_initialized = true;
+	Cmd_AddCommand("texarray", R_TexArray_f, "texture array pages, texarray 0/1 toggles paging of new textures");
+
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	ta_supported = extensions != NULL
+		&& strstr(extensions, "GL_ARB_texture_storage") != NULL
+		&& strstr(extensions, "GL_ARB_texture_view") != NULL;
+
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	if (maxLayers > 0)
+		ta_maxLayers = maxLayers;
+}
+
+// immutable storage takes sized formats only
+static GLenum R_PageFormat(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_RGB:
+	case GL_RGB8:
+		return GL_RGB8;
+	case GL_RGBA:
+	case GL_RGBA8:
+		return GL_RGBA8;
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return internalFormat;
+	}
+	return 0;
+}
+
+static void R_SetSampling(GLenum target, int levels)
+{
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+static texArrayPage_t* R_FindPage(int width, int height, GLenum format, int levels)
+{
+	for (unsigned int i = 0; i < ta_pages.size(); i++)
+	{
+		texArrayPage_t& p = ta_pages[i];
+		if (p.live < p.layers && p.width == width && p.height == height
+			&& p.format == format && p.levels == levels)
+			return &p;
+	}
+	return NULL;
+}
+
+static texArrayPage_t* R_NewPage(const Image* image, GLenum format)
+{
+	texArrayPage_t p;
+	p.width = image->GetWidth();
+	p.height = image->GetHeight();
+	p.format = format;
+	p.levels = image->GetMipLevels();
+	p.used = 0;
+	p.live = 0;
+
+	int layerBytes = 0;
+	for (int l = 0; l < p.levels; l++)
+		layerBytes += image->GetImageSize(l);
+	p.layers = TEXARRAY_PAGE_BYTES / layerBytes;
+	if (p.layers > ta_maxLayers)
+		p.layers = ta_maxLayers;
+	if (p.layers < 1)
+		p.layers = 1;
+	p.bytes = layerBytes * p.layers;
+
+	glGenTextures(1, &p.name);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, p.name);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, p.levels, format, p.width, p.height, p.layers);
+	R_SetSampling(GL_TEXTURE_2D_ARRAY, p.levels);
+	R_GpuMemAlloc(GL_TEXTURE, p.name, GPUMEM_TEXTURE, p.bytes);
+
+	ta_pages.push_back(p);
+	return &ta_pages[ta_pages.size() - 1];
+}
+
+static int R_TakeLayer(texArrayPage_t* page)
+{
+	page->live++;
+	for (unsigned int i = 0; i < ta_freeLayers.size(); i++)
+	{
+		if (ta_freeLayers[i].page == page->name)
+		{
+			int layer = ta_freeLayers[i].layer;
+			ta_freeLayers[i] = ta_freeLayers[ta_freeLayers.size() - 1];
+			ta_freeLayers.set_used(ta_freeLayers.size() - 1);
+			return layer;
+		}
+	}
+	return page->used++;
+}
+
+bool R_AddTextureToArray(Texture* texture, const Image* image, GLuint pbo)
+{
+	if (!ta_initialized)
+		R_InitTextureArrays();
+	if (!ta_supported || !ta_enabled || image->IsCubeMap() || image->IsVolume())
+		return false;
+	if (image->GetWidth() > TEXARRAY_MAX_SIZE || image->GetHeight() > TEXARRAY_MAX_SIZE)
+		return false;
+	GLenum format = R_PageFormat(image->_internalFormat);
+	if (format == 0)
+		return false;
+
+	texArrayPage_t* page = R_FindPage(image->GetWidth(), image->GetHeight(), format, image->GetMipLevels());
+	if (page == NULL)
+		page = R_NewPage(image, format);
+	int layer = R_TakeLayer(page);
+
+	// the whole layer goes through the pbo at once, orphaned like in
+	// Texture::UploadLevel so the copy never waits on the last transfer;
+	// the levels are then offsets into it
+	if (pbo)
+	{
+		int layerBytes = 0;
+		for (int l = 0; l < page->levels; l++)
+			layerBytes += image->GetImageSize(l);
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, layerBytes, NULL, GL_STREAM_DRAW);
+		R_GpuMemDelete(GL_BUFFER, pbo);
+		R_GpuMemAlloc(GL_BUFFER, pbo, GPUMEM_STAGING, layerBytes);
+		char* dst = (char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, layerBytes,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (dst)
+		{
+			int offset = 0;
+			for (int l = 0; l < page->levels; l++)
+			{
+				memcpy(dst + offset, image->GetLevel(l), image->GetImageSize(l));
+				offset += image->GetImageSize(l);
+			}
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		else
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			pbo = 0;
+		}
+	}
+
+	// tightly packed levels, like Texture::UploadLevel
+	glBindTexture(GL_TEXTURE_2D_ARRAY, page->name);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	int staged = 0;
+	for (int l = 0; l < page->levels; l++)
+	{
+		int w = page->width >> l;
+		int h = page->height >> l;
+		w = w ? w : 1;
+		h = h ? h : 1;
+		int size = image->GetImageSize(l);
+		const GLvoid* pixels = pbo ? (const GLvoid*)(size_t)staged : image->GetLevel(l);
+		if (image->IsCompressed())
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, layer, w, h, 1, format, size, pixels);
+		else
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, layer, w, h, 1, image->GetFormat(), image->GetType(), pixels);
+		staged += size;
+		glCounters.uploadBytes += size;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (pbo)
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// the view has sampling state of its own, the storage is the page's
+	GLuint view;
+	glGenTextures(1, &view);
+	glTextureView(view, GL_TEXTURE_2D, page->name, format, 0, page->levels, layer, 1);
+	glBindTexture(GL_TEXTURE_2D, view);
+	R_SetSampling(GL_TEXTURE_2D, page->levels);
+
+	GL_CheckError("texture array:add");
+	texture->InitLayer(view, page->name, layer, page->width, page->height);
+	return true;
+}
+
+void R_PrintTextureArrays()
+{
+	int bytes = 0;
+	int layers = 0;
+	for (unsigned int i = 0; i < ta_pages.size(); i++)
+	{
+		const texArrayPage_t& p = ta_pages[i];
+		Sys_Printf("page %u: %dx%d, %d levels, format 0x%x, %d/%d layers, %d KB\n", p.name, p.width, p.height,
+			p.levels, p.format, p.live, p.layers, p.bytes / 1024);
+		bytes += p.bytes;
+		layers += p.live;
+	}
+	Sys_Printf("texture arrays: %s, %d pages, %d textures, %d KB\n",
+		ta_supported ? (ta_enabled ? "on" : "off") : "unsupported", ta_pages.size(), layers, bytes / 1024);
+}
+
+void R_ReleaseArrayLayer(GLuint page, int layer)
+{
+	for (unsigned int i = 0; i < ta_pages.size(); i++)
+	{
+		texArrayPage_t& p = ta_pages[i];
+		if (p.name != page)
+			continue;
+
+		// an empty page goes away with its free layers
+		if (--p.live == 0)
+		{
+			for (unsigned int j = 0; j < ta_freeLayers.size(); )
+			{
+				if (ta_freeLayers[j].page == page)
+					ta_freeLayers.erase(j);
+				else
+					j++;
+			}
+			R_DeleteTexture(p.name);
+			ta_pages.erase(i);
+			return;
+		}
+
+		texArrayLayer_t freed;
+		freed.page = page;
+		freed.layer = layer;
+		ta_freeLayers.push_back(freed);
+		return;
+	}
+}
+
+void R_ShutdownTextureArrays()
+{
+	for (unsigned int i = 0; i < ta_pages.size(); i++)
+		R_DeleteTexture(ta_pages[i].name);
+	ta_pages.clear();
+	ta_freeLayers.clear();
+}
@@ -0,0 +1,56 @@
+#ifndef __TEXTUREARRAY_H__
+#define __TEXTUREARRAY_H__
+
+#include "../glutils.h"
+
+class Texture;
+class Image;
+
+#define TEXARRAY_KEYWORD		"TEXARRAY"
+#define TEXARRAY_PAGE_BYTES		(4 * 1024 * 1024)	// a page's layers fill about this, pages don't grow
+#define TEXARRAY_MIN_LAYERS		256			// gl 3's GL_MAX_ARRAY_TEXTURE_LAYERS, until queried
+#define TEXARRAY_MAX_SIZE		256			// larger textures keep their own storage
+
+/*
+===============================================================================
+
+	Texture array pages
+
+	Textures loaded through ResourceSystem with the same size, format and
+	number of levels share a GL_TEXTURE_2D_ARRAY page with immutable
+	storage, each in a layer of its own. The Texture's name becomes a 2d
+	texture view of its layer, so everything that binds it as a 2d
+	texture keeps working without a copy, and GetArrayName / GetLayer
+	tell the draws which page and layer it is.
+
+	Surfaces whose textures are layers of the same page go out in one
+	multi draw submission (see MultiDraw.h); a material that declares the
+	TEXARRAY keyword samples the page as a sampler2DArray with the layer
+	of each draw, TEXARRAY only comes together with MULTIDRAW.
+
+	Views need immutable storage, which can't drop levels, so textures
+	above TEXARRAY_MAX_SIZE are left to the streamer (TextureStreamer.h)
+	and the pages take the small ones first. Formats without a sized
+	equivalent keep their own storage too. A page is allocated for all
+	its layers up front: the first texture of a size costs the whole page,
+	as many layers as fit in TEXARRAY_PAGE_BYTES, within what the driver's
+	GL_MAX_ARRAY_TEXTURE_LAYERS allows. Layers go up through the loader's
+	pixel unpack buffer like other textures. A deleted texture gives its
+	layer back to the page, and a page without layers is deleted.
+
+===============================================================================
+*/
+
+// uploads the image into a layer of a page and makes the texture a view
+// of it, false when the texture needs storage of its own; a pbo stages
+// the upload, like Texture::Init
+bool	R_AddTextureToArray(Texture* texture, const Image* image, GLuint pbo);
+
+// a texture's layer is free for the next one of the page's size; the page
+// is deleted with its last layer
+void	R_ReleaseArrayLayer(GLuint page, int layer);
+
+void	R_PrintTextureArrays();
+void	R_ShutdownTextureArrays();
+
+#endif
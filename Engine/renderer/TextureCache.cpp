@@ -0,0 +1,179 @@
+#include "TextureCache.h"
+#include "TextureArray.h"
+#include "TextureStreamer.h"
+#include "../Image.h"
+#include "../glutils.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+#define TEXTURE_CACHE_MAGIC	0x58544c46	// "FLTX"
+#define TEXTURE_CACHE_PAGE	4096
+
+// the loader threads count into these
+typedef struct
+{
+	std::atomic<int> hits;
+	std::atomic<int> misses;
+	std::atomic<int> rejected;		// stale or damaged files
+	std::atomic<int> stored;
+	std::atomic<int> mappedBytes;
+}textureCacheStats_t;
+
+static textureCacheStats_t tc_stats;
+
+static void R_TextureCache_f(int argc, const char** argv)
+{
+	R_PrintTextureCacheStats();
+}
+
+void R_InitTextureCache()
+{
+	// a recorded run leaves the working tree alone
+	if (GL_DISK_CACHES)
+	{
+		Sys_Mkdir("cache");
+		Sys_Mkdir(TEXTURE_CACHE_DIR);
+	}
+	Cmd_AddCommand("texcache", R_TextureCache_f, "cooked texture cache stats");
+}
+
+void R_TextureCachePath(char* path, unsigned long long key)
+{
+	sprintf(path, "%s/%08x%08x.tex", TEXTURE_CACHE_DIR, (unsigned int)(key >> 32), (unsigned int)key);
+}
+
+static bool R_ValidCookedHeader(const cookedTextureHeader_t* header, unsigned long long key, int size)
+{
+	if (header->magic != TEXTURE_CACHE_MAGIC || header->version != TEXTURE_CACHE_VERSION
+		|| header->key[0] != (unsigned int)key || header->key[1] != (unsigned int)(key >> 32))
+		return false;
+	if (header->width == 0 || header->height == 0 || header->levelCount == 0
+		|| header->levelCount > TEXTURE_CACHE_MAX_LEVELS)
+		return false;
+
+	for (unsigned int l = 0; l < header->levelCount; l++)
+	{
+		if (header->levelOffsets[l] < sizeof(cookedTextureHeader_t)
+			|| header->levelOffsets[l] + header->levelSizes[l] > (unsigned int)size)
+			return false;
+	}
+	return true;
+}
+
+bool R_LoadCookedTexture(const char* path, unsigned long long key, Image& image)
+{
+	int size = 0;
+	const void* data = Sys_MapFile(path, &size);
+	if (data == NULL)
+	{
+		tc_stats.misses++;
+		return false;
+	}
+
+	const cookedTextureHeader_t* header = (const cookedTextureHeader_t*)data;
+	if (size < (int)sizeof(cookedTextureHeader_t) || !R_ValidCookedHeader(header, key, size))
+	{
+		Sys_UnmapFile(data, size);
+		remove(path);
+		tc_stats.rejected++;
+		return false;
+	}
+
+	image.FreeData();
+	image._width = header->width;
+	image._height = header->height;
+	image._depth = 0;
+	image._faces = 0;
+	image._levelCount = header->levelCount;
+	image._format = header->format;
+	image._internalFormat = header->internalFormat;
+	image._type = header->type;
+	image._elementSize = header->elementSize;
+	for (unsigned int l = 0; l < header->levelCount; l++)
+		image._data.push_back((GLubyte*)data + header->levelOffsets[l]);
+	image._mapping = data;
+	image._mappingSize = size;
+
+	// fault the pages in here, a loader thread would otherwise leave the
+	// disk reads to the upload on the main thread; of a streamed image only
+	// the levels it starts with, the streamer reads the finer ones, while
+	// whatever may go to an array page is uploaded whole
+	int firstLevel = 0;
+	if (image._width > TEXARRAY_MAX_SIZE || image._height > TEXARRAY_MAX_SIZE)
+		firstLevel = R_TextureStreamLevel(&image);
+	const volatile unsigned char* bytes = (const volatile unsigned char*)data;
+	unsigned char touch = 0;
+	for (unsigned int l = firstLevel; l < header->levelCount; l++)
+	{
+		for (unsigned int i = 0; i < header->levelSizes[l]; i += TEXTURE_CACHE_PAGE)
+			touch ^= bytes[header->levelOffsets[l] + i];
+	}
+	(void)touch;
+
+	tc_stats.hits++;
+	tc_stats.mappedBytes += size;
+	return true;
+}
+
+bool R_StoreCookedTexture(const char* path, unsigned long long key, const Image& image)
+{
+	if (image.IsCubeMap() || image.IsVolume() || image._levelCount > TEXTURE_CACHE_MAX_LEVELS)
+		return false;
+
+	cookedTextureHeader_t header;
+	memset(&header, 0, sizeof(header));
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	header.key[0] = (unsigned int)key;
+	header.key[1] = (unsigned int)(key >> 32);
+	header.width = image._width;
+	header.height = image._height;
+	header.levelCount = image._levelCount;
+	header.format = image._format;
+	header.internalFormat = image._internalFormat;
+	header.type = image._type;
+	header.elementSize = image._elementSize;
+
+	unsigned int offset = sizeof(cookedTextureHeader_t);
+	for (int l = 0; l < image._levelCount; l++)
+	{
+		offset = (offset + TEXTURE_CACHE_ALIGN - 1) & ~(TEXTURE_CACHE_ALIGN - 1);
+		header.levelOffsets[l] = offset;
+		header.levelSizes[l] = image.GetImageSize(l);
+		offset += header.levelSizes[l];
+	}
+
+	FILE* f = fopen(path, "wb");
+	if (f == NULL)
+		return false;
+
+	static const unsigned char padding[TEXTURE_CACHE_ALIGN] = { 0 };
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+	unsigned int written = sizeof(header);
+	for (int l = 0; ok && l < image._levelCount; l++)
+	{
+		unsigned int pad = header.levelOffsets[l] - written;
+		ok = (pad == 0 || fwrite(padding, pad, 1, f) == 1)
+			&& fwrite(image.GetLevel(l), header.levelSizes[l], 1, f) == 1;
+		written = header.levelOffsets[l] + header.levelSizes[l];
+	}
+	fclose(f);
+
+	if (!ok)
+	{
+		remove(path);
+		return false;
+	}
+	tc_stats.stored++;
+	return true;
+}
+
+void R_PrintTextureCacheStats()
+{
+	Sys_Printf("texture cache: %d hits, %d misses, %d rejected, %d stored, %d bytes mapped\n",
+		(int)tc_stats.hits, (int)tc_stats.misses, (int)tc_stats.rejected, (int)tc_stats.stored,
+		(int)tc_stats.mappedBytes);
+}
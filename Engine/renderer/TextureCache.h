@@ -0,0 +1,55 @@
+#ifndef __TEXTURECACHE_H__
+#define __TEXTURECACHE_H__
+
+/*
+===============================================================================
+
+	Cooked texture cache
+
+	Imported images are written out after mip generation and compression
+	in the layout they are uploaded in: a header with the gl formats and
+	the offset and size of every level, then the levels, each starting on
+	a 16 byte boundary. A cached file is mapped with Sys_MapFile and the
+	image's levels point straight into the view, so a warm start reads
+	no more than it uploads and decodes nothing; of an image that is
+	streamed only the initial levels are read at load (see
+	TextureStreamer.h). Entries are keyed by the caller (see
+	ImageImport.h); the key is stored in the header and checked on load,
+	as is the file size against the level table.
+
+===============================================================================
+*/
+
+#define TEXTURE_CACHE_DIR			"cache/textures"
+#define TEXTURE_CACHE_VERSION		1
+#define TEXTURE_CACHE_MAX_LEVELS	16
+#define TEXTURE_CACHE_ALIGN			16
+
+typedef struct
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int key[2];
+	unsigned int width;
+	unsigned int height;
+	unsigned int levelCount;
+	unsigned int format;
+	unsigned int internalFormat;
+	unsigned int type;
+	unsigned int elementSize;
+	unsigned int levelOffsets[TEXTURE_CACHE_MAX_LEVELS];	// from the start of the file
+	unsigned int levelSizes[TEXTURE_CACHE_MAX_LEVELS];
+}cookedTextureHeader_t;
+
+class Image;
+
+void	R_InitTextureCache();
+void	R_TextureCachePath(char* path, unsigned long long key);
+
+// the image keeps the view mapped until its data is freed
+bool	R_LoadCookedTexture(const char* path, unsigned long long key, Image& image);
+bool	R_StoreCookedTexture(const char* path, unsigned long long key, const Image& image);
+
+void	R_PrintTextureCacheStats();
+
+#endif
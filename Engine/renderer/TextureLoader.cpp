@@ -0,0 +1,233 @@
+#include "TextureLoader.h"
+#include "ImageImport.h"
+#include "TextureStreamer.h"
+#include "TextureArray.h"
+#include "GpuMemory.h"
+#include "../Texture.h"
+#include "../Image.h"
+#include "../glutils.h"
+#include "../common/Str.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+typedef struct
+{
+	Texture* texture;
+	lfStr file;
+	loadImageFunc func;
+	Image* image;		// NULL when the decode failed
+}texLoadJob_t;
+
+typedef struct
+{
+	int queued;
+	int uploaded;
+	int failed;
+	int uploadBytes;
+	int maxFrameBytes;
+}texLoaderStats_t;
+
+static std::mutex tl_mutex;
+static std::condition_variable tl_wake;
+static std::deque<texLoadJob_t*> tl_queued;		// waiting for a worker
+static std::deque<texLoadJob_t*> tl_decoded;	// waiting for the upload
+static int tl_decoding = 0;
+
+static xthreadInfo tl_threads[TEXLOADER_MAX_THREADS];
+static int tl_numThreads = 0;
+static bool tl_quit = false;
+
+static GLuint tl_pbo = 0;
+static int tl_budget = TEXLOADER_BUDGET;
+static texLoaderStats_t tl_stats;
+
+static unsigned int R_TextureLoaderThread(void* parms)
+{
+	for (;;)
+	{
+		texLoadJob_t* job;
+		{
+			std::unique_lock<std::mutex> lock(tl_mutex);
+			while (!tl_quit && tl_queued.empty())
+				tl_wake.wait(lock);
+			if (tl_quit)
+				return 0;
+			job = tl_queued.front();
+			tl_queued.pop_front();
+			tl_decoding++;
+		}
+
+		Image* image = new Image;
+		if (!R_ImportImage(job->file.c_str(), job->func, *image))
+		{
+			delete image;
+			image = NULL;
+		}
+		job->image = image;
+
+		std::lock_guard<std::mutex> lock(tl_mutex);
+		tl_decoded.push_back(job);
+		tl_decoding--;
+	}
+}
+
+static void R_TextureLoader_f(int argc, const char** argv)
+{
+	Sys_Printf("texture loader: %d threads, %d pending, budget %d bytes/frame\n",
+		tl_numThreads, R_NumPendingTextures(), tl_budget);
+	Sys_Printf("%d queued, %d uploaded, %d failed, %d bytes, max %d bytes in a frame\n",
+		tl_stats.queued, tl_stats.uploaded, tl_stats.failed, tl_stats.uploadBytes, tl_stats.maxFrameBytes);
+}
+
+static void R_TextureBudget_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetTextureUploadBudget(atoi(argv[1]));
+	Sys_Printf("texture upload budget %d bytes/frame\n", tl_budget);
+}
+
+static void R_StartTextureLoader()
+{
+	tl_numThreads = Sys_GetNumCpus() - 1;
+	if (tl_numThreads < 1)
+		tl_numThreads = 1;
+	if (tl_numThreads > TEXLOADER_MAX_THREADS)
+		tl_numThreads = TEXLOADER_MAX_THREADS;
+
+	tl_quit = false;
+	for (int i = 0; i < tl_numThreads; i++)
+		Sys_CreateThread(R_TextureLoaderThread, NULL, tl_threads[i], "texture loader");
+
+	Cmd_AddCommand("texloader", R_TextureLoader_f, "background texture loading stats");
+	Cmd_AddCommand("texloader_budget", R_TextureBudget_f, "texloader_budget [bytes], upload budget per frame");
+}
+
+void R_QueueTextureLoad(Texture* texture, const char* file, loadImageFunc func)
+{
+	if (tl_numThreads == 0)
+		R_StartTextureLoader();
+
+	texLoadJob_t* job = new texLoadJob_t;
+	job->texture = texture;
+	job->file = file;
+	job->func = func;
+	job->image = NULL;
+	tl_stats.queued++;
+
+	{
+		std::lock_guard<std::mutex> lock(tl_mutex);
+		tl_queued.push_back(job);
+	}
+	tl_wake.notify_one();
+}
+
+static int R_UploadTexture(texLoadJob_t* job)
+{
+	Image* image = job->image;
+	if (image == NULL)
+	{
+		Sys_Printf("load image %s failed\n", job->file.c_str());
+		tl_stats.failed++;
+		return 0;
+	}
+
+	if (tl_pbo == 0)
+		glGenBuffers(1, &tl_pbo);
+
+	int size = 0;
+	for (int l = 0; l < image->GetMipLevels(); l++)
+		size += image->GetImageSize(l);
+
+	// small textures share array pages, the streamer keeps the image of
+	// the large ones for the finer levels
+	if (!R_AddTextureToArray(job->texture, image, tl_pbo))
+	{
+		if (R_StreamTexture(job->texture, image, tl_pbo))
+			job->image = NULL;
+		else
+			job->texture->Init(image, tl_pbo);
+	}
+	tl_stats.uploaded++;
+	return size;
+}
+
+int R_UploadTextures()
+{
+	int bytes = 0;
+	while (bytes < tl_budget)
+	{
+		texLoadJob_t* job;
+		{
+			std::lock_guard<std::mutex> lock(tl_mutex);
+			if (tl_decoded.empty())
+				break;
+			job = tl_decoded.front();
+			tl_decoded.pop_front();
+		}
+
+		bytes += R_UploadTexture(job);
+		delete job->image;
+		delete job;
+	}
+
+	tl_stats.uploadBytes += bytes;
+	if (bytes > tl_stats.maxFrameBytes)
+		tl_stats.maxFrameBytes = bytes;
+	return bytes;
+}
+
+void R_FinishTextureLoads()
+{
+	int budget = tl_budget;
+	tl_budget = 0x7fffffff;
+	while (R_NumPendingTextures() > 0)
+	{
+		if (R_UploadTextures() == 0)
+			Sys_Sleep(1);
+	}
+	tl_budget = budget;
+}
+
+int R_NumPendingTextures()
+{
+	std::lock_guard<std::mutex> lock(tl_mutex);
+	return tl_queued.size() + tl_decoded.size() + tl_decoding;
+}
+
+void R_SetTextureUploadBudget(int bytes)
+{
+	tl_budget = bytes > 0 ? bytes : TEXLOADER_BUDGET;
+}
+
+void R_ShutdownTextureLoader()
+{
+	if (tl_numThreads == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(tl_mutex);
+		tl_quit = true;
+	}
+	tl_wake.notify_all();
+	for (int i = 0; i < tl_numThreads; i++)
+		Sys_JoinThread(tl_threads[i]);
+	tl_numThreads = 0;
+
+	// the textures keep their placeholders
+	while (!tl_queued.empty())
+	{
+		delete tl_queued.front();
+		tl_queued.pop_front();
+	}
+	while (!tl_decoded.empty())
+	{
+		delete tl_decoded.front()->image;
+		delete tl_decoded.front();
+		tl_decoded.pop_front();
+	}
+
+	R_DeleteBuffer(tl_pbo);
+}
@@ -0,0 +1,39 @@
+#ifndef __TEXTURELOADER_H__
+#define __TEXTURELOADER_H__
+
+#include "../ResourceSystem.h"
+
+#define TEXLOADER_MAX_THREADS	4
+#define TEXLOADER_BUDGET		(4 * 1024 * 1024)	// upload bytes per frame
+
+/*
+===============================================================================
+
+	Background texture loading
+
+	Image files are decoded on worker threads, the main thread uploads the
+	decoded images through a pixel buffer object once a frame. Uploads stop
+	once the frame's byte budget is spent, but at least one texture goes
+	up every frame so a large image can't block the queue. A queued texture
+	shows its placeholder (see Texture::InitPending) until it is uploaded,
+	and keeps showing it when the file fails to decode.
+
+===============================================================================
+*/
+
+class Texture;
+
+// workers are started on the first queued load
+void	R_QueueTextureLoad(Texture* texture, const char* file, loadImageFunc func);
+
+// main thread, once a frame; returns the bytes uploaded
+int		R_UploadTextures();
+
+// waits until everything queued is uploaded, for loading screens
+void	R_FinishTextureLoads();
+
+int		R_NumPendingTextures();
+void	R_SetTextureUploadBudget(int bytes);
+void	R_ShutdownTextureLoader();
+
+#endif
@@ -0,0 +1,395 @@
+#include "TextureStreamer.h"
+#include "GpuMemory.h"
+#include "../Texture.h"
+#include "../Image.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include "../common/array.h"
+#include <stdlib.h>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#define TEXSTREAM_PAGE		4096
+
+typedef struct
+{
+	Texture* texture;
+	Image* image;
+	int initialLevel;		// coarsest streamed level, never dropped
+	int residentLevel;		// finest level on the gpu
+	int requiredLevel;		// finest level the draws of lastUsedFrame want
+	int lastUsedFrame;
+	bool pending;			// a level is being read in
+}streamedTexture_t;
+
+typedef struct
+{
+	int id;
+	const Image* image;
+	int level;
+}streamRequest_t;
+
+typedef struct
+{
+	int requested;
+	int streamed;
+	int dropped;
+	int streamedBytes;
+}texStreamStats_t;
+
+static array<streamedTexture_t> ts_textures;
+static int ts_frame = 0;
+static int ts_residentBytes = 0;
+static int ts_budget = TEXSTREAM_BUDGET;
+static bool ts_enabled = true;
+static GLuint ts_pbo = 0;
+static texStreamStats_t ts_stats;
+
+static std::mutex ts_mutex;
+static std::condition_variable ts_wake;
+static std::deque<streamRequest_t> ts_requests;
+static std::deque<streamRequest_t> ts_ready;
+static xthreadInfo ts_thread;
+static bool ts_threadStarted = false;
+static bool ts_quit = false;
+
+// reads the level's pages in, the image data is immutable while streamed
+static unsigned int R_TextureStreamThread(void* parms)
+{
+	for (;;)
+	{
+		streamRequest_t request;
+		{
+			std::unique_lock<std::mutex> lock(ts_mutex);
+			while (!ts_quit && ts_requests.empty())
+				ts_wake.wait(lock);
+			if (ts_quit)
+				return 0;
+			request = ts_requests.front();
+			ts_requests.pop_front();
+		}
+
+		const volatile unsigned char* bytes = (const volatile unsigned char*)request.image->GetLevel(request.level);
+		int size = request.image->GetImageSize(request.level);
+		unsigned char touch = 0;
+		for (int i = 0; i < size; i += TEXSTREAM_PAGE)
+			touch ^= bytes[i];
+		(void)touch;
+
+		std::lock_guard<std::mutex> lock(ts_mutex);
+		ts_ready.push_back(request);
+	}
+}
+
+static void R_TextureStream_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetTextureStreaming(atoi(argv[1]) != 0);
+
+	int pending = 0;
+	for (unsigned int i = 0; i < ts_textures.size(); i++)
+		pending += ts_textures[i].pending;
+	Sys_Printf("texture streaming %s: %d textures, %d of %d bytes resident, %d pending\n",
+		ts_enabled ? "on" : "off", ts_textures.size(), ts_residentBytes, ts_budget, pending);
+	Sys_Printf("%d levels requested, %d streamed in (%d bytes), %d dropped\n",
+		ts_stats.requested, ts_stats.streamed, ts_stats.streamedBytes, ts_stats.dropped);
+}
+
+static void R_TextureStreamBudget_f(int argc, const char** argv)
+{
+	if (argc > 1)
+		R_SetTextureStreamBudget(atoi(argv[1]) * 1024 * 1024);
+	Sys_Printf("texture stream budget %d MB\n", ts_budget / (1024 * 1024));
+}
+
+static int R_EvictStreamedLevels(int bytes);
+
+static void R_StartTextureStreamer()
+{
+	ts_quit = false;
+	Sys_CreateThread(R_TextureStreamThread, NULL, ts_thread, "texture streamer");
+	ts_threadStarted = true;
+	R_AddGpuMemEvictor(R_EvictStreamedLevels);
+
+	Cmd_AddCommand("texstream", R_TextureStream_f, "texture streaming stats, texstream 0/1 toggles it for new textures");
+	Cmd_AddCommand("texstream_budget", R_TextureStreamBudget_f, "texstream_budget [MB], resident bytes of streamed textures");
+}
+
+int R_TextureStreamLevel(const Image* image)
+{
+	if (!ts_enabled || image->IsCubeMap() || image->IsVolume() || image->GetMipLevels() < 2)
+		return 0;
+
+	int initialLevel = 0;
+	while (initialLevel < image->GetMipLevels() - 1
+		&& ((image->GetWidth() >> initialLevel) > TEXSTREAM_INITIAL_SIZE || (image->GetHeight() >> initialLevel) > TEXSTREAM_INITIAL_SIZE))
+		initialLevel++;
+	return initialLevel;
+}
+
+bool R_StreamTexture(Texture* texture, Image* image, GLuint pbo)
+{
+	int initialLevel = R_TextureStreamLevel(image);
+	if (initialLevel == 0)
+		return false;
+
+	if (!ts_threadStarted)
+		R_StartTextureStreamer();
+
+	texture->Init(image, pbo, initialLevel);
+	texture->_streamId = ts_textures.size();
+	for (int l = initialLevel; l < image->GetMipLevels(); l++)
+		image->ReleaseLevel(l);
+
+	streamedTexture_t t;
+	t.texture = texture;
+	t.image = image;
+	t.initialLevel = initialLevel;
+	t.residentLevel = initialLevel;
+	t.requiredLevel = initialLevel;
+	t.lastUsedFrame = -1;
+	t.pending = false;
+	ts_textures.push_back(t);
+	return true;
+}
+
+static void R_MarkLevel(Texture* texture, float pixels)
+{
+	if (texture == NULL || texture->_streamId < 0)
+		return;
+
+	streamedTexture_t& t = ts_textures[texture->_streamId];
+	int size = texture->_pixelsWide > texture->_pixelsHigh ? texture->_pixelsWide : texture->_pixelsHigh;
+	int level = 0;
+	while (level < t.initialLevel && (size >> (level + 1)) >= pixels)
+		level++;
+
+	if (t.lastUsedFrame != ts_frame || level < t.requiredLevel)
+		t.requiredLevel = level;
+	t.lastUsedFrame = ts_frame;
+}
+
+void R_MarkTextureUsage(const drawSurf_t* surf, int screenWidth, int screenHeight)
+{
+	if (surf->shaderParms == NULL || surf->geo == NULL || surf->viewProj == NULL)
+		return;
+
+	Texture* tex = surf->shaderParms->tex;
+	Texture* bump = surf->shaderParms->bumpMap;
+	if ((tex == NULL || tex->_streamId < 0) && (bump == NULL || bump->_streamId < 0))
+		return;
+
+	// screen extent of the bounds, taken as the texture's footprint; a
+	// corner behind the eye means the surface is close, so full size
+	mat4 mvp = (*surf->viewProj) * surf->matModel;
+	const aabb3d& bounds = surf->geo->aabb;
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+	bool behind = false;
+	for (int i = 0; i < 8; i++)
+	{
+		vec3 corner((i & 1) ? bounds._max.x : bounds._min.x,
+			(i & 2) ? bounds._max.y : bounds._min.y,
+			(i & 4) ? bounds._max.z : bounds._min.z);
+		vec4 clip = mvp * vec4(corner, 1.0f);
+		if (clip.w <= 0.0f)
+		{
+			behind = true;
+			break;
+		}
+		float x = clip.x / clip.w;
+		float y = clip.y / clip.w;
+		minX = x < minX ? x : minX;
+		maxX = x > maxX ? x : maxX;
+		minY = y < minY ? y : minY;
+		maxY = y > maxY ? y : maxY;
+	}
+
+	float pixels;
+	if (behind)
+		pixels = (float)(screenWidth > screenHeight ? screenWidth : screenHeight);
+	else
+	{
+		float w = (maxX - minX) * 0.5f * screenWidth;
+		float h = (maxY - minY) * 0.5f * screenHeight;
+		pixels = w > h ? w : h;
+	}
+
+	R_MarkLevel(tex, pixels);
+	R_MarkLevel(bump, pixels);
+}
+
+void R_MarkTextureFullSize(const drawSurf_t* surf)
+{
+	if (surf->shaderParms == NULL)
+		return;
+	R_MarkLevel(surf->shaderParms->tex, 1e30f);
+	R_MarkLevel(surf->shaderParms->bumpMap, 1e30f);
+}
+
+static int R_LevelBytes(const streamedTexture_t& t, int level)
+{
+	return t.image->GetImageSize(level);
+}
+
+// least recently drawn first, then textures drawn in protectFrame finer
+// than they need
+static int R_DropOneLevel(int protectFrame)
+{
+	int best = -1;
+	int bestFrame = 0x7fffffff;
+	for (unsigned int i = 0; i < ts_textures.size(); i++)
+	{
+		const streamedTexture_t& t = ts_textures[i];
+		if (t.residentLevel >= t.initialLevel)
+			continue;
+		// drawn this frame, only what is finer than the draws want
+		if (t.lastUsedFrame == protectFrame && t.residentLevel >= t.requiredLevel)
+			continue;
+		if (t.lastUsedFrame < bestFrame)
+		{
+			bestFrame = t.lastUsedFrame;
+			best = i;
+		}
+	}
+	if (best < 0)
+		return 0;
+
+	streamedTexture_t& t = ts_textures[best];
+	int size = R_LevelBytes(t, t.residentLevel);
+	t.texture->DropLevel(t.image, t.residentLevel);
+	ts_residentBytes -= size;
+	t.residentLevel++;
+	ts_stats.dropped++;
+	return size;
+}
+
+// gpu memory over its budget, runs after the frame so the textures of the
+// frame just drawn keep what they want
+static int R_EvictStreamedLevels(int bytes)
+{
+	int freed = 0;
+	while (freed < bytes)
+	{
+		int size = R_DropOneLevel(ts_frame - 1);
+		if (size == 0)
+			break;
+		freed += size;
+	}
+	return freed;
+}
+
+static void R_UploadStreamedLevels()
+{
+	int bytes = 0;
+	while (bytes < TEXSTREAM_UPLOAD_BUDGET)
+	{
+		streamRequest_t request;
+		{
+			std::lock_guard<std::mutex> lock(ts_mutex);
+			if (ts_ready.empty())
+				break;
+			request = ts_ready.front();
+			ts_ready.pop_front();
+		}
+
+		streamedTexture_t& t = ts_textures[request.id];
+		t.pending = false;
+		if (request.level != t.residentLevel - 1)
+		{
+			t.image->ReleaseLevel(request.level);
+			continue;
+		}
+
+		if (ts_pbo == 0)
+			glGenBuffers(1, &ts_pbo);
+
+		int size = R_LevelBytes(t, request.level);
+		glBindTexture(GL_TEXTURE_2D, t.texture->GetName());
+		t.texture->UploadLevel(t.image, request.level, ts_pbo);
+		t.image->ReleaseLevel(request.level);
+		t.texture->SetBaseLevel(request.level);
+		t.residentLevel = request.level;
+		ts_residentBytes += size;
+		ts_stats.streamed++;
+		ts_stats.streamedBytes += size;
+		bytes += size;
+	}
+}
+
+void R_UpdateTextureStreaming()
+{
+	if (ts_textures.size() == 0)
+		return;
+
+	R_UploadStreamedLevels();
+
+	// a lowered budget takes effect right away
+	while (ts_residentBytes > ts_budget && R_DropOneLevel(ts_frame))
+		;
+
+	for (unsigned int i = 0; i < ts_textures.size(); i++)
+	{
+		streamedTexture_t& t = ts_textures[i];
+		if (t.pending || t.lastUsedFrame != ts_frame || t.requiredLevel >= t.residentLevel)
+			continue;
+
+		int level = t.residentLevel - 1;
+		int size = R_LevelBytes(t, level);
+		while (ts_residentBytes + size > ts_budget && R_DropOneLevel(ts_frame))
+			;
+		if (ts_residentBytes + size > ts_budget)
+			continue;
+
+		streamRequest_t request;
+		request.id = i;
+		request.image = t.image;
+		request.level = level;
+		t.pending = true;
+		ts_stats.requested++;
+		{
+			std::lock_guard<std::mutex> lock(ts_mutex);
+			ts_requests.push_back(request);
+		}
+		ts_wake.notify_one();
+	}
+
+	ts_frame++;
+}
+
+void R_SetTextureStreaming(bool enable)
+{
+	ts_enabled = enable;
+}
+
+void R_SetTextureStreamBudget(int bytes)
+{
+	ts_budget = bytes > 0 ? bytes : TEXSTREAM_BUDGET;
+}
+
+void R_ShutdownTextureStreamer()
+{
+	if (ts_threadStarted)
+	{
+		{
+			std::lock_guard<std::mutex> lock(ts_mutex);
+			ts_quit = true;
+		}
+		ts_wake.notify_all();
+		Sys_JoinThread(ts_thread);
+		ts_threadStarted = false;
+	}
+
+	// the textures keep the levels they have
+	ts_requests.clear();
+	ts_ready.clear();
+	for (unsigned int i = 0; i < ts_textures.size(); i++)
+	{
+		ts_textures[i].texture->_streamId = -1;
+		delete ts_textures[i].image;
+	}
+	ts_textures.clear();
+	ts_residentBytes = 0;
+
+	R_DeleteBuffer(ts_pbo);
+}
@@ -0,0 +1,64 @@
+#ifndef __TEXTURESTREAMER_H__
+#define __TEXTURESTREAMER_H__
+
+#include "../r_public.h"
+
+#define TEXSTREAM_BUDGET			(64 * 1024 * 1024)	// resident bytes of streamed textures
+#define TEXSTREAM_UPLOAD_BUDGET		(2 * 1024 * 1024)	// streamed in per frame
+#define TEXSTREAM_INITIAL_SIZE		64					// largest level resident from the start
+
+/*
+===============================================================================
+
+	Texture streaming
+
+	Images with a mip chain (cooked or dds) start out with only the levels
+	up to TEXSTREAM_INITIAL_SIZE resident; the streamer keeps the image and
+	brings the finer levels in when they are needed. Every frame the draw
+	list marks the level each visible surface wants, from the size of its
+	projected bounds against the texture size. One level at a time per
+	texture is read in on a worker thread (faulting in the mapped pages)
+	and uploaded on the main thread under a per-frame byte budget, then the
+	base level is lowered.
+
+	A cooked image is a view of its cache file: loading reads only the
+	initial levels, the worker reads a finer level when it is requested,
+	and the pages of every level are dropped once it is uploaded, so an
+	evicted level is read from the file again. Images loaded into memory
+	(dds) keep all of their levels.
+
+	Streamed levels are kept under a resident budget. When a level doesn't
+	fit, the finest level of the least recently drawn texture is dropped,
+	then levels finer than what a drawn texture wants; the initial levels
+	always stay. The streamer is also an evictor of the gpu memory budget
+	(see GpuMemory.h).
+
+===============================================================================
+*/
+
+class Texture;
+class Image;
+
+// uploads the initial levels and takes the image when the texture is
+// streamed; false leaves both to the caller
+bool	R_StreamTexture(Texture* texture, Image* image, GLuint pbo);
+
+// coarsest level the image would be streamed from, 0 when it would be
+// uploaded whole; loader threads ask it before reading the levels in
+int		R_TextureStreamLevel(const Image* image);
+
+// draw list stage, for every visible surface before R_UpdateTextureStreaming
+void	R_MarkTextureUsage(const drawSurf_t* surf, int screenWidth, int screenHeight);
+
+// the same for surfaces without usable bounds, ui and billboard sprites,
+// which want every level
+void	R_MarkTextureFullSize(const drawSurf_t* surf);
+
+// main thread once a frame: uploads what was read in, evicts, requests
+void	R_UpdateTextureStreaming();
+
+void	R_SetTextureStreaming(bool enable);
+void	R_SetTextureStreamBudget(int bytes);
+void	R_ShutdownTextureStreamer();
+
+#endif
@@ -46,6 +46,19 @@ void R_RenderShadowMap( drawSurf_t* drawSur, DrawFunc drawFunc ) {
 	GL_CheckError("draw common");
 }
 
+void R_RenderDepth( drawSurf_t* drawSurf, Shader* shader ) {
+	mat4 t = (*drawSurf->viewProj) * drawSurf->matModel;
+
+	glEnableVertexAttribArray(0);
+
+	glUseProgram( shader->GetProgarm() );
+	glUniformMatrix4fv( shader->GetUniform(eUniform_MVP), 1, GL_FALSE, &t.m[0] );
+
+	R_DrawPositon(drawSurf->geo);
+
+	glDisableVertexAttribArray(0);
+}
+
 void R_RenderPhongPass( drawSurf_t* drawSurf, DrawFunc drawFunc ) {
 	srfTriangles_t* tri = drawSurf->geo;
 	material_t* material = drawSurf->shaderParms;
@@ -81,12 +94,19 @@ void R_RenderPhongPass( drawSurf_t* drawSurf, DrawFunc drawFunc ) {
 	GL_CheckError("R_RenderPhongPass error2");
 }
 
+void RB_DrawTriangles( const srfTriangles_t* tri ) {
+	// the surface's ranges in the arena buffers bound by the caller
+	glDrawElementsBaseVertex(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT,
+		(GLvoid *)(size_t)(tri->indexRange.offset * sizeof(glIndex_t)), tri->vertexRange.offset);
+	glCounters.drawCalls++;
+}
+
 void R_DrawPositon( srfTriangles_t* tri ) {
 	glBindBuffer(GL_ARRAY_BUFFER, tri->vbo[0]);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawVert), 0);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glDrawElements(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT, 0);
+	RB_DrawTriangles(tri);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -98,7 +118,7 @@ void R_DrawPositonTex( srfTriangles_t* tri ) {
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(DrawVert), (GLvoid *)12);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glDrawElements(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT, 0);
+	RB_DrawTriangles(tri);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -111,7 +131,7 @@ void R_DrawPositionTexNorm( srfTriangles_t* tri ) {
 	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(DrawVert), (GLvoid *)20);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glDrawElements(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT, 0);
+	RB_DrawTriangles(tri);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -134,6 +154,22 @@ void RB_DrawBounds( aabb3d* aabb3d ) {
 							 4, 5, 5, 6, 6, 7, 7, 4};
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, vertices);
 	glDrawElements(GL_LINES, 24, GL_UNSIGNED_SHORT, indices);
+	glCounters.drawCalls++;
+}
+
+void RB_DrawFullscreenQuad() {
+	static const float vertices[] = { -1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f };
+	static const float texcoords[] = { 0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f };
+	static const unsigned short indices[] = { 0, 1, 2, 0, 2, 3 };
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, texcoords);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, indices);
+	glCounters.drawCalls++;
 }
 
 void R_RenderBumpPass( drawSurf_t* drawSurf, DrawFunc drawFunc ) {
@@ -187,7 +223,7 @@ void R_DrawPositonTangent( srfTriangles_t* tri ) {
 	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(DrawVert), (GLvoid *)44);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glDrawElements(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT, 0);
+	RB_DrawTriangles(tri);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -8,8 +8,14 @@ void R_RenderPTPass(drawSurf_t* drawSur, DrawFunc drawFunc);
 
 void R_RenderShadowMap(drawSurf_t* drawSur, DrawFunc drawFunc);
 
+// depth only, shader is the position shader
+void R_RenderDepth(drawSurf_t* drawSurf, Shader* shader);
+
 void R_RenderPhongPass(drawSurf_t* drawSurf, DrawFunc drawFunc);
 
+// indexed triangles of the bound arena buffers (see GeometryArena.h)
+void RB_DrawTriangles( const srfTriangles_t* tri );
+
 void R_DrawPositonTex( srfTriangles_t* tri );
 
 void R_DrawPositon( srfTriangles_t* tri );
@@ -18,6 +24,9 @@ void R_DrawPositionTexNorm( srfTriangles_t* tri );
 
 void RB_DrawBounds( aabb3d* aabb3d );
 
+// two triangles covering the viewport, position in attrib 0, texcoord in 1
+void RB_DrawFullscreenQuad();
+
 void R_RenderBumpPass( drawSurf_t* drawSurf, DrawFunc drawFunc );
 
 void R_DrawPositonTangent( srfTriangles_t* tri);
@@ -25,6 +34,10 @@ void R_DrawPositonTangent( srfTriangles_t* tri);
 // draw common version 2
 void R_RenderCommon(drawSurf_t* drawSurf);
 
+// the surfaces in order, runs that share program, texture and buffers
+// are merged into multi draws where the context allows
+void R_RenderCommonList(drawSurf_t** surfs, int count);
+
 //void R_DrawCommon( srfTriangles_t* tri, unsigned short *attri, unsigned short numAttri );
 #endif
 
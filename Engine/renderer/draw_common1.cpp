@@ -6,6 +6,8 @@
 #include "../DrawVert.h"
 #include "../sys/sys_public.h"
 #include "../Material.h"
+#include "MultiDraw.h"
+#include "TextureArray.h"
 
 static void R_BindArrayBuffer(int i) {
 	switch (i) {
@@ -37,7 +39,7 @@ static void R_DrawCommon( srfTriangles_t* tri, unsigned short *attri, unsigned s
 	}
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tri->vbo[1]);
-	glDrawElements(GL_TRIANGLES, tri->numIndexes, GL_UNSIGNED_SHORT, 0);
+	RB_DrawTriangles(tri);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -46,13 +48,24 @@ static void R_DrawCommon( srfTriangles_t* tri, unsigned short *attri, unsigned s
 void R_RenderCommon(drawSurf_t* drawSurf){
 	Material* mtr = drawSurf->mtr;
 	srfTriangles_t* tri = drawSurf->geo;
+	int variant = drawSurf->variant;
 	if (mtr == NULL)
 	{
 		return;
 	}
+
+	// still compiling, draw flat until the program links
+	if (!mtr->IsVariantReady(variant))
+	{
+		mtr = R_FallbackMaterial();
+		variant = 0;
+		if (mtr == NULL || !mtr->IsVariantReady(0))
+			return;
+	}
+
 	unsigned short* attri = mtr->_attriArr;
 	unsigned short numAttri = mtr->_numAttri;
-	Shader* shader = &mtr->_shader;
+	Shader* shader = mtr->GetShader(variant);
 
 	for (int i = 0; i < numAttri; i++)
 		glEnableVertexAttribArray(attri[i]);
@@ -79,3 +92,127 @@ void R_RenderCommon(drawSurf_t* drawSurf){
 		glEnableVertexAttribArray(attri[i]);
 }
 
+// consecutive surfaces that can share a submission, see MultiDraw.h
+static bool R_SameBatch(const drawSurf_t* a, const drawSurf_t* b)
+{
+	if (a->mtr != b->mtr || a->variant != b->variant || b->geo == NULL)
+		return false;
+	if (a->viewProj == NULL || b->viewProj == NULL)
+		return false;
+	if (a->geo->vbo[0] != b->geo->vbo[0] || a->geo->vbo[1] != b->geo->vbo[1])
+		return false;
+	if (!a->mtr->_hasTexture)
+		return true;
+
+	Texture* ta = a->shaderParms->tex;
+	Texture* tb = b->shaderParms->tex;
+	if (ta->GetName() == tb->GetName())
+		return true;
+	// other layers of the same page, sampled as an array
+	return ta->GetArrayName() != 0 && ta->GetArrayName() == tb->GetArrayName()
+		&& a->mtr->KeywordMask(TEXARRAY_KEYWORD) != 0;
+}
+
+// the batch samples the page of its first texture, see TextureArray.h
+static bool R_BatchTextureArray(const drawSurf_t* first)
+{
+	return first->mtr->_hasTexture && first->shaderParms->tex->GetArrayName() != 0
+		&& first->mtr->KeywordMask(TEXARRAY_KEYWORD) != 0;
+}
+
+// the MULTIDRAW (and TEXARRAY) variant next to the surface's, -1 until
+// it links
+static int R_MultiDrawVariant(Material* mtr, int variant, bool textureArray)
+{
+	unsigned int bit = mtr->KeywordMask(MULTIDRAW_KEYWORD);
+	if (bit == 0)
+		return -1;
+	if (textureArray)
+		bit |= mtr->KeywordMask(TEXARRAY_KEYWORD);
+	if (variant < 0 || variant >= (int)mtr->_variants.size())
+		variant = 0;
+
+	int multiDraw = mtr->Variant(mtr->_variants[variant].mask | bit);
+	return mtr->IsVariantReady(multiDraw) ? multiDraw : -1;
+}
+
+static array<const srfTriangles_t*> rb_batchTris;
+static array<mat4> rb_batchMvps;
+static array<int> rb_batchLayers;
+
+static void R_RenderCommonBatch(drawSurf_t** surfs, int count, int variant) {
+	drawSurf_t* first = surfs[0];
+	Material* mtr = first->mtr;
+	unsigned short* attri = mtr->_attriArr;
+	unsigned short numAttri = mtr->_numAttri;
+	Shader* shader = mtr->GetShader(variant);
+	bool textureArray = R_BatchTextureArray(first);
+
+	rb_batchTris.set_used(count);
+	rb_batchMvps.set_used(count);
+	rb_batchLayers.set_used(count);
+	for (int i = 0; i < count; i++)
+	{
+		rb_batchTris[i] = surfs[i]->geo;
+		rb_batchMvps[i] = (*surfs[i]->viewProj) * surfs[i]->matModel;
+		if (textureArray)
+			rb_batchLayers[i] = surfs[i]->shaderParms->tex->GetLayer();
+	}
+
+	for (int i = 0; i < numAttri; i++)
+		glEnableVertexAttribArray(attri[i]);
+
+	glUseProgram(shader->GetProgarm());
+
+	if (mtr->_hasColor)
+		glUniform3f(shader->GetUniform(eUniform_Color), 1.0, 0.0, 0.0);
+
+	if (mtr->_hasTexture)
+	{
+		glUniform1i( shader->GetUniform(eUniform_Samper0), 0 );
+		if (textureArray)
+			glBindTexture( GL_TEXTURE_2D_ARRAY, first->shaderParms->tex->GetArrayName() );
+		else
+			glBindTexture( GL_TEXTURE_2D, first->shaderParms->tex->GetName() );
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, first->geo->vbo[0]);
+	for (int i = 0; i < numAttri; i++)
+		R_BindArrayBuffer(attri[i]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, first->geo->vbo[1]);
+
+	RB_MultiDrawTriangles(rb_batchTris.const_pointer(), rb_batchMvps.const_pointer(),
+		textureArray ? rb_batchLayers.const_pointer() : NULL, count);
+	if (textureArray)
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	for (int i = 0; i < numAttri; i++)
+		glDisableVertexAttribArray(attri[i]);
+}
+
+void R_RenderCommonList(drawSurf_t** surfs, int count){
+	bool multiDraw = R_MultiDrawPath() != MULTIDRAW_NONE;
+	int i = 0;
+	while (i < count)
+	{
+		int end = i + 1;
+		if (multiDraw && surfs[i]->mtr != NULL && surfs[i]->geo != NULL)
+		{
+			while (end < count && R_SameBatch(surfs[i], surfs[end]))
+				end++;
+		}
+
+		int variant = end - i > 1 ? R_MultiDrawVariant(surfs[i]->mtr, surfs[i]->variant, R_BatchTextureArray(surfs[i])) : -1;
+		if (variant >= 0)
+			R_RenderCommonBatch(surfs + i, end - i, variant);
+		else
+		{
+			for (int j = i; j < end; j++)
+				R_RenderCommon(surfs[j]);
+		}
+		i = end;
+	}
+}
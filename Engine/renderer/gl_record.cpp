@@ -0,0 +1,1381 @@
+#include "../glutils.h"
+#include "gl_record.h"
+#include "../common/array.h"
+#include "../sys/sys_public.h"
+#include "../framework/CmdSystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REC_MAX_ARGS	0xffff
+#define REC_MAX_UNITS	32
+#define REC_MAX_CAPS	32
+#define REC_UNKNOWN		0xffffffff
+#define REC_CLIENT_PTR	0xfffffffe		// vertex data that lives in client memory
+
+static const char* rec_opNames[eRec_Count] =
+{
+#define REC_CMD(name) #name,
+	REC_COMMANDS
+#undef REC_CMD
+};
+
+// the bound objects and fixed function state, enough to tell a call that
+// changes something from one that repeats what is already set
+typedef struct
+{
+	unsigned int	program;
+	unsigned int	activeUnit;
+	unsigned int	textures[REC_MAX_UNITS];
+	unsigned int	arrayBuffer;
+	unsigned int	elementBuffer;
+	unsigned int	unpackBuffer;
+	unsigned int	framebuffer;
+	unsigned int	renderbuffer;
+	unsigned int	caps[REC_MAX_CAPS];
+	unsigned int	capBits;
+	int				numCaps;
+	unsigned int	attribBits;
+	unsigned int	blend[2];
+	unsigned int	depthFunc;
+	unsigned int	depthMask;
+	unsigned int	colorMask;
+	unsigned int	cullFace;
+	unsigned int	frontFace;
+	unsigned int	stencilFunc[3];
+	unsigned int	stencilOp[3];
+	unsigned int	viewport[4];
+}recState_t;
+
+static void Rec_ClearState(recState_t* s)
+{
+	memset(s, 0xff, sizeof(recState_t));
+	s->program = 0;
+	s->activeUnit = 0;
+	memset(s->textures, 0, sizeof(s->textures));
+	s->arrayBuffer = 0;
+	s->elementBuffer = 0;
+	s->unpackBuffer = 0;
+	s->framebuffer = 0;
+	s->renderbuffer = 0;
+	s->capBits = 0;
+	s->numCaps = 0;
+	s->attribBits = 0;
+}
+
+static void Rec_Set(recStats_t* stats, unsigned int* slot, unsigned int value)
+{
+	if (*slot == value)
+	{
+		stats->redundantState++;
+		return;
+	}
+	*slot = value;
+	stats->stateChanges++;
+}
+
+static void Rec_SetN(recStats_t* stats, unsigned int* slots, const unsigned int* values, int n)
+{
+	if (memcmp(slots, values, n * sizeof(unsigned int)) == 0)
+	{
+		stats->redundantState++;
+		return;
+	}
+	memcpy(slots, values, n * sizeof(unsigned int));
+	stats->stateChanges++;
+}
+
+static void Rec_SetBit(recStats_t* stats, unsigned int* bits, unsigned int bit, bool on)
+{
+	if (bit >= 32)
+	{
+		stats->stateChanges++;
+		return;
+	}
+	unsigned int value = on ? (*bits | (1u << bit)) : (*bits & ~(1u << bit));
+	Rec_Set(stats, bits, value);
+}
+
+static unsigned int Rec_CapIndex(recState_t* s, unsigned int cap)
+{
+	for (int i = 0; i < s->numCaps; i++)
+	{
+		if (s->caps[i] == cap)
+			return i;
+	}
+	if (s->numCaps == REC_MAX_CAPS)
+		return REC_MAX_CAPS;
+	s->caps[s->numCaps] = cap;
+	return s->numCaps++;
+}
+
+// everything the counters know comes from here, so recording and replaying
+// a log always agree
+static void Rec_Track(recState_t* s, recStats_t* stats, int op, const unsigned int* args)
+{
+	stats->commands++;
+	stats->opCounts[op]++;
+
+	switch (op)
+	{
+	case eRec_SwapBuffers:
+		stats->frames++;
+		break;
+	case eRec_ActiveTexture:
+		Rec_Set(stats, &s->activeUnit, (args[0] - GL_TEXTURE0) % REC_MAX_UNITS);
+		break;
+	case eRec_BindTexture:
+		Rec_Set(stats, &s->textures[s->activeUnit], args[1]);
+		break;
+	case eRec_BindBuffer:
+		if (args[0] == GL_ARRAY_BUFFER)
+			Rec_Set(stats, &s->arrayBuffer, args[1]);
+		else if (args[0] == GL_ELEMENT_ARRAY_BUFFER)
+			Rec_Set(stats, &s->elementBuffer, args[1]);
+		else if (args[0] == GL_PIXEL_UNPACK_BUFFER)
+			Rec_Set(stats, &s->unpackBuffer, args[1]);
+		else
+			stats->stateChanges++;
+		break;
+	case eRec_BindFramebuffer:
+		Rec_Set(stats, &s->framebuffer, args[1]);
+		break;
+	case eRec_BindRenderbuffer:
+		Rec_Set(stats, &s->renderbuffer, args[1]);
+		break;
+	case eRec_UseProgram:
+		Rec_Set(stats, &s->program, args[0]);
+		break;
+	case eRec_Enable:
+	case eRec_Disable:
+		Rec_SetBit(stats, &s->capBits, Rec_CapIndex(s, args[0]), op == eRec_Enable);
+		break;
+	case eRec_EnableVertexAttribArray:
+	case eRec_DisableVertexAttribArray:
+		Rec_SetBit(stats, &s->attribBits, args[0], op == eRec_EnableVertexAttribArray);
+		break;
+	case eRec_BlendFunc:
+		Rec_SetN(stats, s->blend, args, 2);
+		break;
+	case eRec_DepthFunc:
+		Rec_Set(stats, &s->depthFunc, args[0]);
+		break;
+	case eRec_DepthMask:
+		Rec_Set(stats, &s->depthMask, args[0]);
+		break;
+	case eRec_ColorMask:
+		Rec_Set(stats, &s->colorMask, (args[0] ? 1 : 0) | (args[1] ? 2 : 0) | (args[2] ? 4 : 0) | (args[3] ? 8 : 0));
+		break;
+	case eRec_CullFace:
+		Rec_Set(stats, &s->cullFace, args[0]);
+		break;
+	case eRec_FrontFace:
+		Rec_Set(stats, &s->frontFace, args[0]);
+		break;
+	case eRec_StencilFunc:
+		Rec_SetN(stats, s->stencilFunc, args, 3);
+		break;
+	case eRec_StencilOp:
+		Rec_SetN(stats, s->stencilOp, args, 3);
+		break;
+	case eRec_Viewport:
+		Rec_SetN(stats, s->viewport, args, 4);
+		break;
+	case eRec_DrawElements:
+	case eRec_DrawElementsBaseVertex:
+		stats->drawCalls++;
+		stats->indices += args[1];
+		break;
+	case eRec_DrawArraysInstanced:
+		stats->drawCalls++;
+		break;
+	case eRec_MultiDrawElementsBaseVertex:
+		stats->drawCalls++;
+		stats->indices += args[2];
+		break;
+	case eRec_MultiDrawElementsIndirect:
+		// the counts are in the indirect buffer, which isn't logged
+		stats->drawCalls++;
+		break;
+	case eRec_Begin:
+		stats->drawCalls++;
+		break;
+	case eRec_BufferData:
+		// storage allocated without data isn't an upload
+		if (args[2] != 0)
+			stats->uploadBytes += args[1];
+		break;
+	case eRec_BufferSubData:
+		stats->uploadBytes += args[2];
+		break;
+	case eRec_TexImage2D:
+		stats->uploadBytes += args[7];
+		break;
+	case eRec_CompressedTexImage2D:
+		stats->uploadBytes += args[5];
+		break;
+	case eRec_TexSubImage3D:
+		stats->uploadBytes += args[8];
+		break;
+	case eRec_CompressedTexSubImage3D:
+		stats->uploadBytes += args[7];
+		break;
+	case eRec_GenBuffers:
+	case eRec_GenFramebuffers:
+	case eRec_GenQueries:
+	case eRec_GenRenderbuffers:
+	case eRec_GenTextures:
+		stats->objects += args[0];
+		break;
+	case eRec_DeleteBuffers:
+	case eRec_DeleteFramebuffers:
+	case eRec_DeleteQueries:
+	case eRec_DeleteRenderbuffers:
+	case eRec_DeleteTextures:
+		stats->objects -= args[0];
+		break;
+	case eRec_CreateProgram:
+	case eRec_CreateShader:
+		stats->objects++;
+		break;
+	case eRec_DeleteProgram:
+	case eRec_DeleteShader:
+		if (args[0] != 0)
+			stats->objects--;
+		break;
+	default:
+		break;
+	}
+}
+
+const char* Rec_OpName(int op)
+{
+	if (op < 0 || op >= eRec_Count)
+		return "?";
+	return rec_opNames[op];
+}
+
+void Rec_PrintStats(const recStats_t& stats)
+{
+	int frames = stats.frames > 0 ? stats.frames : 1;
+	Sys_Printf("%d frames, %d commands, %d live objects\n", stats.frames, stats.commands, stats.objects);
+	Sys_Printf("draw calls %d (%.1f/frame), indices %d\n", stats.drawCalls, stats.drawCalls / (float)frames, stats.indices);
+	Sys_Printf("state changes %d (%.1f/frame), redundant %d\n", stats.stateChanges, stats.stateChanges / (float)frames, stats.redundantState);
+	Sys_Printf("upload bytes %d\n", stats.uploadBytes);
+	for (int i = 0; i < eRec_Count; i++)
+	{
+		if (stats.opCounts[i] > 0)
+			Sys_Printf("  %-26s %d\n", rec_opNames[i], stats.opCounts[i]);
+	}
+}
+
+/*
+===============================================================================
+
+	Saved logs
+
+===============================================================================
+*/
+
+static bool Rec_ReadLog(const char* filename, array<unsigned int>& words)
+{
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL)
+	{
+		Sys_Printf("rec: can't open %s\n", filename);
+		return false;
+	}
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	words.set_used(size / sizeof(unsigned int));
+	size_t count = fread(words.pointer(), sizeof(unsigned int), words.size(), f);
+	fclose(f);
+
+	if (count < 2 || words[0] != REC_LOG_MAGIC || words[1] != REC_LOG_VERSION)
+	{
+		Sys_Printf("rec: %s is not a version %d command log\n", filename, REC_LOG_VERSION);
+		return false;
+	}
+	return true;
+}
+
+// position of the command after the one at pos, 0 at the end of the log
+static unsigned int Rec_NextCommand(const array<unsigned int>& words, unsigned int pos)
+{
+	if (pos >= words.size())
+		return 0;
+	unsigned int next = pos + 1 + (words[pos] & 0xffff);
+	if (next > words.size() || (words[pos] >> 16) >= eRec_Count)
+		return 0;
+	return next;
+}
+
+static void Rec_PrintCommand(int index, const unsigned int* cmd)
+{
+	char line[256];
+	int numArgs = cmd[0] & 0xffff;
+	int len = sprintf(line, "%6d %s", index, Rec_OpName(cmd[0] >> 16));
+	for (int i = 0; i < numArgs && len < 200; i++)
+		len += sprintf(line + len, " %x", cmd[1 + i]);
+	Sys_Printf("%s\n", line);
+}
+
+bool Rec_Replay(const char* filename, recStats_t* stats)
+{
+	array<unsigned int> words;
+	if (!Rec_ReadLog(filename, words))
+		return false;
+
+	recState_t state;
+	Rec_ClearState(&state);
+	memset(stats, 0, sizeof(recStats_t));
+
+	unsigned int pos = 2;
+	while (pos < words.size())
+	{
+		unsigned int next = Rec_NextCommand(words, pos);
+		if (next == 0)
+		{
+			Sys_Printf("rec: %s is truncated at word %d\n", filename, pos);
+			return false;
+		}
+		Rec_Track(&state, stats, words[pos] >> 16, &words[pos + 1]);
+		pos = next;
+	}
+	return true;
+}
+
+bool Rec_DumpLog(const char* filename, int maxCommands)
+{
+	array<unsigned int> words;
+	if (!Rec_ReadLog(filename, words))
+		return false;
+
+	unsigned int pos = 2;
+	for (int i = 0; pos < words.size() && (maxCommands <= 0 || i < maxCommands); i++)
+	{
+		unsigned int next = Rec_NextCommand(words, pos);
+		if (next == 0)
+			return false;
+		Rec_PrintCommand(i, &words[pos]);
+		pos = next;
+	}
+	return true;
+}
+
+int Rec_CompareLogs(const char* a, const char* b)
+{
+	array<unsigned int> wa, wb;
+	if (!Rec_ReadLog(a, wa) || !Rec_ReadLog(b, wb))
+		return 0;
+
+	unsigned int pa = 2, pb = 2;
+	for (int i = 0; ; i++)
+	{
+		bool endA = pa >= wa.size();
+		bool endB = pb >= wb.size();
+		if (endA && endB)
+			return -1;
+
+		unsigned int na = endA ? 0 : Rec_NextCommand(wa, pa);
+		unsigned int nb = endB ? 0 : Rec_NextCommand(wb, pb);
+		if (na == 0 || nb == 0 || na - pa != nb - pb
+			|| memcmp(&wa[pa], &wb[pb], (na - pa) * sizeof(unsigned int)) != 0)
+		{
+			Sys_Printf("rec: logs differ at command %d\n", i);
+			if (na != 0)
+				Rec_PrintCommand(i, &wa[pa]);
+			if (nb != 0)
+				Rec_PrintCommand(i, &wb[pb]);
+			return i;
+		}
+		pa = na;
+		pb = nb;
+	}
+}
+
+#ifdef FLIP_GL_RECORD
+
+/*
+===============================================================================
+
+	Recorder
+
+===============================================================================
+*/
+
+typedef enum
+{
+	eRecObj_Buffer,
+	eRecObj_Texture,
+	eRecObj_Framebuffer,
+	eRecObj_Renderbuffer,
+	eRecObj_Query,
+	eRecObj_Program,		// programs and shaders share names
+	eRecObj_Count
+}recObject_t;
+
+static FILE* rec_file = NULL;
+static recState_t rec_state;
+static recStats_t rec_stats;
+static unsigned int rec_names[eRecObj_Count];
+static int rec_width = 0;
+static int rec_height = 0;
+
+// source hash per shader, and of the attached shaders per program, so the
+// fake program binaries differ when the sources do
+#define REC_MAX_PROGRAM_NAMES	4096
+#define REC_BINARY_FORMAT		0x52454342	// "RECB"
+static unsigned int rec_sourceHash[REC_MAX_PROGRAM_NAMES];
+// programs report KHR_parallel_shader_compile completion a frame after the link
+static int rec_linkFrame[REC_MAX_PROGRAM_NAMES];
+static array<unsigned char> rec_mapped;
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#define REC_EMIT(op, args) Rec_Emit(op, sizeof(args) / sizeof(args[0]), args)
+
+static void Rec_Emit(int op, int numArgs, const unsigned int* args)
+{
+	if (rec_file != NULL)
+	{
+		unsigned int header = (op << 16) | numArgs;
+		fwrite(&header, sizeof(unsigned int), 1, rec_file);
+		if (numArgs > 0)
+			fwrite(args, sizeof(unsigned int), numArgs, rec_file);
+	}
+	Rec_Track(&rec_state, &rec_stats, op, args);
+}
+
+static unsigned int Rec_Float(float f)
+{
+	unsigned int u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+// fnv-1a
+static unsigned int Rec_Hash(const void* data, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	unsigned int h = 2166136261u;
+	if (p == NULL)
+		return 0;
+	for (size_t i = 0; i < size; i++)
+		h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+// with an unpack buffer bound the pointer is an offset into it, the data
+// went in through a mapping
+static unsigned int Rec_HashPixels(const void* pixels, size_t size)
+{
+	if (rec_state.unpackBuffer != 0)
+		return (unsigned int)(size_t)pixels;
+	return Rec_Hash(pixels, size);
+}
+
+static int Rec_PixelBytes(GLenum format, GLenum type)
+{
+	switch (type)
+	{
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+		return 2;
+	case GL_UNSIGNED_INT_24_8:
+		return 4;
+	}
+
+	int size = 1;
+	if (type == GL_SHORT || type == GL_UNSIGNED_SHORT || type == GL_HALF_FLOAT)
+		size = 2;
+	else if (type == GL_INT || type == GL_UNSIGNED_INT || type == GL_FLOAT)
+		size = 4;
+
+	switch (format)
+	{
+	case GL_RGBA:
+	case GL_BGRA:
+		return size * 4;
+	case GL_RGB:
+	case GL_BGR:
+		return size * 3;
+	case GL_RG:
+	case GL_LUMINANCE_ALPHA:
+		return size * 2;
+	default:
+		return size;
+	}
+}
+
+static unsigned int Rec_GenNames(recObject_t type, GLsizei n, GLuint* names)
+{
+	unsigned int first = rec_names[type] + 1;
+	for (GLsizei i = 0; i < n; i++)
+		names[i] = ++rec_names[type];
+	return first;
+}
+
+static void Rec_DeleteNames(int op, GLsizei n, const GLuint* names)
+{
+	array<unsigned int> args;
+	args.push_back(n);
+	for (GLsizei i = 0; i < n; i++)
+		args.push_back(names[i]);
+	Rec_Emit(op, args.size(), args.pointer());
+}
+
+bool Rec_Open(const char* filename)
+{
+	Rec_Close();
+	if (filename == NULL)
+		return true;
+
+	rec_file = fopen(filename, "wb");
+	if (rec_file == NULL)
+	{
+		Sys_Printf("rec: can't write %s\n", filename);
+		return false;
+	}
+
+	unsigned int header[2] = { REC_LOG_MAGIC, REC_LOG_VERSION };
+	fwrite(header, sizeof(unsigned int), 2, rec_file);
+	Sys_Printf("rec: logging gl commands to %s\n", filename);
+	return true;
+}
+
+void Rec_Close()
+{
+	if (rec_file != NULL)
+	{
+		fclose(rec_file);
+		rec_file = NULL;
+	}
+}
+
+const recStats_t& Rec_GetStats()
+{
+	return rec_stats;
+}
+
+void Rec_ResetStats()
+{
+	memset(&rec_stats, 0, sizeof(rec_stats));
+}
+
+void GLAPIENTRY Rec_ActiveTexture(GLenum texture)
+{
+	unsigned int args[] = { texture };
+	REC_EMIT(eRec_ActiveTexture, args);
+}
+
+void GLAPIENTRY Rec_AttachShader(GLuint program, GLuint shader)
+{
+	unsigned int args[] = { program, shader };
+	REC_EMIT(eRec_AttachShader, args);
+	if (program < REC_MAX_PROGRAM_NAMES && shader < REC_MAX_PROGRAM_NAMES)
+		rec_sourceHash[program] = rec_sourceHash[program] * 31 + rec_sourceHash[shader];
+}
+
+void GLAPIENTRY Rec_Begin(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_Begin, args);
+}
+
+void GLAPIENTRY Rec_BindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+	unsigned int args[] = { program, index, Rec_Hash(name, strlen(name)) };
+	REC_EMIT(eRec_BindAttribLocation, args);
+}
+
+void GLAPIENTRY Rec_BindBuffer(GLenum target, GLuint buffer)
+{
+	unsigned int args[] = { target, buffer };
+	REC_EMIT(eRec_BindBuffer, args);
+}
+
+void GLAPIENTRY Rec_BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	unsigned int args[] = { target, framebuffer };
+	REC_EMIT(eRec_BindFramebuffer, args);
+}
+
+void GLAPIENTRY Rec_BindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+	unsigned int args[] = { target, renderbuffer };
+	REC_EMIT(eRec_BindRenderbuffer, args);
+}
+
+void GLAPIENTRY Rec_BindTexture(GLenum target, GLuint texture)
+{
+	unsigned int args[] = { target, texture };
+	REC_EMIT(eRec_BindTexture, args);
+}
+
+void GLAPIENTRY Rec_BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	unsigned int args[] = { sfactor, dfactor };
+	REC_EMIT(eRec_BlendFunc, args);
+}
+
+void GLAPIENTRY Rec_BufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	unsigned int args[] = { target, (unsigned int)size, Rec_Hash(data, size), usage };
+	REC_EMIT(eRec_BufferData, args);
+}
+
+void GLAPIENTRY Rec_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+	unsigned int args[] = { target, (unsigned int)offset, (unsigned int)size, Rec_Hash(data, size) };
+	REC_EMIT(eRec_BufferSubData, args);
+}
+
+void GLAPIENTRY Rec_BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	unsigned int args[] = { target, index, buffer };
+	REC_EMIT(eRec_BindBufferBase, args);
+}
+
+GLenum GLAPIENTRY Rec_CheckFramebufferStatus(GLenum target)
+{
+	unsigned int args[] = { target };
+	REC_EMIT(eRec_CheckFramebufferStatus, args);
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GLAPIENTRY Rec_Clear(GLbitfield mask)
+{
+	unsigned int args[] = { mask };
+	REC_EMIT(eRec_Clear, args);
+}
+
+void GLAPIENTRY Rec_ClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+	unsigned int args[] = { Rec_Float(red), Rec_Float(green), Rec_Float(blue), Rec_Float(alpha) };
+	REC_EMIT(eRec_ClearColor, args);
+}
+
+void GLAPIENTRY Rec_ClearDepth(GLclampd depth)
+{
+	unsigned int args[] = { Rec_Float((float)depth) };
+	REC_EMIT(eRec_ClearDepth, args);
+}
+
+void GLAPIENTRY Rec_Color3f(GLfloat red, GLfloat green, GLfloat blue)
+{
+	unsigned int args[] = { Rec_Float(red), Rec_Float(green), Rec_Float(blue) };
+	REC_EMIT(eRec_Color3f, args);
+}
+
+void GLAPIENTRY Rec_ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	unsigned int args[] = { red, green, blue, alpha };
+	REC_EMIT(eRec_ColorMask, args);
+}
+
+void GLAPIENTRY Rec_CompileShader(GLuint shader)
+{
+	unsigned int args[] = { shader };
+	REC_EMIT(eRec_CompileShader, args);
+}
+
+void GLAPIENTRY Rec_CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data)
+{
+	unsigned int args[] = { target, (unsigned int)level, internalformat, (unsigned int)width,
+		(unsigned int)height, (unsigned int)imageSize, Rec_HashPixels(data, imageSize) };
+	REC_EMIT(eRec_CompressedTexImage2D, args);
+}
+
+void GLAPIENTRY Rec_CompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const GLvoid* data)
+{
+	unsigned int args[] = { target, (unsigned int)level, (unsigned int)xoffset, (unsigned int)yoffset, (unsigned int)zoffset,
+		(unsigned int)width, (unsigned int)height, (unsigned int)imageSize, format, (unsigned int)depth,
+		Rec_HashPixels(data, imageSize) };
+	REC_EMIT(eRec_CompressedTexSubImage3D, args);
+}
+
+void GLAPIENTRY Rec_CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+	unsigned int args[] = { readTarget, writeTarget, (unsigned int)readOffset, (unsigned int)writeOffset, (unsigned int)size };
+	REC_EMIT(eRec_CopyBufferSubData, args);
+}
+
+GLuint GLAPIENTRY Rec_CreateProgram()
+{
+	unsigned int args[] = { ++rec_names[eRecObj_Program] };
+	REC_EMIT(eRec_CreateProgram, args);
+	if (args[0] < REC_MAX_PROGRAM_NAMES)
+		rec_sourceHash[args[0]] = 0;
+	return args[0];
+}
+
+GLuint GLAPIENTRY Rec_CreateShader(GLenum type)
+{
+	unsigned int args[] = { type, ++rec_names[eRecObj_Program] };
+	REC_EMIT(eRec_CreateShader, args);
+	return args[1];
+}
+
+void GLAPIENTRY Rec_CullFace(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_CullFace, args);
+}
+
+void GLAPIENTRY Rec_DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	Rec_DeleteNames(eRec_DeleteBuffers, n, buffers);
+}
+
+void GLAPIENTRY Rec_DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+	Rec_DeleteNames(eRec_DeleteFramebuffers, n, framebuffers);
+}
+
+void GLAPIENTRY Rec_DeleteProgram(GLuint program)
+{
+	unsigned int args[] = { program };
+	REC_EMIT(eRec_DeleteProgram, args);
+}
+
+void GLAPIENTRY Rec_DeleteQueries(GLsizei n, const GLuint* ids)
+{
+	Rec_DeleteNames(eRec_DeleteQueries, n, ids);
+}
+
+void GLAPIENTRY Rec_DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+	Rec_DeleteNames(eRec_DeleteRenderbuffers, n, renderbuffers);
+}
+
+void GLAPIENTRY Rec_DeleteShader(GLuint shader)
+{
+	unsigned int args[] = { shader };
+	REC_EMIT(eRec_DeleteShader, args);
+}
+
+void GLAPIENTRY Rec_DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	Rec_DeleteNames(eRec_DeleteTextures, n, textures);
+}
+
+void GLAPIENTRY Rec_DepthFunc(GLenum func)
+{
+	unsigned int args[] = { func };
+	REC_EMIT(eRec_DepthFunc, args);
+}
+
+void GLAPIENTRY Rec_DepthMask(GLboolean flag)
+{
+	unsigned int args[] = { flag };
+	REC_EMIT(eRec_DepthMask, args);
+}
+
+void GLAPIENTRY Rec_Disable(GLenum cap)
+{
+	unsigned int args[] = { cap };
+	REC_EMIT(eRec_Disable, args);
+}
+
+void GLAPIENTRY Rec_DisableVertexAttribArray(GLuint index)
+{
+	unsigned int args[] = { index };
+	REC_EMIT(eRec_DisableVertexAttribArray, args);
+}
+
+void GLAPIENTRY Rec_DrawBuffer(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_DrawBuffer, args);
+}
+
+void GLAPIENTRY Rec_DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+	unsigned int args[] = { mode, (unsigned int)first, (unsigned int)count, (unsigned int)instancecount };
+	REC_EMIT(eRec_DrawArraysInstanced, args);
+}
+
+void GLAPIENTRY Rec_DrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+	// client side indices are hashed, buffer offsets stored as they are
+	unsigned int offset;
+	if (rec_state.elementBuffer == 0)
+	{
+		int indexSize = type == GL_UNSIGNED_INT ? 4 : (type == GL_UNSIGNED_SHORT ? 2 : 1);
+		offset = Rec_Hash(indices, count * indexSize);
+	}
+	else
+		offset = (unsigned int)(size_t)indices;
+
+	unsigned int args[] = { mode, (unsigned int)count, type, offset };
+	REC_EMIT(eRec_DrawElements, args);
+}
+
+void GLAPIENTRY Rec_DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex)
+{
+	// only drawn from buffers, indices is an offset
+	unsigned int args[] = { mode, (unsigned int)count, type, (unsigned int)(size_t)indices, (unsigned int)basevertex };
+	REC_EMIT(eRec_DrawElementsBaseVertex, args);
+}
+
+void GLAPIENTRY Rec_Enable(GLenum cap)
+{
+	unsigned int args[] = { cap };
+	REC_EMIT(eRec_Enable, args);
+}
+
+void GLAPIENTRY Rec_EnableVertexAttribArray(GLuint index)
+{
+	unsigned int args[] = { index };
+	REC_EMIT(eRec_EnableVertexAttribArray, args);
+}
+
+void GLAPIENTRY Rec_End()
+{
+	Rec_Emit(eRec_End, 0, NULL);
+}
+
+void GLAPIENTRY Rec_FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+	unsigned int args[] = { target, attachment, renderbuffertarget, renderbuffer };
+	REC_EMIT(eRec_FramebufferRenderbuffer, args);
+}
+
+void GLAPIENTRY Rec_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	unsigned int args[] = { target, attachment, textarget, texture, (unsigned int)level };
+	REC_EMIT(eRec_FramebufferTexture2D, args);
+}
+
+void GLAPIENTRY Rec_FrontFace(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_FrontFace, args);
+}
+
+void GLAPIENTRY Rec_GenBuffers(GLsizei n, GLuint* buffers)
+{
+	unsigned int args[] = { (unsigned int)n, Rec_GenNames(eRecObj_Buffer, n, buffers) };
+	REC_EMIT(eRec_GenBuffers, args);
+}
+
+void GLAPIENTRY Rec_GenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+	unsigned int args[] = { (unsigned int)n, Rec_GenNames(eRecObj_Framebuffer, n, framebuffers) };
+	REC_EMIT(eRec_GenFramebuffers, args);
+}
+
+void GLAPIENTRY Rec_GenQueries(GLsizei n, GLuint* ids)
+{
+	unsigned int args[] = { (unsigned int)n, Rec_GenNames(eRecObj_Query, n, ids) };
+	REC_EMIT(eRec_GenQueries, args);
+}
+
+void GLAPIENTRY Rec_GenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+	unsigned int args[] = { (unsigned int)n, Rec_GenNames(eRecObj_Renderbuffer, n, renderbuffers) };
+	REC_EMIT(eRec_GenRenderbuffers, args);
+}
+
+void GLAPIENTRY Rec_GenTextures(GLsizei n, GLuint* textures)
+{
+	unsigned int args[] = { (unsigned int)n, Rec_GenNames(eRecObj_Texture, n, textures) };
+	REC_EMIT(eRec_GenTextures, args);
+}
+
+// queries are answered from the shim and not logged
+
+GLenum GLAPIENTRY Rec_GetError()
+{
+	return GL_NO_ERROR;
+}
+
+void GLAPIENTRY Rec_GetIntegerv(GLenum pname, GLint* params)
+{
+	switch (pname)
+	{
+	case GL_VIEWPORT:
+		if (rec_state.viewport[0] == REC_UNKNOWN)
+		{
+			params[0] = params[1] = 0;
+			params[2] = rec_width;
+			params[3] = rec_height;
+		}
+		else
+		{
+			for (int i = 0; i < 4; i++)
+				params[i] = rec_state.viewport[i];
+		}
+		break;
+	case GL_FRAMEBUFFER_BINDING:
+		params[0] = rec_state.framebuffer;
+		break;
+	case GL_CURRENT_PROGRAM:
+		params[0] = rec_state.program;
+		break;
+	case GL_MAX_TEXTURE_SIZE:
+		params[0] = 8192;
+		break;
+	case GL_MAX_TEXTURE_IMAGE_UNITS:
+		params[0] = 16;
+		break;
+	case GL_MAX_ARRAY_TEXTURE_LAYERS:
+		params[0] = 2048;
+		break;
+	case GL_NUM_PROGRAM_BINARY_FORMATS:
+		// no binaries, the program cache stays off (see GL_DISK_CACHES)
+		params[0] = 0;
+		break;
+	default:
+		params[0] = 0;
+		break;
+	}
+}
+
+void GLAPIENTRY Rec_GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary)
+{
+	unsigned int data[2] = { REC_BINARY_FORMAT, program < REC_MAX_PROGRAM_NAMES ? rec_sourceHash[program] : 0 };
+	GLsizei size = bufSize < (GLsizei)sizeof(data) ? 0 : sizeof(data);
+	memcpy(binary, data, size);
+	if (length != NULL)
+		*length = size;
+	*binaryFormat = REC_BINARY_FORMAT;
+}
+
+void GLAPIENTRY Rec_GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+	if (length != NULL)
+		*length = 0;
+	if (bufSize > 0)
+		infoLog[0] = '\0';
+}
+
+void GLAPIENTRY Rec_GetProgramiv(GLuint program, GLenum pname, GLint* param)
+{
+	if (pname == GL_LINK_STATUS)
+		*param = GL_TRUE;
+	else if (pname == GL_COMPLETION_STATUS_KHR)
+		*param = program >= REC_MAX_PROGRAM_NAMES || rec_stats.frames != rec_linkFrame[program];
+	else if (pname == GL_PROGRAM_BINARY_LENGTH)
+		*param = 2 * sizeof(unsigned int);
+	else
+		*param = 0;
+}
+
+void GLAPIENTRY Rec_GetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	*params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void GLAPIENTRY Rec_GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	// gpu time reads as zero so timings stay deterministic
+	*params = 0;
+}
+
+void GLAPIENTRY Rec_GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+	if (length != NULL)
+		*length = 0;
+	if (bufSize > 0)
+		infoLog[0] = '\0';
+}
+
+void GLAPIENTRY Rec_GetShaderiv(GLuint shader, GLenum pname, GLint* param)
+{
+	*param = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+const GLubyte* GLAPIENTRY Rec_GetString(GLenum name)
+{
+	switch (name)
+	{
+	case GL_VENDOR:
+		return (const GLubyte*)"flip";
+	case GL_RENDERER:
+		return (const GLubyte*)"gl command recorder";
+	case GL_VERSION:
+		return (const GLubyte*)"3.3 record";
+	case GL_EXTENSIONS:
+		return (const GLubyte*)"GL_ARB_get_program_binary GL_ARB_multi_draw_indirect GL_ARB_shader_draw_parameters "
+			"GL_ARB_shader_storage_buffer_object GL_ARB_texture_storage GL_ARB_texture_view "
+			"GL_EXT_texture_compression_s3tc GL_KHR_parallel_shader_compile";
+	default:
+		return (const GLubyte*)"";
+	}
+}
+
+GLint GLAPIENTRY Rec_GetUniformLocation(GLuint program, const GLchar* name)
+{
+	// any stable value will do, nothing looks locations up
+	unsigned int hash = Rec_Hash(name, strlen(name));
+	unsigned int args[] = { program, hash, hash & 0x7fff };
+	REC_EMIT(eRec_GetUniformLocation, args);
+	return args[2];
+}
+
+void GLAPIENTRY Rec_Hint(GLenum target, GLenum mode)
+{
+	unsigned int args[] = { target, mode };
+	REC_EMIT(eRec_Hint, args);
+}
+
+void GLAPIENTRY Rec_LinkProgram(GLuint program)
+{
+	unsigned int args[] = { program };
+	REC_EMIT(eRec_LinkProgram, args);
+	if (program < REC_MAX_PROGRAM_NAMES)
+		rec_linkFrame[program] = rec_stats.frames;
+}
+
+void GLAPIENTRY Rec_LoadIdentity()
+{
+	Rec_Emit(eRec_LoadIdentity, 0, NULL);
+}
+
+void* GLAPIENTRY Rec_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	// writes land in scratch memory, the unmap hashes them
+	unsigned int args[] = { target, (unsigned int)offset, (unsigned int)length, access };
+	REC_EMIT(eRec_MapBufferRange, args);
+	rec_mapped.set_used(length);
+	return rec_mapped.pointer();
+}
+
+void GLAPIENTRY Rec_MatrixMode(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_MatrixMode, args);
+}
+
+void GLAPIENTRY Rec_MultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const GLvoid* const* indices, GLsizei drawcount, const GLint* basevertex)
+{
+	// the arrays are hashed, the total index count kept for the stats
+	unsigned int total = 0;
+	for (GLsizei i = 0; i < drawcount; i++)
+		total += count[i];
+	unsigned int args[] = { mode, (unsigned int)drawcount, total, type,
+		Rec_Hash(count, drawcount * sizeof(GLsizei)), Rec_Hash(indices, drawcount * sizeof(GLvoid*)),
+		Rec_Hash(basevertex, drawcount * sizeof(GLint)) };
+	REC_EMIT(eRec_MultiDrawElementsBaseVertex, args);
+}
+
+void GLAPIENTRY Rec_MultiDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid* indirect, GLsizei drawcount, GLsizei stride)
+{
+	unsigned int args[] = { mode, type, (unsigned int)(size_t)indirect, (unsigned int)drawcount, (unsigned int)stride };
+	REC_EMIT(eRec_MultiDrawElementsIndirect, args);
+}
+
+void GLAPIENTRY Rec_Ortho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar)
+{
+	unsigned int args[] = { Rec_Float((float)left), Rec_Float((float)right), Rec_Float((float)bottom),
+		Rec_Float((float)top), Rec_Float((float)zNear), Rec_Float((float)zFar) };
+	REC_EMIT(eRec_Ortho, args);
+}
+
+void GLAPIENTRY Rec_PixelStorei(GLenum pname, GLint param)
+{
+	unsigned int args[] = { pname, (unsigned int)param };
+	REC_EMIT(eRec_PixelStorei, args);
+}
+
+void GLAPIENTRY Rec_PointSize(GLfloat size)
+{
+	unsigned int args[] = { Rec_Float(size) };
+	REC_EMIT(eRec_PointSize, args);
+}
+
+void GLAPIENTRY Rec_ProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLsizei length)
+{
+	unsigned int args[] = { program, binaryFormat, (unsigned int)length, Rec_Hash(binary, length) };
+	REC_EMIT(eRec_ProgramBinary, args);
+	if (program < REC_MAX_PROGRAM_NAMES && length == 2 * sizeof(unsigned int))
+		rec_sourceHash[program] = ((const unsigned int*)binary)[1];
+}
+
+void GLAPIENTRY Rec_ProgramParameteri(GLuint program, GLenum pname, GLint value)
+{
+	unsigned int args[] = { program, pname, (unsigned int)value };
+	REC_EMIT(eRec_ProgramParameteri, args);
+}
+
+void GLAPIENTRY Rec_QueryCounter(GLuint id, GLenum target)
+{
+	unsigned int args[] = { id, target };
+	REC_EMIT(eRec_QueryCounter, args);
+}
+
+void GLAPIENTRY Rec_ReadBuffer(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_ReadBuffer, args);
+}
+
+void GLAPIENTRY Rec_ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels)
+{
+	unsigned int args[] = { (unsigned int)x, (unsigned int)y, (unsigned int)width, (unsigned int)height, format, type };
+	REC_EMIT(eRec_ReadPixels, args);
+	memset(pixels, 0, width * height * Rec_PixelBytes(format, type));
+}
+
+void GLAPIENTRY Rec_RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+	unsigned int args[] = { target, internalformat, (unsigned int)width, (unsigned int)height };
+	REC_EMIT(eRec_RenderbufferStorage, args);
+}
+
+void GLAPIENTRY Rec_ShadeModel(GLenum mode)
+{
+	unsigned int args[] = { mode };
+	REC_EMIT(eRec_ShadeModel, args);
+}
+
+void GLAPIENTRY Rec_ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+	unsigned int bytes = 0;
+	unsigned int hash = 0;
+	for (GLsizei i = 0; i < count; i++)
+	{
+		size_t len = (length != NULL && length[i] >= 0) ? length[i] : strlen(string[i]);
+		hash = hash * 31 + Rec_Hash(string[i], len);
+		bytes += len;
+	}
+	unsigned int args[] = { shader, (unsigned int)count, bytes, hash };
+	REC_EMIT(eRec_ShaderSource, args);
+	if (shader < REC_MAX_PROGRAM_NAMES)
+		rec_sourceHash[shader] = hash;
+}
+
+void GLAPIENTRY Rec_StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+	unsigned int args[] = { func, (unsigned int)ref, mask };
+	REC_EMIT(eRec_StencilFunc, args);
+}
+
+void GLAPIENTRY Rec_StencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+	unsigned int args[] = { fail, zfail, zpass };
+	REC_EMIT(eRec_StencilOp, args);
+}
+
+void GLAPIENTRY Rec_TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
+{
+	unsigned int bytes = pixels != NULL || rec_state.unpackBuffer != 0 ? width * height * Rec_PixelBytes(format, type) : 0;
+	unsigned int args[] = { target, (unsigned int)level, (unsigned int)internalformat, (unsigned int)width,
+		(unsigned int)height, format, type, bytes, Rec_HashPixels(pixels, bytes) };
+	REC_EMIT(eRec_TexImage2D, args);
+}
+
+void GLAPIENTRY Rec_TexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	unsigned int args[] = { target, pname, Rec_Float(param) };
+	REC_EMIT(eRec_TexParameterf, args);
+}
+
+void GLAPIENTRY Rec_TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	unsigned int args[] = { target, pname, (unsigned int)param };
+	REC_EMIT(eRec_TexParameteri, args);
+}
+
+void GLAPIENTRY Rec_TexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+	unsigned int args[] = { target, (unsigned int)levels, internalformat, (unsigned int)width, (unsigned int)height };
+	REC_EMIT(eRec_TexStorage2D, args);
+}
+
+void GLAPIENTRY Rec_TexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
+{
+	unsigned int args[] = { target, (unsigned int)levels, internalformat, (unsigned int)width, (unsigned int)height, (unsigned int)depth };
+	REC_EMIT(eRec_TexStorage3D, args);
+}
+
+void GLAPIENTRY Rec_TexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels)
+{
+	unsigned int bytes = pixels != NULL || rec_state.unpackBuffer != 0 ? width * height * depth * Rec_PixelBytes(format, type) : 0;
+	unsigned int args[] = { target, (unsigned int)level, (unsigned int)xoffset, (unsigned int)yoffset, (unsigned int)zoffset,
+		(unsigned int)width, (unsigned int)height, (unsigned int)depth, bytes, format, type, Rec_HashPixels(pixels, bytes) };
+	REC_EMIT(eRec_TexSubImage3D, args);
+}
+
+void GLAPIENTRY Rec_TextureView(GLuint texture, GLenum target, GLuint origtexture, GLenum internalformat, GLuint minlevel, GLuint numlevels, GLuint minlayer, GLuint numlayers)
+{
+	unsigned int args[] = { texture, target, origtexture, internalformat, minlevel, numlevels, minlayer, numlayers };
+	REC_EMIT(eRec_TextureView, args);
+}
+
+GLboolean GLAPIENTRY Rec_UnmapBuffer(GLenum target)
+{
+	unsigned int args[] = { target, rec_mapped.size(), Rec_Hash(rec_mapped.pointer(), rec_mapped.size()) };
+	REC_EMIT(eRec_UnmapBuffer, args);
+	return GL_TRUE;
+}
+
+void GLAPIENTRY Rec_Uniform1f(GLint location, GLfloat v0)
+{
+	unsigned int args[] = { (unsigned int)location, Rec_Float(v0) };
+	REC_EMIT(eRec_Uniform1f, args);
+}
+
+void GLAPIENTRY Rec_Uniform1i(GLint location, GLint v0)
+{
+	unsigned int args[] = { (unsigned int)location, (unsigned int)v0 };
+	REC_EMIT(eRec_Uniform1i, args);
+}
+
+void GLAPIENTRY Rec_Uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	unsigned int args[] = { (unsigned int)location, (unsigned int)count, Rec_Hash(value, count * 2 * sizeof(float)) };
+	REC_EMIT(eRec_Uniform2fv, args);
+}
+
+void GLAPIENTRY Rec_Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+	unsigned int args[] = { (unsigned int)location, Rec_Float(v0), Rec_Float(v1), Rec_Float(v2) };
+	REC_EMIT(eRec_Uniform3f, args);
+}
+
+void GLAPIENTRY Rec_Uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	unsigned int args[] = { (unsigned int)location, (unsigned int)count, Rec_Hash(value, count * 3 * sizeof(float)) };
+	REC_EMIT(eRec_Uniform3fv, args);
+}
+
+void GLAPIENTRY Rec_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	unsigned int args[] = { (unsigned int)location, (unsigned int)count, transpose, Rec_Hash(value, count * 16 * sizeof(float)) };
+	REC_EMIT(eRec_UniformMatrix4fv, args);
+}
+
+void GLAPIENTRY Rec_UseProgram(GLuint program)
+{
+	unsigned int args[] = { program };
+	REC_EMIT(eRec_UseProgram, args);
+}
+
+void GLAPIENTRY Rec_Vertex2f(GLfloat x, GLfloat y)
+{
+	unsigned int args[] = { Rec_Float(x), Rec_Float(y) };
+	REC_EMIT(eRec_Vertex2f, args);
+}
+
+void GLAPIENTRY Rec_VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	unsigned int args[] = { index, divisor };
+	REC_EMIT(eRec_VertexAttribDivisor, args);
+}
+
+void GLAPIENTRY Rec_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+	// client memory addresses change from run to run
+	unsigned int offset = rec_state.arrayBuffer == 0 ? REC_CLIENT_PTR : (unsigned int)(size_t)pointer;
+	unsigned int args[] = { index, (unsigned int)size, type, normalized, (unsigned int)stride, offset };
+	REC_EMIT(eRec_VertexAttribPointer, args);
+}
+
+void GLAPIENTRY Rec_Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	unsigned int args[] = { (unsigned int)x, (unsigned int)y, (unsigned int)width, (unsigned int)height };
+	REC_EMIT(eRec_Viewport, args);
+}
+
+/*
+===============================================================================
+
+	Headless device
+
+===============================================================================
+*/
+
+static void Rec_Open_f(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		Sys_Printf("usage: rec_open <file>\n");
+		return;
+	}
+	Rec_Open(argv[1]);
+}
+
+static void Rec_Close_f(int argc, const char** argv)
+{
+	Rec_Close();
+}
+
+static void Rec_Stats_f(int argc, const char** argv)
+{
+	Rec_PrintStats(rec_stats);
+}
+
+static void Rec_Replay_f(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		Sys_Printf("usage: rec_replay <file>\n");
+		return;
+	}
+	recStats_t stats;
+	if (Rec_Replay(argv[1], &stats))
+		Rec_PrintStats(stats);
+}
+
+static void Rec_Dump_f(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		Sys_Printf("usage: rec_dump <file> [commands]\n");
+		return;
+	}
+	Rec_DumpLog(argv[1], argc > 2 ? atoi(argv[2]) : 0);
+}
+
+static void Rec_Compare_f(int argc, const char** argv)
+{
+	if (argc < 3)
+	{
+		Sys_Printf("usage: rec_compare <a> <b>\n");
+		return;
+	}
+	if (Rec_CompareLogs(argv[1], argv[2]) < 0)
+		Sys_Printf("rec: logs match\n");
+}
+
+bool GL_CreateDevice(glimpParms_t *parm)
+{
+	Sys_Printf("Initializing gl command recorder %dx%d\n", parm->width, parm->height);
+
+	rec_width = parm->width;
+	rec_height = parm->height;
+	Rec_ClearState(&rec_state);
+	Rec_ResetStats();
+	memset(rec_names, 0, sizeof(rec_names));
+
+	// FLIP_GL_LOG names the log for runs that can't type commands
+	const char* log = getenv("FLIP_GL_LOG");
+	if (log != NULL && log[0] != '\0')
+		Rec_Open(log);
+
+	Cmd_AddCommand("rec_open", Rec_Open_f, "log gl commands to a file");
+	Cmd_AddCommand("rec_close", Rec_Close_f, "stop logging gl commands");
+	Cmd_AddCommand("rec_stats", Rec_Stats_f, "draw call and state change counts");
+	Cmd_AddCommand("rec_replay", Rec_Replay_f, "count a saved gl command log");
+	Cmd_AddCommand("rec_dump", Rec_Dump_f, "list a saved gl command log");
+	Cmd_AddCommand("rec_compare", Rec_Compare_f, "find the first difference of two gl command logs");
+	return true;
+}
+
+void GL_SwapBuffers( void )
+{
+	Rec_Emit(eRec_SwapBuffers, 0, NULL);
+	if (rec_file != NULL)
+		fflush(rec_file);
+}
+
+#endif
@@ -0,0 +1,371 @@
+#ifndef __GL_RECORD_H__
+#define __GL_RECORD_H__
+
+/*
+===============================================================================
+
+	Recording GL shim
+
+	Built with FLIP_GL_RECORD, every GL entry point the engine calls is
+	redirected here by the defines at the bottom of this file. Nothing
+	reaches a driver: object names come from a deterministic allocator,
+	queries return "complete" and "available", and each call is appended
+	to a binary command log. GL_CreateDevice and GL_SwapBuffers are
+	provided as well, so the full renderer runs without a window or GPU.
+
+	The log is a header followed by commands. Each command is one word
+	holding (opcode << 16) | numArgs followed by numArgs 32 bit words.
+	Uploaded data, shader sources and uniform arrays are stored as a
+	byte count and a hash, which keeps the log small but still catches
+	content changes.
+
+	Draw calls and state changes are counted while recording; a saved
+	log can be replayed through the same counters and two logs can be
+	compared command by command, which is what regression checks use.
+
+	New GL calls used by the engine must be added to this file.
+
+===============================================================================
+*/
+
+#define REC_LOG_MAGIC		0x52474c46	// "FLGR"
+#define REC_LOG_VERSION		8
+
+#define REC_COMMANDS \
+	REC_CMD(SwapBuffers) \
+	REC_CMD(ActiveTexture) REC_CMD(AttachShader) REC_CMD(Begin) REC_CMD(BindAttribLocation) \
+	REC_CMD(BindBuffer) REC_CMD(BindBufferBase) REC_CMD(BindFramebuffer) REC_CMD(BindRenderbuffer) REC_CMD(BindTexture) \
+	REC_CMD(BlendFunc) REC_CMD(BufferData) REC_CMD(BufferSubData) REC_CMD(CheckFramebufferStatus) REC_CMD(Clear) \
+	REC_CMD(ClearColor) REC_CMD(ClearDepth) REC_CMD(Color3f) REC_CMD(ColorMask) \
+	REC_CMD(CompileShader) REC_CMD(CompressedTexImage2D) REC_CMD(CompressedTexSubImage3D) REC_CMD(CopyBufferSubData) REC_CMD(CreateProgram) REC_CMD(CreateShader) REC_CMD(CullFace) \
+	REC_CMD(DeleteBuffers) REC_CMD(DeleteFramebuffers) REC_CMD(DeleteProgram) REC_CMD(DeleteQueries) \
+	REC_CMD(DeleteRenderbuffers) REC_CMD(DeleteShader) REC_CMD(DeleteTextures) REC_CMD(DepthFunc) \
+	REC_CMD(DepthMask) REC_CMD(Disable) REC_CMD(DisableVertexAttribArray) REC_CMD(DrawArraysInstanced) REC_CMD(DrawBuffer) \
+	REC_CMD(DrawElements) REC_CMD(DrawElementsBaseVertex) REC_CMD(Enable) REC_CMD(EnableVertexAttribArray) REC_CMD(End) \
+	REC_CMD(FramebufferRenderbuffer) REC_CMD(FramebufferTexture2D) REC_CMD(FrontFace) REC_CMD(GenBuffers) \
+	REC_CMD(GenFramebuffers) REC_CMD(GenQueries) REC_CMD(GenRenderbuffers) REC_CMD(GenTextures) \
+	REC_CMD(GetUniformLocation) REC_CMD(Hint) REC_CMD(LinkProgram) REC_CMD(LoadIdentity) \
+	REC_CMD(MapBufferRange) REC_CMD(MatrixMode) REC_CMD(MultiDrawElementsBaseVertex) REC_CMD(MultiDrawElementsIndirect) REC_CMD(Ortho) REC_CMD(PixelStorei) REC_CMD(PointSize) \
+	REC_CMD(ProgramBinary) REC_CMD(ProgramParameteri) REC_CMD(QueryCounter) REC_CMD(ReadBuffer) \
+	REC_CMD(ReadPixels) REC_CMD(RenderbufferStorage) \
+	REC_CMD(ShadeModel) REC_CMD(ShaderSource) REC_CMD(StencilFunc) REC_CMD(StencilOp) \
+	REC_CMD(TexImage2D) REC_CMD(TexParameterf) REC_CMD(TexParameteri) REC_CMD(TexStorage2D) \
+	REC_CMD(TexStorage3D) REC_CMD(TexSubImage3D) REC_CMD(TextureView) \
+	REC_CMD(UnmapBuffer) REC_CMD(Uniform1f) REC_CMD(Uniform1i) REC_CMD(Uniform2fv) REC_CMD(Uniform3f) \
+	REC_CMD(Uniform3fv) REC_CMD(UniformMatrix4fv) REC_CMD(UseProgram) REC_CMD(Vertex2f) \
+	REC_CMD(VertexAttribDivisor) REC_CMD(VertexAttribPointer) REC_CMD(Viewport)
+
+typedef enum
+{
+#define REC_CMD(name) eRec_##name,
+	REC_COMMANDS
+#undef REC_CMD
+	eRec_Count
+}recOp_t;
+
+typedef struct
+{
+	int			frames;
+	int			commands;
+	int			drawCalls;
+	int			indices;
+	int			stateChanges;		// binds and fixed function state that changed something
+	int			redundantState;		// the same calls that set what was already set
+	int			uploadBytes;
+	int			objects;			// names generated minus names deleted
+	int			opCounts[eRec_Count];
+}recStats_t;
+
+// log every call to filename until Rec_Close, NULL only counts
+bool		Rec_Open(const char* filename);
+void		Rec_Close();
+
+const recStats_t& Rec_GetStats();
+void		Rec_ResetStats();
+void		Rec_PrintStats(const recStats_t& stats);
+const char*	Rec_OpName(int op);
+
+// runs a saved log through the counters
+bool		Rec_Replay(const char* filename, recStats_t* stats);
+
+// prints a readable listing of a saved log
+bool		Rec_DumpLog(const char* filename, int maxCommands);
+
+// index of the first command that differs, -1 when the logs match
+int			Rec_CompareLogs(const char* a, const char* b);
+
+#ifdef FLIP_GL_RECORD
+
+void			GLAPIENTRY Rec_ActiveTexture(GLenum texture);
+void			GLAPIENTRY Rec_AttachShader(GLuint program, GLuint shader);
+void			GLAPIENTRY Rec_Begin(GLenum mode);
+void			GLAPIENTRY Rec_BindAttribLocation(GLuint program, GLuint index, const GLchar* name);
+void			GLAPIENTRY Rec_BindBuffer(GLenum target, GLuint buffer);
+void			GLAPIENTRY Rec_BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void			GLAPIENTRY Rec_BindFramebuffer(GLenum target, GLuint framebuffer);
+void			GLAPIENTRY Rec_BindRenderbuffer(GLenum target, GLuint renderbuffer);
+void			GLAPIENTRY Rec_BindTexture(GLenum target, GLuint texture);
+void			GLAPIENTRY Rec_BlendFunc(GLenum sfactor, GLenum dfactor);
+void			GLAPIENTRY Rec_BufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+void			GLAPIENTRY Rec_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+GLenum			GLAPIENTRY Rec_CheckFramebufferStatus(GLenum target);
+void			GLAPIENTRY Rec_Clear(GLbitfield mask);
+void			GLAPIENTRY Rec_ClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+void			GLAPIENTRY Rec_ClearDepth(GLclampd depth);
+void			GLAPIENTRY Rec_Color3f(GLfloat red, GLfloat green, GLfloat blue);
+void			GLAPIENTRY Rec_ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+void			GLAPIENTRY Rec_CompileShader(GLuint shader);
+void			GLAPIENTRY Rec_CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data);
+void			GLAPIENTRY Rec_CompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const GLvoid* data);
+void			GLAPIENTRY Rec_CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+GLuint			GLAPIENTRY Rec_CreateProgram();
+GLuint			GLAPIENTRY Rec_CreateShader(GLenum type);
+void			GLAPIENTRY Rec_CullFace(GLenum mode);
+void			GLAPIENTRY Rec_DeleteBuffers(GLsizei n, const GLuint* buffers);
+void			GLAPIENTRY Rec_DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void			GLAPIENTRY Rec_DeleteProgram(GLuint program);
+void			GLAPIENTRY Rec_DeleteQueries(GLsizei n, const GLuint* ids);
+void			GLAPIENTRY Rec_DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void			GLAPIENTRY Rec_DeleteShader(GLuint shader);
+void			GLAPIENTRY Rec_DeleteTextures(GLsizei n, const GLuint* textures);
+void			GLAPIENTRY Rec_DepthFunc(GLenum func);
+void			GLAPIENTRY Rec_DepthMask(GLboolean flag);
+void			GLAPIENTRY Rec_Disable(GLenum cap);
+void			GLAPIENTRY Rec_DisableVertexAttribArray(GLuint index);
+void			GLAPIENTRY Rec_DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+void			GLAPIENTRY Rec_DrawBuffer(GLenum mode);
+void			GLAPIENTRY Rec_DrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+void			GLAPIENTRY Rec_DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex);
+void			GLAPIENTRY Rec_Enable(GLenum cap);
+void			GLAPIENTRY Rec_EnableVertexAttribArray(GLuint index);
+void			GLAPIENTRY Rec_End();
+void			GLAPIENTRY Rec_FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void			GLAPIENTRY Rec_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void			GLAPIENTRY Rec_FrontFace(GLenum mode);
+void			GLAPIENTRY Rec_GenBuffers(GLsizei n, GLuint* buffers);
+void			GLAPIENTRY Rec_GenFramebuffers(GLsizei n, GLuint* framebuffers);
+void			GLAPIENTRY Rec_GenQueries(GLsizei n, GLuint* ids);
+void			GLAPIENTRY Rec_GenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void			GLAPIENTRY Rec_GenTextures(GLsizei n, GLuint* textures);
+GLenum			GLAPIENTRY Rec_GetError();
+void			GLAPIENTRY Rec_GetIntegerv(GLenum pname, GLint* params);
+void			GLAPIENTRY Rec_GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary);
+void			GLAPIENTRY Rec_GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void			GLAPIENTRY Rec_GetProgramiv(GLuint program, GLenum pname, GLint* param);
+void			GLAPIENTRY Rec_GetQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+void			GLAPIENTRY Rec_GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+void			GLAPIENTRY Rec_GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+void			GLAPIENTRY Rec_GetShaderiv(GLuint shader, GLenum pname, GLint* param);
+const GLubyte*	GLAPIENTRY Rec_GetString(GLenum name);
+GLint			GLAPIENTRY Rec_GetUniformLocation(GLuint program, const GLchar* name);
+void			GLAPIENTRY Rec_Hint(GLenum target, GLenum mode);
+void			GLAPIENTRY Rec_LinkProgram(GLuint program);
+void			GLAPIENTRY Rec_LoadIdentity();
+void*			GLAPIENTRY Rec_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+void			GLAPIENTRY Rec_MatrixMode(GLenum mode);
+void			GLAPIENTRY Rec_MultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const GLvoid* const* indices, GLsizei drawcount, const GLint* basevertex);
+void			GLAPIENTRY Rec_MultiDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid* indirect, GLsizei drawcount, GLsizei stride);
+void			GLAPIENTRY Rec_Ortho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar);
+void			GLAPIENTRY Rec_PixelStorei(GLenum pname, GLint param);
+void			GLAPIENTRY Rec_PointSize(GLfloat size);
+void			GLAPIENTRY Rec_ProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLsizei length);
+void			GLAPIENTRY Rec_ProgramParameteri(GLuint program, GLenum pname, GLint value);
+void			GLAPIENTRY Rec_QueryCounter(GLuint id, GLenum target);
+void			GLAPIENTRY Rec_ReadBuffer(GLenum mode);
+void			GLAPIENTRY Rec_ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels);
+void			GLAPIENTRY Rec_RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void			GLAPIENTRY Rec_ShadeModel(GLenum mode);
+void			GLAPIENTRY Rec_ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void			GLAPIENTRY Rec_StencilFunc(GLenum func, GLint ref, GLuint mask);
+void			GLAPIENTRY Rec_StencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+void			GLAPIENTRY Rec_TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+void			GLAPIENTRY Rec_TexParameterf(GLenum target, GLenum pname, GLfloat param);
+void			GLAPIENTRY Rec_TexParameteri(GLenum target, GLenum pname, GLint param);
+void			GLAPIENTRY Rec_TexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+void			GLAPIENTRY Rec_TexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+void			GLAPIENTRY Rec_TexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels);
+void			GLAPIENTRY Rec_TextureView(GLuint texture, GLenum target, GLuint origtexture, GLenum internalformat, GLuint minlevel, GLuint numlevels, GLuint minlayer, GLuint numlayers);
+GLboolean		GLAPIENTRY Rec_UnmapBuffer(GLenum target);
+void			GLAPIENTRY Rec_Uniform1f(GLint location, GLfloat v0);
+void			GLAPIENTRY Rec_Uniform1i(GLint location, GLint v0);
+void			GLAPIENTRY Rec_Uniform2fv(GLint location, GLsizei count, const GLfloat* value);
+void			GLAPIENTRY Rec_Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+void			GLAPIENTRY Rec_Uniform3fv(GLint location, GLsizei count, const GLfloat* value);
+void			GLAPIENTRY Rec_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void			GLAPIENTRY Rec_UseProgram(GLuint program);
+void			GLAPIENTRY Rec_Vertex2f(GLfloat x, GLfloat y);
+void			GLAPIENTRY Rec_VertexAttribDivisor(GLuint index, GLuint divisor);
+void			GLAPIENTRY Rec_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+void			GLAPIENTRY Rec_Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+// glew maps extension entry points to function pointer macros, so undo
+// those before pointing every name at the recorder
+#undef glActiveTexture
+#undef glAttachShader
+#undef glBindAttribLocation
+#undef glBindBuffer
+#undef glBindBufferBase
+#undef glBindFramebuffer
+#undef glBindRenderbuffer
+#undef glBufferData
+#undef glBufferSubData
+#undef glCheckFramebufferStatus
+#undef glCompileShader
+#undef glCompressedTexImage2D
+#undef glCompressedTexSubImage3D
+#undef glCopyBufferSubData
+#undef glCreateProgram
+#undef glCreateShader
+#undef glDeleteBuffers
+#undef glDeleteFramebuffers
+#undef glDeleteProgram
+#undef glDeleteQueries
+#undef glDeleteRenderbuffers
+#undef glDeleteShader
+#undef glDisableVertexAttribArray
+#undef glDrawArraysInstanced
+#undef glDrawElementsBaseVertex
+#undef glEnableVertexAttribArray
+#undef glFramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenQueries
+#undef glGenRenderbuffers
+#undef glGetProgramBinary
+#undef glGetProgramInfoLog
+#undef glGetProgramiv
+#undef glGetQueryObjectiv
+#undef glGetQueryObjectui64v
+#undef glGetShaderInfoLog
+#undef glGetShaderiv
+#undef glGetUniformLocation
+#undef glLinkProgram
+#undef glMapBufferRange
+#undef glMultiDrawElementsBaseVertex
+#undef glMultiDrawElementsIndirect
+#undef glProgramBinary
+#undef glProgramParameteri
+#undef glQueryCounter
+#undef glRenderbufferStorage
+#undef glShaderSource
+#undef glTexStorage2D
+#undef glTexStorage3D
+#undef glTexSubImage3D
+#undef glTextureView
+#undef glUnmapBuffer
+#undef glUniform1f
+#undef glUniform1i
+#undef glUniform2fv
+#undef glUniform3f
+#undef glUniform3fv
+#undef glUniformMatrix4fv
+#undef glUseProgram
+#undef glVertexAttribDivisor
+#undef glVertexAttribPointer
+
+#define glActiveTexture				Rec_ActiveTexture
+#define glAttachShader				Rec_AttachShader
+#define glBegin						Rec_Begin
+#define glBindAttribLocation		Rec_BindAttribLocation
+#define glBindBuffer				Rec_BindBuffer
+#define glBindBufferBase			Rec_BindBufferBase
+#define glBindFramebuffer			Rec_BindFramebuffer
+#define glBindRenderbuffer			Rec_BindRenderbuffer
+#define glBindTexture				Rec_BindTexture
+#define glBlendFunc					Rec_BlendFunc
+#define glBufferData				Rec_BufferData
+#define glBufferSubData				Rec_BufferSubData
+#define glCheckFramebufferStatus	Rec_CheckFramebufferStatus
+#define glClear						Rec_Clear
+#define glClearColor				Rec_ClearColor
+#define glClearDepth				Rec_ClearDepth
+#define glColor3f					Rec_Color3f
+#define glColorMask					Rec_ColorMask
+#define glCompileShader				Rec_CompileShader
+#define glCompressedTexImage2D		Rec_CompressedTexImage2D
+#define glCompressedTexSubImage3D	Rec_CompressedTexSubImage3D
+#define glCopyBufferSubData			Rec_CopyBufferSubData
+#define glCreateProgram				Rec_CreateProgram
+#define glCreateShader				Rec_CreateShader
+#define glCullFace					Rec_CullFace
+#define glDeleteBuffers				Rec_DeleteBuffers
+#define glDeleteFramebuffers		Rec_DeleteFramebuffers
+#define glDeleteProgram				Rec_DeleteProgram
+#define glDeleteQueries				Rec_DeleteQueries
+#define glDeleteRenderbuffers		Rec_DeleteRenderbuffers
+#define glDeleteShader				Rec_DeleteShader
+#define glDeleteTextures			Rec_DeleteTextures
+#define glDepthFunc					Rec_DepthFunc
+#define glDepthMask					Rec_DepthMask
+#define glDisable					Rec_Disable
+#define glDisableVertexAttribArray	Rec_DisableVertexAttribArray
+#define glDrawBuffer				Rec_DrawBuffer
+#define glDrawArraysInstanced		Rec_DrawArraysInstanced
+#define glDrawElements				Rec_DrawElements
+#define glDrawElementsBaseVertex	Rec_DrawElementsBaseVertex
+#define glEnable					Rec_Enable
+#define glEnableVertexAttribArray	Rec_EnableVertexAttribArray
+#define glEnd						Rec_End
+#define glFramebufferRenderbuffer	Rec_FramebufferRenderbuffer
+#define glFramebufferTexture2D		Rec_FramebufferTexture2D
+#define glFrontFace					Rec_FrontFace
+#define glGenBuffers				Rec_GenBuffers
+#define glGenFramebuffers			Rec_GenFramebuffers
+#define glGenQueries				Rec_GenQueries
+#define glGenRenderbuffers			Rec_GenRenderbuffers
+#define glGenTextures				Rec_GenTextures
+#define glGetError					Rec_GetError
+#define glGetIntegerv				Rec_GetIntegerv
+#define glGetProgramBinary			Rec_GetProgramBinary
+#define glGetProgramInfoLog			Rec_GetProgramInfoLog
+#define glGetProgramiv				Rec_GetProgramiv
+#define glGetQueryObjectiv			Rec_GetQueryObjectiv
+#define glGetQueryObjectui64v		Rec_GetQueryObjectui64v
+#define glGetShaderInfoLog			Rec_GetShaderInfoLog
+#define glGetShaderiv				Rec_GetShaderiv
+#define glGetString					Rec_GetString
+#define glGetUniformLocation		Rec_GetUniformLocation
+#define glHint						Rec_Hint
+#define glLinkProgram				Rec_LinkProgram
+#define glLoadIdentity				Rec_LoadIdentity
+#define glMapBufferRange			Rec_MapBufferRange
+#define glMatrixMode				Rec_MatrixMode
+#define glMultiDrawElementsBaseVertex	Rec_MultiDrawElementsBaseVertex
+#define glMultiDrawElementsIndirect	Rec_MultiDrawElementsIndirect
+#define glOrtho						Rec_Ortho
+#define glPixelStorei				Rec_PixelStorei
+#define glPointSize					Rec_PointSize
+#define glProgramBinary				Rec_ProgramBinary
+#define glProgramParameteri			Rec_ProgramParameteri
+#define glQueryCounter				Rec_QueryCounter
+#define glReadBuffer				Rec_ReadBuffer
+#define glReadPixels				Rec_ReadPixels
+#define glRenderbufferStorage		Rec_RenderbufferStorage
+#define glShadeModel				Rec_ShadeModel
+#define glShaderSource				Rec_ShaderSource
+#define glStencilFunc				Rec_StencilFunc
+#define glStencilOp					Rec_StencilOp
+#define glTexImage2D				Rec_TexImage2D
+#define glTexParameterf				Rec_TexParameterf
+#define glTexParameteri				Rec_TexParameteri
+#define glTexStorage2D				Rec_TexStorage2D
+#define glTexStorage3D				Rec_TexStorage3D
+#define glTexSubImage3D				Rec_TexSubImage3D
+#define glTextureView				Rec_TextureView
+#define glUnmapBuffer				Rec_UnmapBuffer
+#define glUniform1f					Rec_Uniform1f
+#define glUniform1i					Rec_Uniform1i
+#define glUniform2fv				Rec_Uniform2fv
+#define glUniform3f					Rec_Uniform3f
+#define glUniform3fv				Rec_Uniform3fv
+#define glUniformMatrix4fv			Rec_UniformMatrix4fv
+#define glUseProgram				Rec_UseProgram
+#define glVertex2f					Rec_Vertex2f
+#define glVertexAttribDivisor		Rec_VertexAttribDivisor
+#define glVertexAttribPointer		Rec_VertexAttribPointer
+#define glViewport					Rec_Viewport
+
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+#include "../../glutils.h"
+#include "../sys_public.h"
+#include <stdlib.h>
+
+// the recorder in renderer/gl_record.cpp is the device in headless builds
+#ifdef FLIP_GL_OSMESA
+#include <GL/osmesa.h>
+
+/*
+===============================================================================
+
+	Software mesa device
+
+	Renders into a hidden buffer through OSMesa, so the real gl paths run
+	on machines without a display or a gpu.
+
+===============================================================================
+*/
+
+static OSMesaContext osmesa_context = NULL;
+static unsigned char* osmesa_buffer = NULL;
+
+void GLimp_Shutdown( void ) {
+	Sys_Printf( "Shutting down OpenGL subsystem\n" );
+
+	if ( osmesa_context ) {
+		OSMesaDestroyContext( osmesa_context );
+		osmesa_context = NULL;
+	}
+	free( osmesa_buffer );
+	osmesa_buffer = NULL;
+}
+
+void GL_SwapBuffers( void ) {
+	// nothing is presented, finishing keeps frame times honest
+	glFinish();
+}
+
+bool GL_CreateDevice(glimpParms_t *parm){
+	Sys_Printf( "Initializing OpenGL subsystem (osmesa %dx%d)\n", parm->width, parm->height );
+
+	osmesa_context = OSMesaCreateContextExt( OSMESA_RGBA, 24, 8, 0, NULL );
+	if ( osmesa_context == NULL ) {
+		Sys_Error( "OSMesaCreateContextExt failed\n" );
+		return false;
+	}
+
+	osmesa_buffer = (unsigned char*)malloc( parm->width * parm->height * 4 );
+	if ( !OSMesaMakeCurrent( osmesa_context, osmesa_buffer, GL_UNSIGNED_BYTE, parm->width, parm->height ) ) {
+		Sys_Error( "OSMesaMakeCurrent failed\n" );
+		GLimp_Shutdown();
+		return false;
+	}
+
+	Sys_Printf( "gl version: %s\n", (const char *)glGetString( GL_VERSION ) );
+	Sys_Printf( "gl vendor: %s\n", (const char *)glGetString( GL_VENDOR ) );
+	Sys_Printf( "gl renderer: %s\n", (const char *)glGetString( GL_RENDERER ) );
+	return true;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef __POSIX_LOCAL_H__
+#define __POSIX_LOCAL_H__
+
+#include "../sys_public.h"
+
+#define	MAX_OSPATH			256
+
+void	Sys_Init( void );
+void	Sys_PumpEvents( void );
+void	Sys_QueEvent( int time, sysEventType_t type, int value, int value2, int ptrLength, void *ptr );
+
+// a line typed on stdin, NULL until one is complete
+char	*Sys_ConsoleInput( void );
+
+#endif
@@ -0,0 +1,57 @@
+#include "posix_local.h"
+#include "../../framework/Common.h"
+#include "../../framework/CmdSystem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static sysMemoryStats_t exeLaunchMemoryStats;
+
+/*
+==================
+main
+
+	-frames <n>			quit after n frames, for benchmark runs
+	+<command> <args>	run a console command once the engine is up,
+						e.g. +trace_start 100 trace.json
+==================
+*/
+int main( int argc, char **argv )
+{
+	Sys_GetCurrentMemoryStatus( exeLaunchMemoryStats );
+
+	int maxFrames = 0;
+	for ( int i = 1; i < argc - 1; i++ ) {
+		if ( strcmp( argv[i], "-frames" ) == 0 ) {
+			maxFrames = atoi( argv[++i] );
+		}
+	}
+
+	Sys_Init();
+	Com_Init();
+
+	for ( int i = 1; i < argc; i++ ) {
+		if ( argv[i][0] != '+' ) {
+			continue;
+		}
+		char line[1024];
+		int len = sprintf( line, "%s", argv[i] + 1 );
+		while ( i + 1 < argc && argv[i + 1][0] != '+' && argv[i + 1][0] != '-' && len < 900 ) {
+			len += sprintf( line + len, " %s", argv[++i] );
+		}
+		if ( !Cmd_ExecuteString( line ) ) {
+			Sys_Printf( "unknown command: %s\n", line );
+		}
+	}
+
+	// main game loop
+	for ( int frame = 0; maxFrames == 0 || frame < maxFrames; frame++ )
+	{
+		Sys_PumpEvents();
+		Com_Frame();
+	}
+
+	Com_Quit();
+	return 0;
+}
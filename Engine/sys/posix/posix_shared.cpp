@@ -0,0 +1,408 @@
+#include "posix_local.h"
+#include "../../common/Str.h"
+#include "../../common/array.h"
+#include "../../framework/Common.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+#define	MAX_QUED_EVENTS		256
+#define	MASK_QUED_EVENTS	( MAX_QUED_EVENTS - 1)
+sysEvent_t	eventQue[MAX_QUED_EVENTS];
+int			eventHead = 0;
+int			eventTail = 0;
+
+static double Sys_Now( void ) {
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1000000000.0 + ts.tv_nsec;
+}
+
+/*
+================
+Sys_Milliseconds
+================
+*/
+int Sys_Milliseconds( void ) {
+	static double sys_timeBase = 0.0;
+
+	double now = Sys_Now();
+	if ( sys_timeBase == 0.0 ) {
+		sys_timeBase = now;
+	}
+	return (int)( ( now - sys_timeBase ) / 1000000.0 );
+}
+
+/*
+================
+Sys_GetClockTicks
+================
+*/
+double Sys_GetClockTicks( void ) {
+	return Sys_Now();
+}
+
+/*
+================
+Sys_ClockTicksPerSecond
+================
+*/
+double Sys_ClockTicksPerSecond( void ) {
+	return 1000000000.0;
+}
+
+void Sys_Sleep( int msec ) {
+	struct timespec ts;
+	ts.tv_sec = msec / 1000;
+	ts.tv_nsec = ( msec % 1000 ) * 1000000;
+	nanosleep( &ts, NULL );
+}
+
+/*
+================
+Sys_GetSystemRam
+
+	returns amount of physical memory in MB
+================
+*/
+int Sys_GetSystemRam( void ) {
+	long long bytes = (long long)sysconf( _SC_PHYS_PAGES ) * sysconf( _SC_PAGESIZE );
+	int physRam = (int)( bytes / ( 1024 * 1024 ) );
+	return ( physRam + 8 ) & ~15;
+}
+
+/*
+================
+Sys_GetDriveFreeSpace
+returns in megabytes
+================
+*/
+int Sys_GetDriveFreeSpace( const char *path ) {
+	struct statvfs st;
+	if ( statvfs( path, &st ) != 0 ) {
+		return 26;
+	}
+	return (int)( (double)st.f_bavail * st.f_frsize / ( 1024.0 * 1024.0 ) );
+}
+
+/*
+================
+Sys_GetCurrentMemoryStatus
+
+	returns OS mem info
+	all values are in MB except the memoryload
+================
+*/
+void Sys_GetCurrentMemoryStatus( sysMemoryStats_t &stats ) {
+	long long page = sysconf( _SC_PAGESIZE );
+	long long total = (long long)sysconf( _SC_PHYS_PAGES ) * page;
+	long long avail = (long long)sysconf( _SC_AVPHYS_PAGES ) * page;
+
+	memset( &stats, 0, sizeof( stats ) );
+	stats.totalPhysical = (int)( total >> 20 );
+	stats.availPhysical = (int)( avail >> 20 );
+	stats.memoryLoad = total > 0 ? (int)( 100 - avail * 100 / total ) : 0;
+}
+
+bool Sys_LockMemory( void *ptr, int bytes ) {
+	return mlock( ptr, bytes ) == 0;
+}
+
+bool Sys_UnlockMemory( void *ptr, int bytes ) {
+	return munlock( ptr, bytes ) == 0;
+}
+
+void Sys_SetPhysicalWorkMemory( int minBytes, int maxBytes ) {
+}
+
+void Sys_ShutdownSymbols( void ) {
+}
+
+/*
+================
+Sys_DrawText
+
+there is no font rasterizer here, the label keeps the size the text would
+take but stays transparent
+================
+*/
+bool Sys_DrawText( const char* text, sysTextContent_t* img ) {
+	int width = 0;
+	int lines = 1;
+	int column = 0;
+	for ( const char* c = text; *c; c++ ) {
+		if ( *c == '\n' ) {
+			lines++;
+			column = 0;
+			continue;
+		}
+		if ( ++column > width ) {
+			width = column;
+		}
+	}
+
+	img->w = width * 8;
+	img->h = lines * 20;
+	if ( img->w * img->h > 1024 * 1024 ) {
+		Sys_Error( "size is too large " );
+		return false;
+	}
+	memset( img->pData, 0, img->w * img->h * 4 );
+	return true;
+}
+
+/* ============== Sys_Quit ============== */
+void Sys_Quit( void ) {
+	fflush( stdout );
+	exit( 0 );
+}
+
+#define MAXPRINTMSG 4096
+void Sys_Printf( const char *fmt, ... ) {
+	char		msg[MAXPRINTMSG];
+
+	va_list argptr;
+	va_start(argptr, fmt);
+	lfStr::vsnPrintf( msg, MAXPRINTMSG-1, fmt, argptr );
+	va_end(argptr);
+	msg[sizeof(msg)-1] = '\0';
+
+	fputs( msg, stdout );
+}
+
+void Sys_Warning( const char *fmt, ... ) {
+	char		msg[MAXPRINTMSG];
+
+	va_list argptr;
+	va_start(argptr, fmt);
+	lfStr::vsnPrintf( msg, MAXPRINTMSG-1, fmt, argptr );
+	va_end(argptr);
+	msg[sizeof(msg)-1] = '\0';
+
+	Sys_Printf( "%s", msg );
+}
+
+void Sys_Error( const char *fmt, ... ) {
+	char		msg[MAXPRINTMSG];
+
+	va_list argptr;
+	va_start(argptr, fmt);
+	lfStr::vsnPrintf( msg, MAXPRINTMSG-1, fmt, argptr );
+	va_end(argptr);
+	msg[sizeof(msg)-1] = '\0';
+
+	fflush( stdout );
+	fprintf( stderr, "error: %s", msg );
+}
+
+void Sys_DebugPrintf( const char *fmt, ... ) {
+	char msg[MAXPRINTMSG];
+
+	va_list argptr;
+	va_start( argptr, fmt );
+	lfStr::vsnPrintf( msg, MAXPRINTMSG-1, fmt, argptr );
+	msg[ sizeof(msg)-1 ] = '\0';
+	va_end( argptr );
+
+	fputs( msg, stderr );
+}
+
+void Sys_ShowWindow( bool show ) {
+}
+
+/*
+================
+Sys_ConsoleInput
+
+stdin is polled, so a pipe or a terminal can type console commands
+================
+*/
+char *Sys_ConsoleInput( void ) {
+	static char	text[256];
+	static int	len = 0;
+	static bool	closed = false;
+
+	while ( !closed ) {
+		struct pollfd pfd;
+		pfd.fd = STDIN_FILENO;
+		pfd.events = POLLIN;
+		if ( poll( &pfd, 1, 0 ) <= 0 || !( pfd.revents & ( POLLIN | POLLHUP ) ) ) {
+			return NULL;
+		}
+
+		char c;
+		if ( read( STDIN_FILENO, &c, 1 ) != 1 ) {
+			closed = true;
+			break;
+		}
+		if ( c == '\n' ) {
+			text[len] = '\0';
+			len = 0;
+			return text;
+		}
+		if ( c != '\r' && len < (int)sizeof( text ) - 1 ) {
+			text[len++] = c;
+		}
+	}
+	return NULL;
+}
+
+void Sys_PumpEvents( void ) {
+	// typed into the system console
+	char *s = Sys_ConsoleInput();
+	if ( s ) {
+		int len = strlen( s ) + 1;
+		char *b = (char *)malloc( len );
+		strcpy( b, s );
+		Sys_QueEvent( Sys_Milliseconds(), SE_CONSOLE, 0, 0, len, b );
+	}
+}
+
+void Sys_Init() {
+	setvbuf( stdout, NULL, _IOLBF, 0 );
+}
+
+void Sys_QueEvent( int time, sysEventType_t type, int value, int value2, int ptrLength, void *ptr ) {
+	sysEvent_t	*ev;
+
+	ev = &eventQue[ eventHead & MASK_QUED_EVENTS ];
+
+	if ( eventHead - eventTail >= MAX_QUED_EVENTS )
+	{
+		Sys_Printf("Sys_QueEvent: overflow\n");
+		eventTail++;
+	}
+
+	eventHead++;
+
+	ev->evType = type;
+	ev->evValue = value;
+	ev->evValue2 = value2;
+	ev->evPtrLength = ptrLength;
+	ev->evPtr = ptr;
+}
+
+/*
+================
+Sys_ClearEvents
+================
+*/
+void Sys_ClearEvents( void ) {
+	eventHead = eventTail = 0;
+}
+
+/*
+================
+Sys_GetEvent
+================
+*/
+sysEvent_t Sys_GetEvent( void ) {
+	sysEvent_t	ev;
+
+	// return if we have data
+	if ( eventHead > eventTail ) {
+		eventTail++;
+		return eventQue[ ( eventTail - 1 ) & MASK_QUED_EVENTS ];
+	}
+
+	// return the empty event
+	memset( &ev, 0, sizeof( ev ) );
+
+	return ev;
+}
+
+void Sys_Mkdir( const char *path ) {
+	mkdir( path, 0777 );
+}
+
+int Sys_ListAllFile( const char *directory, const char *extension, array<lfStr>& fileList ) {
+	char path[MAX_OSPATH];
+
+	DIR *dir = opendir( directory );
+	if ( dir == NULL ) {
+		return -1;
+	}
+
+	struct dirent *d;
+	while ( ( d = readdir( dir ) ) != NULL ) {
+		if ( strcmp( d->d_name, "." ) == 0 || strcmp( d->d_name, ".." ) == 0 ) {
+			continue;
+		}
+		// a path that doesn't fit can't be opened either
+		int len = snprintf( path, sizeof( path ), "%s/%s", directory, d->d_name );
+		if ( len < 0 || len >= (int)sizeof( path ) ) {
+			continue;
+		}
+		fileList.push_back( lfStr( path ) );
+	}
+
+	closedir( dir );
+	return 0;
+}
+
+char* Sys_ReadFileData( const char* filename ) {
+	FILE* f = fopen( filename, "rb" );
+	if ( f == NULL ) {
+		return NULL;
+	}
+
+	fseek( f, 0, SEEK_END );
+	long size = ftell( f );
+	fseek( f, 0, SEEK_SET );
+
+	char* data = (char*)malloc( size + 1 );
+	size_t count = fread( data, 1, size, f );
+	fclose( f );
+	data[count] = '\0';
+	return data;
+}
+
+const void *Sys_MapFile( const char *filename, int *size ) {
+	int fd = open( filename, O_RDONLY );
+	if ( fd < 0 ) {
+		return NULL;
+	}
+
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+		close( fd );
+		return NULL;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void *data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+
+	*size = (int)st.st_size;
+	return data;
+}
+
+void Sys_UnmapFile( const void *data, int size ) {
+	if ( data != NULL ) {
+		munmap( (void *)data, size );
+	}
+}
+
+void Sys_ReleaseFileRange( const void *data, int offset, int size ) {
+	long page = sysconf( _SC_PAGESIZE );
+	long start = ( offset + page - 1 ) / page * page;
+	long end = ( (long)offset + size ) / page * page;
+	if ( data == NULL || end <= start ) {
+		return;
+	}
+	// the view is private and never written, so its pages are still the file's
+	madvise( (char *)data + start, end - start, MADV_DONTNEED );
+}
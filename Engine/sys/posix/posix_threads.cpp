@@ -0,0 +1,81 @@
+#include "posix_local.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+typedef struct {
+	xthread_t	function;
+	void *		parms;
+} threadStart_t;
+
+static void *Sys_ThreadProc( void *arg ) {
+	threadStart_t start = *(threadStart_t *)arg;
+	delete (threadStart_t *)arg;
+	start.function( start.parms );
+	return NULL;
+}
+
+/*
+================
+Sys_CreateThread
+================
+*/
+void Sys_CreateThread( xthread_t function, void *parms, xthreadInfo &info, const char *name ) {
+	threadStart_t *start = new threadStart_t;
+	start->function = function;
+	start->parms = parms;
+
+	pthread_t *handle = new pthread_t;
+	if ( pthread_create( handle, NULL, Sys_ThreadProc, start ) != 0 ) {
+		Sys_Error( "Sys_CreateThread: couldn't create thread %s\n", name );
+		delete start;
+		delete handle;
+		info.threadHandle = NULL;
+		return;
+	}
+
+	info.name = name;
+	info.threadHandle = handle;
+	info.threadId = (unsigned long)*handle;
+}
+
+/*
+================
+Sys_JoinThread
+================
+*/
+void Sys_JoinThread( xthreadInfo &info ) {
+	if ( info.threadHandle == NULL ) {
+		return;
+	}
+	pthread_t *handle = (pthread_t *)info.threadHandle;
+	pthread_join( *handle, NULL );
+	delete handle;
+	info.threadHandle = NULL;
+}
+
+void Sys_Yield( void ) {
+	sched_yield();
+}
+
+int Sys_GetNumCpus( void ) {
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	return n > 0 ? (int)n : 1;
+}
+
+/*
+================
+Sys_GetThreadId
+================
+*/
+unsigned long Sys_GetThreadId( void ) {
+#ifdef __linux__
+	return (unsigned long)syscall( SYS_gettid );
+#else
+	return (unsigned long)pthread_self();
+#endif
+}
@@ -42,6 +42,15 @@ typedef struct sysEvent_s {
 
 typedef unsigned long address_t;
 
+#ifdef _WIN32
+#define SYS_THREAD_LOCAL __declspec(thread)
+#else
+#include <alloca.h>
+#define SYS_THREAD_LOCAL __thread
+#define _alloca			alloca
+#define __cdecl
+#endif
+
 template<class type> class idList;		// for Sys_ListFiles
 
 void			Sys_Error( const char *error, ...);
@@ -63,6 +72,24 @@ int			Sys_Milliseconds( void );
 double		Sys_GetClockTicks( void );
 double		Sys_ClockTicksPerSecond( void );
 
+// os id of the calling thread
+unsigned long	Sys_GetThreadId( void );
+
+// threads
+typedef unsigned int (*xthread_t)( void *parms );
+
+typedef struct {
+	const char *	name;
+	void *			threadHandle;
+	unsigned long	threadId;
+} xthreadInfo;
+
+void			Sys_CreateThread( xthread_t function, void *parms, xthreadInfo &info, const char *name );
+// waits for the thread function to return
+void			Sys_JoinThread( xthreadInfo &info );
+void			Sys_Yield( void );
+int				Sys_GetNumCpus( void );
+
 // returns amount of system ram
 int			Sys_GetSystemRam( void );
 
@@ -151,7 +178,15 @@ void			Sys_SetFatalError( const char *error );
 // display perference dialog
 void			Sys_DoPreferences( void );
 
+// malloc'd and nul terminated, NULL if the file can't be read
 char* Sys_ReadFileData(const char* filename);
+
+// read only view of a whole file, NULL if it can't be opened
+const void *	Sys_MapFile( const char *filename, int *size );
+void			Sys_UnmapFile( const void *data, int size );
+// drops the resident pages that lie wholly inside the range, reads fault
+// them in from the file again
+void			Sys_ReleaseFileRange( const void *data, int offset, int size );
 /*
 ==============================================================
 
@@ -4,7 +4,10 @@
 #include "../framework/Common.h"
 #include <windows.h>
 
-#include "gl/wglext.h"
+// the recorder in renderer/gl_record.cpp is the device in headless builds
+#ifndef FLIP_GL_RECORD
+
+#include "GL/wglext.h"
 #ifdef _WIN32
 #pragma comment(lib, "opengl32.lib")
 #pragma comment(lib, "glew32.lib")
@@ -289,3 +292,4 @@ bool GL_CreateDevice(glimpParms_t *parm){
 	return true;
 }
 
+#endif
@@ -19,7 +19,7 @@
 
 #pragma comment( lib, "Winmm.lib")
 
-#include "../../common/str.h"
+#include "../../common/Str.h"
 #include "../framework/Common.h"
 #include "../sys_public.h"
 #include "../../common/array.h"
@@ -1031,6 +1031,15 @@ void Sys_PumpEvents( void ) {
 		TranslateMessage (&msg);
       	DispatchMessage (&msg);
 	}
+
+	// typed into the system console
+	char *s = Sys_ConsoleInput();
+	if ( s ) {
+		int len = strlen( s ) + 1;
+		char *b = (char *)malloc( len );
+		strcpy( b, s );
+		Sys_QueEvent( win32.sysMsgTime, SE_CONSOLE, 0, 0, len, b );
+	}
 }
 
 /*
@@ -1062,6 +1071,72 @@ double Sys_ClockTicksPerSecond( void ) {
 	return ticks;
 }
 
+/*
+================
+Sys_GetThreadId
+================
+*/
+unsigned long Sys_GetThreadId( void ) {
+	return GetCurrentThreadId();
+}
+
+typedef struct {
+	xthread_t	function;
+	void *		parms;
+} threadStart_t;
+
+static DWORD WINAPI Sys_ThreadProc( LPVOID arg ) {
+	threadStart_t start = *(threadStart_t *)arg;
+	delete (threadStart_t *)arg;
+	return start.function( start.parms );
+}
+
+/*
+================
+Sys_CreateThread
+================
+*/
+void Sys_CreateThread( xthread_t function, void *parms, xthreadInfo &info, const char *name ) {
+	threadStart_t *start = new threadStart_t;
+	start->function = function;
+	start->parms = parms;
+
+	DWORD threadId;
+	HANDLE handle = CreateThread( NULL, 0, Sys_ThreadProc, start, 0, &threadId );
+	if ( handle == NULL ) {
+		Sys_Error( "Sys_CreateThread: couldn't create thread %s\n", name );
+		delete start;
+	}
+
+	info.name = name;
+	info.threadHandle = handle;
+	info.threadId = threadId;
+}
+
+/*
+================
+Sys_JoinThread
+================
+*/
+void Sys_JoinThread( xthreadInfo &info ) {
+	if ( info.threadHandle == NULL ) {
+		return;
+	}
+	WaitForSingleObject( (HANDLE)info.threadHandle, INFINITE );
+	CloseHandle( (HANDLE)info.threadHandle );
+	info.threadHandle = NULL;
+}
+
+void Sys_Yield( void ) {
+	SwitchToThread();
+}
+
+int Sys_GetNumCpus( void ) {
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors;
+}
+
 void Sys_Init() {
 	win32.defaultFont = CreateFont(20, // nHeight 
         0, // nWidth 
@@ -1128,6 +1203,10 @@ sysEvent_t Sys_GetEvent( void ) {
 	return ev;
 }
 
+void Sys_Mkdir( const char *path ) {
+	_mkdir( path );
+}
+
 int Sys_ListAllFile( const char *directory, const char *extension, array<lfStr>& fileList ) {
 	char search[256];
 	char path[256];
@@ -1175,4 +1254,64 @@ int Sys_ListAllFile( const char *directory, const char *extension, array<lfStr>&
 	_findclose( findhandle );
 
 	return 0;
-}
\ No newline at end of file
+}
+
+char* Sys_ReadFileData( const char* filename ) {
+	FILE* f = fopen( filename, "rb" );
+	if ( f == NULL ) {
+		return NULL;
+	}
+
+	fseek( f, 0, SEEK_END );
+	long size = ftell( f );
+	fseek( f, 0, SEEK_SET );
+
+	char* data = (char*)malloc( size + 1 );
+	size_t count = fread( data, 1, size, f );
+	fclose( f );
+	data[count] = '\0';
+	return data;
+}
+
+const void *Sys_MapFile( const char *filename, int *size ) {
+	HANDLE file = CreateFile( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+
+	DWORD length = GetFileSize( file, NULL );
+	HANDLE mapping = length > 0 ? CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL ) : NULL;
+	CloseHandle( file );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+
+	// the view keeps the mapping alive
+	void *data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if ( data == NULL ) {
+		return NULL;
+	}
+
+	*size = (int)length;
+	return data;
+}
+
+void Sys_UnmapFile( const void *data, int size ) {
+	if ( data != NULL ) {
+		UnmapViewOfFile( data );
+	}
+}
+
+void Sys_ReleaseFileRange( const void *data, int offset, int size ) {
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	int page = (int)info.dwPageSize;
+	int start = ( offset + page - 1 ) / page * page;
+	int end = ( offset + size ) / page * page;
+	if ( data == NULL || end <= start ) {
+		return;
+	}
+	// unlocking pages that aren't locked takes them out of the working set
+	VirtualUnlock( (char *)data + start, end - start );
+}
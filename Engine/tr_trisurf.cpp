@@ -1,4 +1,5 @@
 #include "r_public.h"
+#include "renderer/GeometryArena.h"
 #include "common/Plane.h"
 #include "common/Heap.h"
 /*
@@ -163,6 +164,7 @@ This will defer the free until the current frame has run through the back end.
 ==============
 */
 void R_FreeStaticTriSurf( srfTriangles_t *tri ) {
+	R_FreeGeometry( tri );
 	delete tri;
 //	frameData_t		*frame;
 //
@@ -6,7 +6,7 @@
 #include "Mesh.h"
 #include "ResourceSystem.h"
 #include "renderer/RenderSystem.h"
-#include "../media/KnightModel.h"
+#include "../Media/KnightModel.h"
 #include "r_public.h"
 #include "sys/sys_public.h"
 #include "Camera.h"
@@ -22,6 +22,7 @@
 #include "ScriptSystem.h"
 
 #include "luautils.h"
+#include "framework/CmdSystem.h"
 
 
 #pragma comment(lib, "FlipEngine.lib")
@@ -200,6 +201,12 @@ void ShadowSampler::ProcessEvent(sysEvent_s* event)
 		{
 			HitTest(event->evValue, event->evValue2);
 		}
+		break;
+	case SE_CONSOLE:
+		{
+			Cmd_ExecuteString((const char*)event->evPtr);
+			free(event->evPtr);
+		}
 	default:
 		break;
 	}
@@ -1,30 +1,32 @@
-#include <stdio.h>
-#include <iostream>
+// in place heap sort, not stable either
 
-struct vec2 
+static void SiftDown(float* arr, int root, int n)
 {
-	int x;
-	int y;
-};
-class A
-{
-public:
-	vec2 pos;
-	A() { pos.x = 2; pos.y = 2; }
-
-	vec2& getposition()
+	float tmp = arr[root];
+	int child = root * 2 + 1;
+	while (child < n)
 	{
-		return pos;
+		if (child + 1 < n && arr[child + 1] > arr[child])
+			child++;
+		if (arr[child] <= tmp)
+			break;
+		arr[root] = arr[child];
+		root = child;
+		child = root * 2 + 1;
 	}
-};
+	arr[root] = tmp;
+}
 
-int main()
+void HeapSort(float* arr, int n)
 {
-	A a;
-	vec2& position = a.getposition();
-	position.x = 3;
+	for (int i = n / 2 - 1; i >= 0; i--)
+		SiftDown(arr, i, n);
 
-	printf("%d", a.pos.x);
-	
-	system("pause");
-}
\ No newline at end of file
+	for (int i = n - 1; i > 0; i--)
+	{
+		float tmp = arr[0];
+		arr[0] = arr[i];
+		arr[i] = tmp;
+		SiftDown(arr, 0, i);
+	}
+}
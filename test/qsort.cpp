@@ -1,24 +1,23 @@
-#include <stdio.h>
-#include <iostream>
-
-void qsort(int* arr, int l, int r)
+// the recursive quick sort the benchmark compares against, in place and
+// not stable
+void QuickSort(float* arr, int l, int r)
 {
 	if (l >= r)
 		return;
 
-	int tmp = arr[l];
+	float tmp = arr[l];
 	int first = l;
 	int last = r;
 
 	while (first < last)
 	{
-		while (first<last && arr[last] > tmp)
+		while (first<last && arr[last] >= tmp)
 		{
 			last--;
 		}
 		arr[first] = arr[last];
 
-		while (first<last && arr[first] < tmp)
+		while (first<last && arr[first] <= tmp)
 		{
 			first++;
 		}
@@ -26,22 +25,6 @@ void qsort(int* arr, int l, int r)
 	}
 
 	arr[first] = tmp;
-	qsort(arr, l, first-1);
-	qsort(arr, first+1, r);
+	QuickSort(arr, l, first-1);
+	QuickSort(arr, first+1, r);
 }
-
-void main()
-{
-
-	int a[] = {57, 68, 59, 52, 72, 28, 96, 33, 24};
-
-	qsort(a, 0, sizeof(a) / sizeof(a[0]) - 1);/*ԭĵҪ1ڴԽ*/
-
-	for(int i = 0; i < sizeof(a) / sizeof(a[0]); i++)
-	{
-		printf("%d ", a[i]);
-	}
-
-	system("pause");
-}
-
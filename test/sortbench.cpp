@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include "common/RadixSort.h"
+#include "common/Timer.h"
+
+// the translucent queue's sort (Engine/common/RadixSort.h) against the
+// comparison sorts, on as many keys as a large particle or sprite frame.
+// only the order is checked, wall clock times vary too much between
+// machines and builds to fail on
+
+#define NUM_KEYS		50000
+#define NUM_RUNS		20
+
+void QuickSort(float* arr, int l, int r);
+void HeapSort(float* arr, int n);
+
+static const float* sb_keys;
+
+static bool KeyLess(unsigned int a, unsigned int b)
+{
+	return sb_keys[a] < sb_keys[b];
+}
+
+// view depths, rounded so that many keys repeat and stability shows
+static void MakeKeys(float* keys, int n)
+{
+	srand(1234);
+	for (int i = 0; i < n; i++)
+		keys[i] = (float)(rand() % 20000 - 10000) * 0.01f;
+}
+
+static bool CheckOrder(const float* keys, const unsigned int* order, int n)
+{
+	for (int i = 1; i < n; i++)
+	{
+		float a = keys[order[i - 1]];
+		float b = keys[order[i]];
+		if (a > b || (a == b && order[i - 1] > order[i]))
+		{
+			printf("radix sort: keys %d and %d out of order\n", i - 1, i);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	std::vector<float> keys(NUM_KEYS);
+	std::vector<float> work(NUM_KEYS);
+	std::vector<unsigned int> indexes(NUM_KEYS);
+	MakeKeys(&keys[0], NUM_KEYS);
+	sb_keys = &keys[0];
+
+	Timer timer;
+	RadixSort radix;
+	const unsigned int* order = radix.Sort(&keys[0], NUM_KEYS);	// sizes the buffers
+	if (!CheckOrder(&keys[0], order, NUM_KEYS))
+		return 1;
+
+	double radixMsec = 0.0;
+	double quickMsec = 0.0;
+	double heapMsec = 0.0;
+	double stableMsec = 0.0;
+	double stdMsec = 0.0;
+	for (int run = 0; run < NUM_RUNS; run++)
+	{
+		timer.start();
+		radix.Sort(&keys[0], NUM_KEYS);
+		timer.stop();
+		radixMsec += timer.getElapsedTimeInMilliSec();
+
+		memcpy(&work[0], &keys[0], NUM_KEYS * sizeof(float));
+		timer.start();
+		QuickSort(&work[0], 0, NUM_KEYS - 1);
+		timer.stop();
+		quickMsec += timer.getElapsedTimeInMilliSec();
+
+		memcpy(&work[0], &keys[0], NUM_KEYS * sizeof(float));
+		timer.start();
+		HeapSort(&work[0], NUM_KEYS);
+		timer.stop();
+		heapMsec += timer.getElapsedTimeInMilliSec();
+
+		for (int i = 0; i < NUM_KEYS; i++)
+			indexes[i] = i;
+		timer.start();
+		std::stable_sort(indexes.begin(), indexes.end(), KeyLess);
+		timer.stop();
+		stableMsec += timer.getElapsedTimeInMilliSec();
+
+		for (int i = 0; i < NUM_KEYS; i++)
+			indexes[i] = i;
+		timer.start();
+		std::sort(indexes.begin(), indexes.end(), KeyLess);
+		timer.stop();
+		stdMsec += timer.getElapsedTimeInMilliSec();
+	}
+
+	printf("%d keys, average of %d runs\n", NUM_KEYS, NUM_RUNS);
+	printf("  radix sort (stable, indexes)    %8.3f msec\n", radixMsec / NUM_RUNS);
+	printf("  std::sort (indexes)             %8.3f msec\n", stdMsec / NUM_RUNS);
+	printf("  std::stable_sort (indexes)      %8.3f msec\n", stableMsec / NUM_RUNS);
+	printf("  quick sort (in place)           %8.3f msec\n", quickMsec / NUM_RUNS);
+	printf("  heap sort (in place)            %8.3f msec\n", heapMsec / NUM_RUNS);
+	if (radixMsec > 0.0)
+		printf("radix sort speedup: %.2fx over std::sort, %.2fx over std::stable_sort\n", stdMsec / radixMsec, stableMsec / radixMsec);
+	return 0;
+}